@@ -32,3 +32,13 @@ option(DEBUG "Enable debug statements and asserts" OFF)
 if(DEBUG OR CMAKE_BUILD_TYPE STREQUAL "Debug")
     add_compile_definitions(DEBUG APP_PROFILE)
 endif()
+
+option(PROFILE "Keep profiling scopes compiled in, categories are toggled at runtime" OFF)
+if(PROFILE)
+    add_compile_definitions(APP_PROFILE)
+endif()
+
+option(COUNT_ALLOCATIONS "Count heap allocations per frame, replaces the global operator new" OFF)
+if(COUNT_ALLOCATIONS)
+    add_compile_definitions(APP_COUNT_ALLOCATIONS)
+endif()
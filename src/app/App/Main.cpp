@@ -1,20 +1,117 @@
 #define SDL_MAIN_HANDLED
 
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
 #include "Core/Application.hpp"
 #include "Core/Instrumentor.hpp"
 #include "Core/Log.hpp"
 
+namespace {
+
+    bool ParseInt(const char* text, int& value)
+    {
+        const char* end{text + std::strlen(text)};
+        const auto [ptr, error]{std::from_chars(text, end, value)};
+        return error == std::errc{} && ptr == end && value >= 0;
+    }
+
+    // --headless [--frames N] [--warmup N] [--report path] [--viewports N]
+    //            [--input-rate N] [--no-coalesce] [--max-allocations N] [--pipelined]
+    bool ParseSettings(const int argc,
+                       const char* argv[],
+                       App::Application::HeadlessSettings& headless,
+                       App::Application::RenderSettings& renderSettings)
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg{argv[i]};
+            const bool hasValue{i + 1 < argc};
+
+            if(arg == "--headless")
+            {
+                headless.enabled = true;
+            }
+            else if(arg == "--frames" && hasValue)
+            {
+                if(!ParseInt(argv[++i], headless.frames))
+                {
+                    APP_ERROR("Invalid frame count: {}", argv[i]);
+                    return false;
+                }
+            }
+            else if(arg == "--warmup" && hasValue)
+            {
+                if(!ParseInt(argv[++i], headless.warmupFrames))
+                {
+                    APP_ERROR("Invalid warm-up frame count: {}", argv[i]);
+                    return false;
+                }
+            }
+            else if(arg == "--viewports" && hasValue)
+            {
+                if(!ParseInt(argv[++i], headless.detachedViewports))
+                {
+                    APP_ERROR("Invalid viewport count: {}", argv[i]);
+                    return false;
+                }
+            }
+            else if(arg == "--input-rate" && hasValue)
+            {
+                if(!ParseInt(argv[++i], headless.motionEventsPerFrame))
+                {
+                    APP_ERROR("Invalid input rate: {}", argv[i]);
+                    return false;
+                }
+            }
+            else if(arg == "--no-coalesce")
+            {
+                headless.coalesceInput = false;
+            }
+            else if(arg == "--max-allocations" && hasValue)
+            {
+                if(!ParseInt(argv[++i], headless.maxFrameAllocations))
+                {
+                    APP_ERROR("Invalid allocation limit: {}", argv[i]);
+                    return false;
+                }
+            }
+            else if(arg == "--report" && hasValue)
+            {
+                headless.reportPath = argv[++i];
+            }
+            else if(arg == "--pipelined")
+            {
+                renderSettings.pipelined = true;
+            }
+        }
+        return true;
+    }
+
+}
+
 int main(const int argc, const char* argv[])
 {
+    App::Application::HeadlessSettings headless{};
+    App::Application::RenderSettings renderSettings{};
+    if(!ParseSettings(argc, argv, headless, renderSettings))
+    {
+        return static_cast<int>(App::ExitStatus::FAILURE);
+    }
+
+    App::ExitStatus exitStatus{App::ExitStatus::SUCCESS};
+
     try
     {
         APP_PROFILE_BEGIN_SESSION_WITH_FILE("App", "profile.json");
 
         {
             APP_PROFILE_SCOPE("Test scope");
-            App::Application app{"App"};
+            App::Application app{"App", headless};
             app.SetCommandLineArgs(argc, argv);
-            app.Run();
+            app.SetRenderSettings(renderSettings);
+            exitStatus = app.Run();
         }
 
         APP_PROFILE_END_SESSION();
@@ -22,7 +119,8 @@ int main(const int argc, const char* argv[])
     catch(std::exception& e)
     {
         APP_ERROR("Main process terminated with: {}", e.what());
+        exitStatus = App::ExitStatus::FAILURE;
     }
 
-    return 0;
+    return static_cast<int>(exitStatus);
 }
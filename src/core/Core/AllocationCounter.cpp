@@ -0,0 +1,111 @@
+#include "AllocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace App {
+
+    namespace {
+#if APP_COUNT_ALLOCATIONS
+        // Constant-initialized, operator new already runs before main() and
+        // while a thread starts up.
+        thread_local std::uint64_t t_allocations{0};
+        std::atomic<std::uint64_t> g_allocations{0};
+
+        void* CountedAllocate(std::size_t size)
+        {
+            ++t_allocations;
+            g_allocations.fetch_add(1, std::memory_order_relaxed);
+            return std::malloc(size == 0 ? 1 : size);
+        }
+#endif
+    }
+
+    bool AllocationCounter::IsEnabled()
+    {
+#if APP_COUNT_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::uint64_t AllocationCounter::GetThreadAllocations()
+    {
+#if APP_COUNT_ALLOCATIONS
+        return t_allocations;
+#else
+        return 0;
+#endif
+    }
+
+    std::uint64_t AllocationCounter::GetTotalAllocations()
+    {
+#if APP_COUNT_ALLOCATIONS
+        return g_allocations.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+}
+
+#if APP_COUNT_ALLOCATIONS
+// The aligned overloads are left to the standard library, they pair up
+// among themselves and nothing in a frame uses them.
+
+void* operator new(const std::size_t size)
+{
+    void* const pointer{App::CountedAllocate(size)};
+    if(pointer == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+    return pointer;
+}
+
+void* operator new[](const std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t& /*tag*/) noexcept
+{
+    return App::CountedAllocate(size);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t& /*tag*/) noexcept
+{
+    return App::CountedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::size_t /*size*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::size_t /*size*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t& /*tag*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t& /*tag*/) noexcept
+{
+    std::free(pointer);
+}
+#endif
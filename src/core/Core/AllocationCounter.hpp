@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+namespace App {
+
+    // Counts calls of the global operator new, for checking that a steady
+    // frame does not touch the heap. Only built with APP_COUNT_ALLOCATIONS
+    // (the COUNT_ALLOCATIONS option, off by default), which replaces the
+    // global operator new and delete. Without it every count stays zero.
+    // Direct malloc calls, e.g. from SDL or C libraries, are not seen.
+    class AllocationCounter
+    {
+    public:
+        AllocationCounter() = delete;
+
+        [[nodiscard]] static bool IsEnabled();
+        // On the calling thread since it started.
+        [[nodiscard]] static std::uint64_t GetThreadAllocations();
+        // On all threads since the process started.
+        [[nodiscard]] static std::uint64_t GetTotalAllocations();
+    };
+
+}
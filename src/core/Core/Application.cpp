@@ -1,15 +1,120 @@
 #include "Application.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
 #include <backends/imgui_impl_opengl3.h>
 #include <backends/imgui_impl_sdl.h>
 #include <glad/glad.h>
 #include <imgui.h>
+#include <implot.h>
 
+#include "Core/FontAtlasCache.hpp"
+#include "Core/GpuProfiler.hpp"
 #include "Core/Instrumentor.hpp"
+#include "Core/JsonStreamParser.hpp"
+#include "Core/RenderThread.hpp"
+#include "Core/SampleItems.hpp"
+#include "Core/SizeClassPool.hpp"
 #include "StringUtils.h"
 
 namespace App {
 
-    Application::Application(const std::string& title)
+    namespace {
+        struct Joke
+        {
+            std::string id;
+            std::string value;
+        };
+
+        // Fills a Joke straight from the parser events, nested values are skipped.
+        class JokeReader : public JsonSaxDefaults
+        {
+        public:
+            Joke joke;
+
+            bool start_object(std::size_t /*size*/)
+            {
+                ++m_depth;
+                return true;
+            }
+
+            bool end_object()
+            {
+                --m_depth;
+                return true;
+            }
+
+            bool start_array(std::size_t /*size*/)
+            {
+                ++m_depth;
+                return true;
+            }
+
+            bool end_array()
+            {
+                --m_depth;
+                return true;
+            }
+
+            bool key(std::string& key)
+            {
+                m_field = nullptr;
+                if(m_depth == 1 && key == "id")
+                {
+                    m_field = &joke.id;
+                }
+                else if(m_depth == 1 && key == "value")
+                {
+                    m_field = &joke.value;
+                }
+                return true;
+            }
+
+            bool string(std::string& value)
+            {
+                if(m_field != nullptr)
+                {
+                    *m_field = std::move(value);
+                    m_field = nullptr;
+                }
+                return true;
+            }
+
+        private:
+            int m_depth{0};
+            std::string* m_field{nullptr};
+        };
+
+        struct JokeDecoder
+        {
+            JokeReader reader;
+            JsonStreamParser<JokeReader> parser{reader};
+        };
+
+        InputQueue::Settings GetInputQueueSettings(const Application::HeadlessSettings& headless)
+        {
+            InputQueue::Settings settings{};
+            settings.coalesce = headless.coalesceInput;
+            return settings;
+        }
+
+        constexpr Debug::ScopeDescriptor TimeToFirstFrameDescriptor{
+                "TimeToFirstFrame", __FILE__, __LINE__, Debug::ProfileCategory::Scope
+        };
+
+        // Written once into test.db on the writer thread, well under a second.
+        constexpr std::int64_t SampleItemCount{100000};
+    }
+
+    Application::Application(const std::string& title) : Application(title, HeadlessSettings{}) {}
+
+    Application::Application(const std::string& title, const HeadlessSettings& headless)
+            : m_headless(headless),
+              m_inputQueue(GetInputQueueSettings(headless)),
+              m_startupBegin(std::chrono::steady_clock::now())
     {
         APP_PROFILE_FUNCTION();
 
@@ -20,38 +125,80 @@ namespace App {
             return;
         }
 
-        if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0)
+        if(m_headless.enabled)
         {
-            APP_ERROR("Error: %s\n", SDL_GetError());
-            m_exitStatus = ExitStatus::FAILURE;
+            // Needs no display, the context comes from EGL (Mesa llvmpipe on build
+            // machines). An SDL_VIDEODRIVER environment variable still wins.
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+            m_idleSettings.enabled = false;
+            m_frameStats.Reserve(static_cast<std::size_t>(std::max(m_headless.frames, 0)));
         }
 
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
-
-        m_window = std::make_shared<Window>(Window::Settings{title});
-
-        // Setup Dear ImGui context
-        IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
+        // Before anything allocates through ImGui, the font atlas is built on a startup worker.
+        ImGui::SetAllocatorFunctions(&SizeClassPool::AllocateCallback, &SizeClassPool::FreeCallback, &SizeClassPool::Get());
+
+        using Affinity = StartupGraph::Affinity;
+
+        // Needed for the first frame. SDL and GL stay on this thread, only the
+        // font atlas is built aside, before ImGui exists.
+        const auto sdl{m_startup.Add("Init SDL", Affinity::MainThread, [this] { InitSdl(); })};
+        const auto window{m_startup.Add("Create window", Affinity::MainThread, [this, title] { CreateMainWindow(title); }, {sdl})};
+        const auto fonts{m_startup.Add("Build fonts", Affinity::Worker, [this] { BuildFonts(); }, {window})};
+        const auto imgui{m_startup.Add("Init ImGui", Affinity::MainThread, [this] { InitImGui(); }, {window, fonts})};
+
+        // Not needed for the first frame: loaded in parallel right away, but
+        // only handed over to the main thread once the first frame is shown.
+        const auto openDatabase{m_startup.Add("Open database", Affinity::Worker, [this] {
+            m_openedDatabase = std::make_unique<Database>(Database::Settings{"test.db"});
+        })};
+        const auto parseConfig{m_startup.Add("Parse config", Affinity::Worker, [this] {
+            m_parsedConfig = std::make_unique<XmlConfig>("xgconsole.xml", std::vector<std::string>{"Profile/Tools/Tool"});
+        })};
+        m_firstFrameGate = m_startup.AddGate("First frame");
+
+        const auto database{m_startup.Add("Init database", Affinity::MainThread, [this] {
+            m_database = std::move(m_openedDatabase);
+            InitDatabase();
+        }, {openDatabase, m_firstFrameGate})};
+        const auto config{m_startup.Add("Publish config", Affinity::MainThread, [this] {
+            m_config = std::move(m_parsedConfig);
+        }, {parseConfig, m_firstFrameGate})};
+
+        if(!m_headless.enabled)
+        {
+            // After the database, TestCurl() goes through the HTTP cache.
+            m_startup.Add("Tests", Affinity::MainThread, [this] { Tests(); }, {config, database});
+        }
 
-        SetTheme();
+        m_startup.Start();
+        m_startup.Wait(imgui);
 
-        // Setup Platform/Renderer backends
-        ImGui_ImplSDL2_InitForOpenGL(m_window->GetNativeWindow(), m_window->GetNativeContext());
-        ImGui_ImplOpenGL3_Init("#version 410 core");
-
-        InitDatabase();
+        m_httpClient.SetCompletionNotifier([this] { RequestRedraw(); });
+        m_startup.SetMainThreadNotifier([this] { RequestRedraw(); });
+        m_jobs.SetMainThreadNotifier([this] { RequestRedraw(); });
+        m_profilerPanel.SetViewportRenderer(&m_viewportRenderer);
+        m_profilerPanel.SetFrameArena(&m_frameArena);
     }
 
     Application::~Application()
     {
         APP_PROFILE_FUNCTION();
 
+        // Left running when Run() threw, the GL teardown below needs the context back.
+        m_renderThread.reset();
+
+        m_startup.SetMainThreadNotifier(nullptr);
+        m_jobs.SetMainThreadNotifier(nullptr);
+        m_httpClient.SetCompletionNotifier(nullptr);
+        if(m_database != nullptr)
+        {
+            m_database->SetCompletionNotifier(nullptr);
+        }
+
+        APP_PROFILE_GPU_SHUTDOWN();
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplSDL2_Shutdown();
+        ImPlot::DestroyContext();
         ImGui::DestroyContext();
 
         SDL_Quit();
@@ -66,39 +213,78 @@ namespace App {
             return m_exitStatus;
         }
 
-        Tests();
-
         m_state.running = true;
 
         const ImGuiIO& io{ImGui::GetIO()};
 
+        if(m_renderSettings.pipelined)
+        {
+            StartRenderThread();
+        }
+
         while(m_state.running)
         {
+            WaitForEvents();
+            if(m_renderThread == nullptr)
+            {
+                m_window->WaitForNextFrame();
+            }
+            else
+            {
+                // The render thread paces itself, this one waits for room in its queue.
+                m_renderThread->WaitForFreeSnapshot();
+            }
+
             APP_PROFILE_SCOPE("MainLoop");
 
-            SDL_Event event{};
-            while(SDL_PollEvent(&event) != 0)
+            // Nothing from the previous iteration is used past its end, a skipped frame included.
+            m_frameArena.Reset();
+
+            if(m_headless.enabled)
             {
-                APP_PROFILE_SCOPE("EventPolling");
+                RunHeadlessScript();
+                m_frameStats.BeginFrame();
+            }
 
-                ImGui_ImplSDL2_ProcessEvent(&event);
+            for(bool inputPending{true}; inputPending;)
+            {
+                APP_PROFILE_SCOPE_CATEGORY("EventPolling", Hot);
 
-                if(event.type == SDL_QUIT)
-                {
-                    Stop();
-                }
+                inputPending = m_inputQueue.Drain();
+                m_inputQueue.Dispatch([this](const InputQueue::Entry& entry) { DispatchEvent(entry); });
+            }
 
-                if(event.type == SDL_WINDOWEVENT
-                   && event.window.windowID == SDL_GetWindowID(m_window->GetNativeWindow()))
-                {
-                    OnEvent(event.window);
-                }
+            m_httpClient.DispatchCompleted();
+            if(m_database != nullptr)
+            {
+                m_database->DispatchCompleted();
+            }
+            m_startup.Poll();
+            m_jobs.DispatchMainThread();
+
+            if(m_redrawRequested.exchange(false))
+            {
+                m_state.redrawFrames = std::max(m_state.redrawFrames, 1);
+            }
+            m_frameStats.Lap(FrameStats::Phase::Events);
+
+            if(m_idleSettings.enabled && m_state.minimized)
+            {
+                // Started minimized nothing is drawn until a restore, the
+                // deferred startup must not wait for that.
+                m_startup.Open(m_firstFrameGate);
+                continue;
             }
 
             // Start the Dear ImGui frame
-            ImGui_ImplOpenGL3_NewFrame();
+            if(m_renderThread == nullptr)
+            {
+                APP_PROFILE_GPU_FRAME();
+                ImGui_ImplOpenGL3_NewFrame();
+            }
             ImGui_ImplSDL2_NewFrame();
             ImGui::NewFrame();
+            m_frameStats.Lap(FrameStats::Phase::NewFrame);
 
             if(!m_state.minimized)
             {
@@ -117,6 +303,10 @@ namespace App {
                     if(ImGui::BeginMenu("View"))
                     {
                         ImGui::MenuItem("Some Panel", nullptr, &m_state.showSomePanel);
+                        ImGui::MenuItem("Profiler", nullptr, &m_state.showProfilerPanel);
+                        ImGui::MenuItem("Data table", nullptr, &m_state.showDataTable, m_dataTable != nullptr);
+                        ImGui::MenuItem("Telemetry", nullptr, &m_state.showTelemetry);
+                        ImGui::MenuItem("ImGui Demo", nullptr, &m_state.showDemoWindow);
                         ImGui::EndMenu();
                     }
 
@@ -124,10 +314,25 @@ namespace App {
                 }
             }
 
-            if(m_state.showInGameBrowserWindow)
+            if(m_state.showInGameBrowserWindow && m_renderThread == nullptr)
             {
                 ImGui::ShowBrowserWindow(&m_state.showInGameBrowserWindow, ImGui_ImplSDL2_GetCefTexture());
             }
+            {
+                // The browser window's own collapse and dock state is not exposed by the
+                // backend, what the application knows is enough to pause a hidden browser.
+                const Uint32 windowFlags{SDL_GetWindowFlags(m_window->GetNativeWindow())};
+                BrowserVisibility browserVisibility{};
+                browserVisibility.open = m_state.showInGameBrowserWindow;
+                browserVisibility.visible = !m_state.minimized;
+                browserVisibility.focused = (windowFlags & SDL_WINDOW_INPUT_FOCUS) != 0;
+                m_browserThrottle.Update(browserVisibility);
+            }
+            if(m_browserThrottle.GetState() != BrowserThrottle::State::Paused)
+            {
+                // The browser texture changes in place, the draw data showing it does not.
+                m_viewportRenderer.Invalidate();
+            }
 
             // Whatever GUI to implement here ...
             if(m_state.showSomePanel)
@@ -139,32 +344,92 @@ namespace App {
 
                 if(ImGui::Button("Login"))
                 {
-                    bool bSuccess;
-                    std::string responseJson;
-                    Login(bSuccess, responseJson);
-                    printf("Login: bSuccess<%s> json<%s>\n", BOOL_TO_STRING(bSuccess), responseJson.c_str());
+                    Login([](const bool bSuccess, const std::string& responseJson) {
+                        printf("Login: bSuccess<%s> json<%s>\n", BOOL_TO_STRING(bSuccess), responseJson.c_str());
+                    });
                 }
 
                 ImGui::End();
             }
 
+            m_profilerPanel.Render(&m_state.showProfilerPanel);
+
+            if(m_state.showDataTable && m_dataTable != nullptr)
+            {
+                if(ImGui::Begin("Data table", &m_state.showDataTable))
+                {
+                    m_dataTable->Render();
+                }
+                ImGui::End();
+            }
+
+            m_telemetryPanel.Render(&m_state.showTelemetry);
+
+            if(m_state.showDemoWindow)
+            {
+                ImGui::ShowDemoWindow(&m_state.showDemoWindow);
+            }
+
+            if(m_headless.enabled)
+            {
+                BuildHeadlessViewports();
+            }
+            m_frameStats.Lap(FrameStats::Phase::BuildUi);
+
             // Rendering
             ImGui::Render();
-            glViewport(0, 0, static_cast<int>(io.DisplaySize.x), static_cast<int>(io.DisplaySize.y));
-            glClearColor(0.5F, 0.5F, 0.5F, 1.00F);
-            glClear(GL_COLOR_BUFFER_BIT);
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            if(m_renderThread != nullptr)
+            {
+                // Copies the draw data, the swap happens on the render thread.
+                m_renderThread->Submit(*ImGui::GetDrawData(), std::exchange(m_frameInputTime, {}));
+            }
+            else
+            {
+                RenderDrawData(*ImGui::GetDrawData());
+            }
 
             if((io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) != 0)
             {
-                SDL_Window* backup_current_window{SDL_GL_GetCurrentWindow()};
-                SDL_GLContext backup_current_context{SDL_GL_GetCurrentContext()};
+                APP_PROFILE_SCOPE("RenderPlatformWindows");
                 ImGui::UpdatePlatformWindows();
-                ImGui::RenderPlatformWindowsDefault();
-                SDL_GL_MakeCurrent(backup_current_window, backup_current_context);
+                // Instead of RenderPlatformWindowsDefault(), which waits for vsync in every window.
+                m_viewportRenderer.Render();
+            }
+            m_frameStats.Lap(FrameStats::Phase::Render);
+
+            if(m_renderThread == nullptr)
+            {
+                APP_PROFILE_SCOPE("SwapWindow");
+                APP_PROFILE_GPU_SCOPE("SwapWindow");
+                if(const std::chrono::microseconds inputLatency{m_window->Present()}; inputLatency.count() > 0)
+                {
+                    m_frameStats.AddInputLatency(inputLatency);
+                }
+            }
+            if(m_renderThread == nullptr && !m_firstFrameShown)
+            {
+                OnFirstFrameShown(std::chrono::steady_clock::now());
+            }
+            m_frameStats.Lap(FrameStats::Phase::Swap);
+            m_frameStats.EndFrame();
+
+            if(m_state.redrawFrames > 0)
+            {
+                --m_state.redrawFrames;
+            }
+
+            if(m_headless.enabled)
+            {
+                EndHeadlessFrame();
             }
+        }
 
-            SDL_GL_SwapWindow(m_window->GetNativeWindow());
+        // Presents the frames still queued and hands the GL context back.
+        m_renderThread.reset();
+
+        if(m_headless.enabled)
+        {
+            ReportFrameStats();
         }
 
         return m_exitStatus;
@@ -175,6 +440,265 @@ namespace App {
         m_state.running = false;
     }
 
+    void Application::DispatchEvent(const InputQueue::Entry& entry)
+    {
+        const SDL_Event& event{entry.event};
+        ImGui_ImplSDL2_ProcessEvent(&event);
+
+        if(event.type >= SDL_KEYDOWN && event.type < SDL_CLIPBOARDUPDATE)
+        {
+            if(m_renderThread == nullptr)
+            {
+                m_window->OnInput(entry.time);
+            }
+            else if(m_frameInputTime == std::chrono::steady_clock::time_point{} || entry.time < m_frameInputTime)
+            {
+                m_frameInputTime = entry.time;
+            }
+        }
+
+        if(event.type == SDL_QUIT)
+        {
+            Stop();
+        }
+
+        if(event.type == SDL_WINDOWEVENT && event.window.windowID == m_window->GetId())
+        {
+            OnEvent(event.window);
+        }
+
+        // Any event, including a RequestRedraw() wake-up, may change what ImGui shows.
+        m_state.redrawFrames = m_idleSettings.redrawFramesAfterInput;
+    }
+
+    void Application::SetIdleSettings(const IdleSettings& settings)
+    {
+        m_idleSettings = settings;
+    }
+
+    void Application::SetRenderSettings(const RenderSettings& settings)
+    {
+        m_renderSettings = settings;
+    }
+
+    void Application::RequestRedraw()
+    {
+        m_redrawRequested.store(true);
+
+        SDL_Event event{};
+        event.type = m_wakeUpEventType;
+        SDL_PushEvent(&event);
+    }
+
+    void Application::SetBrowserBackend(BrowserBackend* backend)
+    {
+        m_browserThrottle.SetBackend(backend);
+    }
+
+    bool Application::NeedsRedraw() const
+    {
+        // The browser texture, the profiler and the telemetry change without any SDL event.
+        return m_state.redrawFrames > 0
+               || m_redrawRequested.load()
+               || m_browserThrottle.GetState() != BrowserThrottle::State::Paused
+               || m_state.showProfilerPanel
+               || m_state.showTelemetry
+               || (m_state.showDataTable && m_dataTable != nullptr && m_dataTable->IsBusy());
+    }
+
+    void Application::WaitForEvents()
+    {
+        if(!m_idleSettings.enabled || (!m_state.minimized && NeedsRedraw()))
+        {
+            return;
+        }
+
+        APP_PROFILE_SCOPE("Idle");
+
+        // Leaves the event in the queue, the poll loop picks it up. A timeout
+        // renders one frame anyway.
+        SDL_WaitEventTimeout(nullptr, static_cast<int>(m_idleSettings.maxWait.count()));
+    }
+
+    void Application::RunHeadlessScript()
+    {
+        APP_PROFILE_FUNCTION();
+
+        if(m_headlessFrame == 0)
+        {
+            m_state.showSomePanel = true;
+            m_state.showProfilerPanel = true;
+            m_state.showDemoWindow = true;
+        }
+
+        int width{0};
+        int height{0};
+        SDL_GetWindowSize(m_window->GetNativeWindow(), &width, &height);
+
+        // The cursor sweeps the whole window so hover, tooltips and plot
+        // cursors are exercised, the same path every run. Several events per
+        // frame split the frame's stretch of the path, like a fast mouse.
+        constexpr double TwoPi{6.283185307179586};
+        const int motionEvents{std::max(m_headless.motionEventsPerFrame, 1)};
+
+        SDL_Event motion{};
+        motion.motion.type = SDL_MOUSEMOTION;
+        motion.motion.windowID = m_window->GetId();
+        for(int i = 1; i <= motionEvents; ++i)
+        {
+            const double t{(static_cast<double>(m_headlessFrame) + static_cast<double>(i) / motionEvents) / 240.0};
+            const double x{0.5 + 0.45 * std::sin(TwoPi * 3.0 * t)};
+            const double y{0.5 + 0.45 * std::sin(TwoPi * 2.0 * t)};
+            motion.motion.x = static_cast<Sint32>(x * width);
+            motion.motion.y = static_cast<Sint32>(y * height);
+            SDL_PushEvent(&motion);
+        }
+
+        if(m_headlessFrame % 20 == 10)
+        {
+            SDL_Event wheel{};
+            wheel.wheel.type = SDL_MOUSEWHEEL;
+            wheel.wheel.windowID = motion.motion.windowID;
+            wheel.wheel.y = (m_headlessFrame / 20) % 2 == 0 ? -1 : 1;
+            SDL_PushEvent(&wheel);
+        }
+    }
+
+    void Application::BuildHeadlessViewports()
+    {
+        APP_PROFILE_FUNCTION();
+
+        // Side by side to the right of the main window, so the scripted cursor
+        // never hovers them. Only the first one changes every frame, the
+        // others show whether unchanged viewports are skipped.
+        const ImGuiViewport* mainViewport{ImGui::GetMainViewport()};
+        constexpr int Columns{4};
+        constexpr float Width{240.0F};
+        constexpr float Height{160.0F};
+        constexpr float Gap{16.0F};
+
+        for(int i = 0; i < m_headless.detachedViewports; ++i)
+        {
+            const ImVec2 position{mainViewport->Pos.x + mainViewport->Size.x + Gap + static_cast<float>(i % Columns) * (Width + Gap),
+                                  mainViewport->Pos.y + static_cast<float>(i / Columns) * (Height + Gap)};
+            ImGui::SetNextWindowPos(position, ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2(Width, Height), ImGuiCond_Always);
+
+            std::array<char, 32> title{};
+            std::snprintf(title.data(), title.size(), "Viewport %d", i);
+            if(ImGui::Begin(title.data()))
+            {
+                if(i == 0)
+                {
+                    ImGui::Text("Frame %d", m_headlessFrame);
+                }
+                else
+                {
+                    ImGui::TextUnformatted("Static content");
+                }
+                for(int line = 0; line < 6; ++line)
+                {
+                    ImGui::Text("Line %d of panel %d", line, i);
+                }
+            }
+            ImGui::End();
+        }
+    }
+
+    void Application::EndHeadlessFrame()
+    {
+        ++m_headlessFrame;
+        if(m_headlessFrame == m_headless.warmupFrames)
+        {
+            m_frameStats.Clear();
+            m_inputQueue.ResetStats();
+        }
+        if(m_headlessFrame >= m_headless.warmupFrames + m_headless.frames)
+        {
+            Stop();
+        }
+    }
+
+    void Application::ReportFrameStats()
+    {
+        const FrameStats::Report report{m_frameStats.GetReport()};
+        FrameStats::Print(report, stdout);
+
+        const InputQueue::Stats& input{m_inputQueue.GetStats()};
+        std::fprintf(stdout, "events: %zu polled, %zu coalesced, %zu dispatched\n",
+                     input.polled, input.coalesced, input.dispatched);
+
+        if(m_headless.maxFrameAllocations >= 0)
+        {
+            const auto limit{static_cast<std::uint64_t>(m_headless.maxFrameAllocations)};
+            if(!report.allocationsCounted)
+            {
+                APP_WARN("The allocation limit is not checked, build with COUNT_ALLOCATIONS");
+            }
+            else if(report.maxFrameAllocations > limit)
+            {
+                APP_ERROR("A frame allocated {} times on the UI thread, the limit is {}", report.maxFrameAllocations, limit);
+                m_exitStatus = ExitStatus::FAILURE;
+            }
+        }
+
+        if(m_headless.reportPath.empty())
+        {
+            return;
+        }
+        if(!FrameStats::WriteJson(report, m_headless.reportPath))
+        {
+            APP_ERROR("Could not write the frame statistics to {}", m_headless.reportPath);
+            m_exitStatus = ExitStatus::FAILURE;
+        }
+    }
+
+    void Application::StartRenderThread()
+    {
+        APP_PROFILE_FUNCTION();
+
+        // Creates the backend's shaders and font texture while the context is
+        // still current here, afterwards only the render thread touches GL.
+        ImGui_ImplOpenGL3_NewFrame();
+
+        // Secondary viewports are rendered and swapped by ImGui on this thread.
+        ImGui::GetIO().ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+        m_state.showInGameBrowserWindow = false;
+
+        m_renderThread = std::make_unique<RenderThread>(
+                *m_window,
+                [](ImDrawData& drawData) {
+                    APP_PROFILE_GPU_FRAME();
+                    RenderDrawData(drawData);
+                },
+                [this](const std::chrono::microseconds inputLatency) {
+                    if(inputLatency.count() > 0)
+                    {
+                        m_frameStats.AddInputLatency(inputLatency);
+                    }
+                    // Submit() returns before anything is drawn, the first frame is shown here.
+                    if(!m_firstFramePresented.exchange(true))
+                    {
+                        m_jobs.ScheduleOnMainThread([this, shown = std::chrono::steady_clock::now()] {
+                            if(!m_firstFrameShown)
+                            {
+                                OnFirstFrameShown(shown);
+                            }
+                        });
+                    }
+                });
+    }
+
+    void Application::RenderDrawData(ImDrawData& drawData)
+    {
+        APP_PROFILE_SCOPE("RenderDrawData");
+        APP_PROFILE_GPU_SCOPE("RenderDrawData");
+        glViewport(0, 0, static_cast<int>(drawData.DisplaySize.x), static_cast<int>(drawData.DisplaySize.y));
+        glClearColor(0.5F, 0.5F, 0.5F, 1.00F);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(&drawData);
+    }
+
     void Application::OnEvent(const SDL_WindowEvent& event)
     {
         APP_PROFILE_FUNCTION();
@@ -210,6 +734,98 @@ namespace App {
         Stop();
     }
 
+    void Application::InitSdl()
+    {
+        if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0)
+        {
+            APP_ERROR("Error: %s\n", SDL_GetError());
+            m_exitStatus = ExitStatus::FAILURE;
+        }
+
+        if(const Uint32 eventType{SDL_RegisterEvents(1)}; eventType != static_cast<Uint32>(-1))
+        {
+            m_wakeUpEventType = eventType;
+        }
+
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+    }
+
+    void Application::CreateMainWindow(const std::string& title)
+    {
+        Window::Settings windowSettings{title};
+        if(m_headless.enabled)
+        {
+            // Measures the frame itself, not the wait for the display.
+            windowSettings.vsync = Window::VSync::Off;
+            windowSettings.hidden = true;
+        }
+        m_window = std::make_shared<Window>(windowSettings);
+
+        // SDL wants its video calls on the main thread, the font worker only gets the result.
+        m_fontScale = m_window->GetScale();
+    }
+
+    void Application::BuildFonts()
+    {
+        // No ImGui context exists yet, so the atlas' allocations race with nothing.
+        m_fontAtlas = std::make_unique<ImFontAtlas>();
+
+        // Rasterizing the atlas dominates a cold start, a warm one reads it back.
+        FontAtlasCache fontCache{"font_atlas.cache"};
+        fontCache.Build(*m_fontAtlas, {FontSource{"assets/fonts/Manrope/Manrope-Regular.ttf", 18.0F * m_fontScale}});
+    }
+
+    void Application::InitImGui()
+    {
+        // Setup Dear ImGui context
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext(m_fontAtlas.get());
+        ImPlot::CreateContext();
+
+        SetTheme();
+
+        if(m_headless.enabled)
+        {
+            // The same workload on every run: no saved layout and no extra OS windows.
+            ImGuiIO& io{ImGui::GetIO()};
+            io.IniFilename = nullptr;
+            if(m_headless.detachedViewports > 0)
+            {
+                // Each panel gets a window of its own even where it could merge.
+                io.ConfigViewportsNoAutoMerge = true;
+            }
+            else
+            {
+                io.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+            }
+        }
+
+        // Setup Platform/Renderer backends
+        ImGui_ImplSDL2_InitForOpenGL(m_window->GetNativeWindow(), m_window->GetNativeContext());
+        ImGui_ImplOpenGL3_Init("#version 410 core");
+        APP_PROFILE_GPU_INIT();
+    }
+
+    void Application::OnFirstFrameShown(const std::chrono::steady_clock::time_point shown)
+    {
+        m_firstFrameShown = true;
+
+        const auto timeToFirstFrame{std::chrono::duration_cast<std::chrono::microseconds>(shown - m_startupBegin)};
+        APP_INFO("First frame shown {:.1f} ms after startup", static_cast<double>(timeToFirstFrame.count()) / 1000.0);
+
+        Debug::Instrumentor::Get().WriteProfile(
+                Debug::Instrumentor::Get().CreateTrack("Startup"),
+                {&TimeToFirstFrameDescriptor,
+                 Debug::FloatingPointMicroseconds{m_startupBegin.time_since_epoch()},
+                 timeToFirstFrame});
+
+        // Deferred startup tasks run from the next Poll() on.
+        m_startup.Open(m_firstFrameGate);
+    }
+
     void Application::SetTheme() const
     {
         APP_PROFILE_FUNCTION();
@@ -221,13 +837,12 @@ namespace App {
                           | ImGuiConfigFlags_DockingEnable
                           | ImGuiConfigFlags_ViewportsEnable;
 
-        // ImGui font
-        const float font_scaling_factor{m_window->GetScale()};
-        const float font_size{18.0F * font_scaling_factor};
-
-        io.Fonts->AddFontFromFileTTF("assets/fonts/Manrope/Manrope-Regular.ttf", font_size);
-        io.FontDefault = io.Fonts->AddFontFromFileTTF("assets/fonts/Manrope/Manrope-Regular.ttf", font_size);
-        io.FontGlobalScale = 1.0F / font_scaling_factor;
+        // ImGui font, the atlas was built by BuildFonts()
+        if(!io.Fonts->Fonts.empty())
+        {
+            io.FontDefault = io.Fonts->Fonts[0];
+        }
+        io.FontGlobalScale = 1.0F / m_fontScale;
 
         style.WindowRounding = 5.3F;
         style.GrabRounding = style.FrameRounding = 2.3F;
@@ -250,7 +865,8 @@ namespace App {
     void Application::SetCommandLineArgs(const int argc, const char* argv[])
     {
         m_argCount = argc;
-        m_args = std::vector<std::string>(m_argCount);
+        m_args.clear();
+        m_args.reserve(static_cast<std::size_t>(argc));
         for(int i = 0; i < argc; ++i)
         {
             m_args.emplace_back(argv[i]);
@@ -275,20 +891,22 @@ namespace App {
 
     void Application::InitDatabase()
     {
-        sqlite3* db = nullptr;
-        [[maybe_unused]] char* zErrMsg = nullptr;
-        int rc = 0;
-
-        rc = sqlite3_open("test.db", &db);
-        if(rc != 0)
+        if(m_database == nullptr || !m_database->IsOpen())
         {
-            fprintf(stderr, "Can't open database: %s\n", sqlite3_errmsg(db));
             return;
         }
 
+        m_database->SetCompletionNotifier([this] { RequestRedraw(); });
         fprintf(stdout, "Opened database successfully\n");
 
-        sqlite3_close(db);
+        m_httpCache = std::make_unique<HttpCache>(m_httpClient, *m_database, m_jobs);
+
+        SampleItems::Create(*m_database, SampleItemCount, [this](const Database::Result& result) {
+            if(result.Succeeded())
+            {
+                m_dataTable = std::make_unique<DataTable>(*m_database, DataTable::Settings{SampleItems::GetPagerSettings()});
+            }
+        });
     }
 
     void Application::Tests()
@@ -314,14 +932,18 @@ namespace App {
 
     int Application::TestXml()
     {
-        pugi::xml_document doc;
-        pugi::xml_parse_result result = doc.load_file("xgconsole.xml");
-        if(!result)
+        if(m_config == nullptr)
+        {
+            return -1;
+        }
+
+        const auto config{m_config->GetSnapshot()};
+        if(config == nullptr)
         {
             return -1;
         }
 
-        for(pugi::xml_node tool: doc.child("Profile").child("Tools").children("Tool"))
+        for(const pugi::xml_node tool: config->Select("Profile/Tools/Tool"))
         {
             int timeout = tool.attribute("Timeout").as_int();
 
@@ -336,31 +958,50 @@ namespace App {
 
     void Application::TestCurl()
     {
-        printf("\n");
-        CURL* curl;
-        CURLcode res;
-        curl = curl_easy_init();
-        if(curl)
+        HttpClient::Request request{};
+        request.url = "https://api.chucknorris.io/jokes/random";
+
+        if(m_httpCache != nullptr)
         {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "GET");
-            curl_easy_setopt(curl, CURLOPT_URL, "https://api.chucknorris.io/jokes/random");
-            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            curl_easy_setopt(curl, CURLOPT_DEFAULT_PROTOCOL, "https");
-            struct curl_slist* headers = NULL;
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            res = curl_easy_perform(curl);
-            res = res;
-            int x = 1;
-            x++;
+            // A stale copy may come first and the new one after it, a decoder each.
+            m_httpCache->Send(std::move(request), [](const HttpCache::Response& response) {
+                JokeDecoder decoder{};
+                if(!response.Succeeded() || !decoder.parser.Feed(*response.body) || !decoder.parser.Finish())
+                {
+                    printf("\ncurl: status<%ld> error<%s%s>\n",
+                           response.status,
+                           response.error.c_str(),
+                           decoder.parser.GetError().c_str());
+                    return;
+                }
+                printf("\ncurl: joke<%s> <%s>%s\n",
+                       decoder.reader.joke.id.c_str(),
+                       decoder.reader.joke.value.c_str(),
+                       response.stale ? " stale" : "");
+            });
+            return;
         }
-        curl_easy_cleanup(curl);
-        printf("\n");
+
+        // Without the database there is no cache. Decoded while the body
+        // arrives, neither the body nor a json DOM is kept.
+        auto decoder{std::make_shared<JokeDecoder>()};
+        request.onData = [decoder](const std::string_view chunk) { return decoder->parser.Feed(chunk); };
+        m_httpClient.Send(std::move(request), [decoder](const HttpClient::Response& response) {
+            if(!response.Succeeded() || !decoder->parser.Finish())
+            {
+                printf("\ncurl: status<%ld> error<%s%s>\n",
+                       response.status,
+                       response.error.c_str(),
+                       decoder->parser.GetError().c_str());
+                return;
+            }
+            printf("\ncurl: joke<%s> <%s>\n", decoder->reader.joke.id.c_str(), decoder->reader.joke.value.c_str());
+        });
     }
-    void Application::Login(bool& bSuccess, std::string& responseJson)
-    {
-        bSuccess = false;
-        responseJson = "";
 
-        // TODO ...
+    void Application::Login(std::function<void(bool bSuccess, const std::string& responseJson)> onDone)
+    {
+        // TODO Send the credentials through m_httpClient and call onDone from its callback.
+        onDone(false, "");
     }
 }
\ No newline at end of file
@@ -1,17 +1,39 @@
 #pragma once
 #include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
+#include "Core/BrowserThrottle.hpp"
+#include "Core/DataTable.hpp"
+#include "Core/Database.hpp"
+#include "Core/FrameArena.hpp"
+#include "Core/FrameStats.hpp"
+#include "Core/HttpCache.hpp"
+#include "Core/HttpClient.hpp"
+#include "Core/InputQueue.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/ProfilerPanel.hpp"
+#include "Core/StartupGraph.hpp"
+#include "Core/TelemetryPanel.hpp"
+#include "Core/ViewportRenderer.hpp"
 #include "Core/Window.hpp"
+#include "Core/XmlConfig.hpp"
 
 #include <sqlite3.h>
 #include <nlohmann/json.hpp>
 #include <pugixml.hpp>
 #include <curl/curl.h>
 
+struct ImDrawData;
+struct ImFontAtlas;
+
 namespace App {
 
+    class RenderThread;
+
     enum class ExitStatus : int
     {
         SUCCESS = 0,
@@ -20,6 +42,47 @@ namespace App {
 
     class Application
     {
+    public:
+        struct IdleSettings
+        {
+            // Block in SDL_WaitEventTimeout while nothing needs a redraw.
+            bool enabled{true};
+            // Frames still rendered after the last event so ImGui can settle.
+            int redrawFramesAfterInput{3};
+            // Longest sleep without any event, keeps e.g. a blinking text cursor alive.
+            std::chrono::milliseconds maxWait{500};
+        };
+
+        // Benchmark run: hidden window on the offscreen video driver, no vsync or
+        // idling, a scripted UI workload and a frame-time report at the end.
+        struct HeadlessSettings
+        {
+            bool enabled{false};
+            // Frames measured after the warm-up.
+            int frames{600};
+            // Excluded from the report, they compile shaders and upload the font atlas.
+            int warmupFrames{10};
+            std::string reportPath{"frame_stats.json"};
+            // Static panels torn off into windows of their own, zero keeps
+            // everything in the main window with viewports off.
+            int detachedViewports{0};
+            // Synthetic mouse motion per frame, a 1000 Hz mouse at 60 fps sends about 17.
+            int motionEventsPerFrame{1};
+            // Off dispatches every event as it came, to compare against.
+            bool coalesceInput{true};
+            // Fails the run when a measured frame allocated more often on the
+            // UI thread, negative for no limit. Needs COUNT_ALLOCATIONS.
+            int maxFrameAllocations{-1};
+        };
+
+        struct RenderSettings
+        {
+            // Builds the next frame while a RenderThread draws and presents the
+            // previous one. Costs up to a frame of latency, and the browser
+            // window and extra viewports are off since they need GL on this thread.
+            bool pipelined{false};
+        };
+
     private:
         struct State
         {
@@ -27,18 +90,67 @@ namespace App {
             bool minimized{false};
             bool showSomePanel{true};
             bool showInGameBrowserWindow{false};
+            bool showProfilerPanel{false};
+            bool showDataTable{false};
+            bool showTelemetry{false};
+            bool showDemoWindow{false};
+            int redrawFrames{0};
         };
 
     private:
         ExitStatus m_exitStatus{ExitStatus::SUCCESS};
         std::shared_ptr<Window> m_window{nullptr};
         State m_state{};
+        IdleSettings m_idleSettings{};
+        std::atomic<bool> m_redrawRequested{false};
+        Uint32 m_wakeUpEventType{SDL_USEREVENT};
+        ViewportRenderer m_viewportRenderer{};
+        Debug::ProfilerPanel m_profilerPanel{};
+        TelemetryPanel m_telemetryPanel{};
+        HttpClient m_httpClient{};
+        // Both arrive after the first frame, see the startup tasks.
+        std::unique_ptr<Database> m_database{};
+        std::unique_ptr<XmlConfig> m_config{};
+        // Once the sample table is written, see InitDatabase(). Before m_database goes.
+        std::unique_ptr<DataTable> m_dataTable{};
+        BrowserThrottle m_browserThrottle{};
+        HeadlessSettings m_headless{};
+        InputQueue m_inputQueue{};
+        FrameStats m_frameStats{};
+        // Reset at the top of every iteration of Run(), UI thread only.
+        FrameArena m_frameArena{};
+        int m_headlessFrame{0};
+        RenderSettings m_renderSettings{};
+        // Only while Run() is pipelined, owns the GL context then.
+        std::unique_ptr<RenderThread> m_renderThread{};
+        // Earliest input of the frame being built, handed to the render thread with it.
+        std::chrono::steady_clock::time_point m_frameInputTime{};
+
+        std::chrono::steady_clock::time_point m_startupBegin{};
+        // Written by startup workers, read on the main thread once the graph says they finished.
+        std::unique_ptr<ImFontAtlas> m_fontAtlas{};
+        float m_fontScale{1.0F};
+        std::unique_ptr<Database> m_openedDatabase{};
+        std::unique_ptr<XmlConfig> m_parsedConfig{};
+        StartupGraph::TaskId m_firstFrameGate{0};
+        bool m_firstFrameShown{false};
+        // Set by the render thread on its first present.
+        std::atomic<bool> m_firstFramePresented{false};
 
         int m_argCount{0};
         std::vector<std::string> m_args{};
 
+        // Destroyed before the members above, waits for the running jobs that use them.
+        JobSystem m_jobs{};
+        // Over m_httpClient, m_database and m_jobs, so destroyed before all three.
+        // Once the database is open, see InitDatabase().
+        std::unique_ptr<HttpCache> m_httpCache{};
+        // Last, destroyed first: waits for running startup tasks that fill the members above.
+        StartupGraph m_startup{};
+
     public:
         explicit Application(const std::string& title);
+        Application(const std::string& title, const HeadlessSettings& headless);
         ~Application();
 
         Application(const Application&) = delete;
@@ -54,6 +166,14 @@ namespace App {
         ExitStatus Run();
         void Stop();
 
+        void SetIdleSettings(const IdleSettings& settings);
+        // Before Run().
+        void SetRenderSettings(const RenderSettings& settings);
+        // Wakes up an idle loop for at least one frame, safe to call from any thread.
+        void RequestRedraw();
+        // Lets the browser bridge be paused and throttled with the browser window.
+        void SetBrowserBackend(BrowserBackend* backend);
+
         void OnEvent(const SDL_WindowEvent& event);
         void OnResized(const SDL_WindowEvent& event);
         void OnMinimized();
@@ -61,11 +181,33 @@ namespace App {
         void OnClose();
 
     private:
+        void DispatchEvent(const InputQueue::Entry& entry);
+        [[nodiscard]] bool NeedsRedraw() const;
+        void WaitForEvents();
+
+        // Feeds the synthetic input of the headless workload for the next frame.
+        void RunHeadlessScript();
+        void BuildHeadlessViewports();
+        void EndHeadlessFrame();
+        void ReportFrameStats();
+
+        void StartRenderThread();
+        // Draws the main viewport into the current framebuffer, on whichever
+        // thread owns the GL context.
+        static void RenderDrawData(ImDrawData& drawData);
+
+        // Startup tasks, see the constructor for what depends on what.
+        void InitSdl();
+        void CreateMainWindow(const std::string& title);
+        void BuildFonts();
+        void InitImGui();
+        void OnFirstFrameShown(std::chrono::steady_clock::time_point shown);
+
         void InitDatabase();
 
         void SetTheme() const;
 
-        void Login(bool& bSuccess, std::string& responseJson);
+        void Login(std::function<void(bool bSuccess, const std::string& responseJson)> onDone);
 
         // DEBUG ---------------------------------------------------------------
         void Tests();
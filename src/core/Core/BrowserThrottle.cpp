@@ -0,0 +1,93 @@
+#include "BrowserThrottle.hpp"
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    BrowserThrottle::BrowserThrottle() : BrowserThrottle(Settings{})
+    {
+    }
+
+    BrowserThrottle::BrowserThrottle(const Settings& settings) : m_settings(settings)
+    {
+    }
+
+    void BrowserThrottle::SetBackend(BrowserBackend* backend)
+    {
+        m_backend = backend;
+        // A new backend has its own defaults, state and size go out again.
+        m_applied = false;
+        m_width = 0;
+        m_height = 0;
+    }
+
+    void BrowserThrottle::Update(const BrowserVisibility& visibility)
+    {
+        APP_PROFILE_FUNCTION();
+
+        State state{State::Paused};
+        if(visibility.open && visibility.visible)
+        {
+            state = visibility.focused ? State::Full : State::Low;
+        }
+        if(!m_applied || state != m_state)
+        {
+            Apply(state);
+        }
+
+        if(state == State::Paused || visibility.width <= 0 || visibility.height <= 0)
+        {
+            return;
+        }
+
+        const auto now{std::chrono::steady_clock::now()};
+        if(visibility.width != m_pendingWidth || visibility.height != m_pendingHeight)
+        {
+            m_pendingWidth = visibility.width;
+            m_pendingHeight = visibility.height;
+            m_sizeChanged = now;
+        }
+
+        // The first size goes out right away, later ones once they stopped changing.
+        const bool settled{m_width == 0 || now - m_sizeChanged >= m_settings.resizeDelay};
+        if(settled && (m_pendingWidth != m_width || m_pendingHeight != m_height))
+        {
+            m_width = m_pendingWidth;
+            m_height = m_pendingHeight;
+            if(m_backend != nullptr)
+            {
+                m_backend->Resize(m_width, m_height);
+            }
+        }
+    }
+
+    BrowserThrottle::State BrowserThrottle::GetState() const
+    {
+        return m_state;
+    }
+
+    void BrowserThrottle::Apply(const State state)
+    {
+        m_state = state;
+        m_applied = m_backend != nullptr;
+        if(m_backend == nullptr)
+        {
+            return;
+        }
+
+        switch(state)
+        {
+        case State::Paused:
+            m_backend->SetHidden(true);
+            break;
+        case State::Low:
+            m_backend->SetHidden(false);
+            m_backend->SetFrameRate(m_settings.lowFramesPerSecond);
+            break;
+        case State::Full:
+            m_backend->SetHidden(false);
+            m_backend->SetFrameRate(m_settings.fullFramesPerSecond);
+            break;
+        }
+    }
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <chrono>
+
+namespace App {
+
+    // What the off-screen browser has to offer for throttling, CEF maps this
+    // onto CefBrowserHost::WasHidden, SetWindowlessFrameRate and WasResized.
+    class BrowserBackend
+    {
+    public:
+        BrowserBackend() = default;
+        virtual ~BrowserBackend() = default;
+
+        BrowserBackend(const BrowserBackend&) = delete;
+        BrowserBackend(BrowserBackend&&) = delete;
+        BrowserBackend& operator=(BrowserBackend other) = delete;
+        BrowserBackend& operator=(BrowserBackend&& other) = delete;
+
+        virtual void SetHidden(bool hidden) = 0;
+        virtual void SetFrameRate(int framesPerSecond) = 0;
+        virtual void Resize(int width, int height) = 0;
+    };
+
+    // Where the browser view stands this frame.
+    struct BrowserVisibility
+    {
+        // The browser window is open at all.
+        bool open{false};
+        // Its content is on screen: not collapsed, not a hidden dock tab, app not minimized.
+        bool visible{false};
+        // Input goes to it, otherwise it only needs to stay roughly current.
+        bool focused{false};
+        // Content size in pixels, ignored while not visible.
+        int width{0};
+        int height{0};
+    };
+
+    // Turns per-frame visibility into as few backend calls as possible: a
+    // hidden browser is paused, a visible one without focus runs at a low
+    // frame rate, and resizes are passed on once the size settled.
+    class BrowserThrottle
+    {
+    public:
+        enum class State
+        {
+            Paused,
+            Low,
+            Full
+        };
+
+        struct Settings
+        {
+            int fullFramesPerSecond{60};
+            int lowFramesPerSecond{10};
+            // Dragging a dock splitter changes the size every frame, re-layout once it stops.
+            std::chrono::milliseconds resizeDelay{100};
+        };
+
+        BrowserThrottle();
+        explicit BrowserThrottle(const Settings& settings);
+
+        // The backend may come and go with the browser, nullptr only tracks the state.
+        void SetBackend(BrowserBackend* backend);
+
+        // Call once per frame.
+        void Update(const BrowserVisibility& visibility);
+
+        [[nodiscard]] State GetState() const;
+
+    private:
+        void Apply(State state);
+
+        Settings m_settings;
+        BrowserBackend* m_backend{nullptr};
+        State m_state{State::Paused};
+        bool m_applied{false};
+
+        int m_width{0};
+        int m_height{0};
+        int m_pendingWidth{0};
+        int m_pendingHeight{0};
+        std::chrono::steady_clock::time_point m_sizeChanged{};
+    };
+
+}
@@ -0,0 +1,238 @@
+#include "DataTable.hpp"
+#include <imgui.h>
+#include <algorithm>
+#include <type_traits>
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    DataTable::DataTable(Database& database, const Settings& settings)
+            : m_pager(database, settings.pager), m_labels(settings.labels), m_filterDelay(settings.filterDelay)
+    {
+        const std::vector<std::string>& columns{settings.pager.columns};
+        m_labels.resize(columns.size());
+        for(std::size_t i = 0; i < columns.size(); ++i)
+        {
+            if(m_labels[i].empty())
+            {
+                m_labels[i] = columns[i];
+            }
+        }
+    }
+
+    void DataTable::Render()
+    {
+        APP_PROFILE_FUNCTION();
+
+        ImGui::PushID(this);
+        DrawToolbar();
+        DrawTable();
+        ImGui::PopID();
+    }
+
+    void DataTable::ScrollToRow(const std::int64_t row)
+    {
+        const std::int64_t rowCount{m_pager.GetRowCount()};
+        const std::int64_t target{std::clamp<std::int64_t>(row, 0, std::max<std::int64_t>(rowCount - 1, 0))};
+        m_rowBase = std::clamp<std::int64_t>(target - MaxClippedRows / 2, 0, std::max<std::int64_t>(rowCount - MaxClippedRows, 0));
+        m_scrollTarget = target;
+
+        // A frame earlier than waiting for the clipper to show it.
+        const std::int64_t visibleRows{std::max<std::int64_t>(m_visibleEnd - m_visibleFirst, 1)};
+        m_pager.Request(target, target + visibleRows);
+    }
+
+    bool DataTable::IsVisibleRangeLoaded() const
+    {
+        return m_pager.IsLoaded(m_visibleFirst, m_visibleEnd);
+    }
+
+    bool DataTable::IsBusy() const
+    {
+        return m_filterPending || m_pager.IsBusy();
+    }
+
+    const TablePager& DataTable::GetPager() const
+    {
+        return m_pager;
+    }
+
+    void DataTable::DrawToolbar()
+    {
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 16.0F);
+        if(ImGui::InputTextWithHint("##Filter", "Filter", m_filterInput.data(), m_filterInput.size()))
+        {
+            m_filterEdited = Clock::now();
+            m_filterPending = true;
+        }
+        // Every keystroke would start a scan of its own, only the last one counts.
+        if(m_filterPending && Clock::now() - m_filterEdited >= m_filterDelay)
+        {
+            m_pager.SetFilter(m_filterInput.data());
+            m_filterPending = false;
+            m_rowBase = 0;
+            m_scrollTarget = 0;
+        }
+
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8.0F);
+        if(ImGui::InputScalar("Go to row", ImGuiDataType_S64, &m_goToRow, nullptr, nullptr, nullptr, ImGuiInputTextFlags_EnterReturnsTrue))
+        {
+            ScrollToRow(m_goToRow - 1);
+        }
+
+        ImGui::SameLine();
+        if(!m_pager.GetError().empty())
+        {
+            ImGui::TextDisabled("%s", m_pager.GetError().c_str());
+        }
+        else if(!m_pager.IsRowCountKnown())
+        {
+            ImGui::TextDisabled("Counting rows...");
+        }
+        else
+        {
+            ImGui::Text("%lld rows", static_cast<long long>(m_pager.GetRowCount()));
+        }
+    }
+
+    void DataTable::DrawTable()
+    {
+        constexpr ImGuiTableFlags Flags{ImGuiTableFlags_ScrollY | ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable
+                                       | ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable
+                                       | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersV};
+
+        const auto columnCount{static_cast<int>(m_labels.size())};
+        if(columnCount == 0 || !ImGui::BeginTable("Rows", columnCount, Flags))
+        {
+            return;
+        }
+
+        ImGui::TableSetupScrollFreeze(0, 1);
+        for(int column = 0; column < columnCount; ++column)
+        {
+            ImGui::TableSetupColumn(m_labels[static_cast<std::size_t>(column)].c_str(),
+                                    column == 0 ? ImGuiTableColumnFlags_DefaultSort : ImGuiTableColumnFlags_None);
+        }
+        ImGui::TableHeadersRow();
+
+        if(ImGuiTableSortSpecs* const specs{ImGui::TableGetSortSpecs()}; specs != nullptr && specs->SpecsDirty)
+        {
+            if(specs->SpecsCount > 0)
+            {
+                const ImGuiTableColumnSortSpecs& spec{specs->Specs[0]};
+                m_pager.SetOrder(static_cast<std::size_t>(spec.ColumnIndex), spec.SortDirection == ImGuiSortDirection_Descending);
+            }
+            else
+            {
+                m_pager.SetOrder(TablePager::KeyOrder, false);
+            }
+            specs->SpecsDirty = false;
+            m_rowBase = 0;
+            m_scrollTarget = 0;
+        }
+
+        // Single-line cells, every row is as high as the clipper is told.
+        const float rowHeight{ImGui::GetTextLineHeight() + 2.0F * ImGui::GetStyle().CellPadding.y};
+        const std::int64_t rowCount{m_pager.GetRowCount()};
+        m_rowBase = std::clamp<std::int64_t>(m_rowBase, 0, std::max<std::int64_t>(rowCount - MaxClippedRows, 0));
+        if(m_scrollTarget >= 0)
+        {
+            ImGui::SetScrollY(static_cast<float>(m_scrollTarget - m_rowBase) * rowHeight);
+        }
+
+        std::int64_t first{rowCount};
+        std::int64_t end{0};
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(std::min(rowCount - m_rowBase, MaxClippedRows)), rowHeight);
+        while(clipper.Step())
+        {
+            for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            {
+                DrawRow(m_rowBase + i, rowHeight);
+            }
+            if(clipper.DisplayStart < clipper.DisplayEnd)
+            {
+                first = std::min(first, m_rowBase + clipper.DisplayStart);
+                end = std::max(end, m_rowBase + clipper.DisplayEnd);
+            }
+        }
+        clipper.End();
+
+        if(m_scrollTarget >= 0)
+        {
+            // The scroll lands next frame, the clipper still saw the old one.
+            first = m_scrollTarget;
+            end = m_scrollTarget + std::max<std::int64_t>(m_visibleEnd - m_visibleFirst, 1);
+            m_scrollTarget = -1;
+        }
+        else if(rowCount > MaxClippedRows && first < end && !ImGui::IsAnyItemActive())
+        {
+            // Moves the span along once a quarter of it is left on either side,
+            // not while the scrollbar is dragged as the drag sets the scroll again.
+            const std::int64_t margin{MaxClippedRows / 4};
+            if((first - m_rowBase < margin && m_rowBase > 0)
+               || (m_rowBase + MaxClippedRows - end < margin && m_rowBase + MaxClippedRows < rowCount))
+            {
+                const std::int64_t base{std::clamp<std::int64_t>(first - MaxClippedRows / 2, 0, rowCount - MaxClippedRows)};
+                ImGui::SetScrollY(ImGui::GetScrollY() + static_cast<float>(m_rowBase - base) * rowHeight);
+                m_rowBase = base;
+            }
+        }
+        ImGui::EndTable();
+
+        m_visibleFirst = first;
+        m_visibleEnd = std::max(first, end);
+        m_pager.Request(m_visibleFirst, m_visibleEnd);
+    }
+
+    void DataTable::DrawRow(const std::int64_t index, const float rowHeight) const
+    {
+        ImGui::TableNextRow(ImGuiTableRowFlags_None, rowHeight);
+        const Database::Row* const row{m_pager.GetRow(index)};
+        for(std::size_t column = 0; column < m_labels.size(); ++column)
+        {
+            if(!ImGui::TableSetColumnIndex(static_cast<int>(column)))
+            {
+                continue;
+            }
+            if(row == nullptr || column >= row->size())
+            {
+                ImGui::TextDisabled("...");
+                continue;
+            }
+            DrawValue((*row)[column]);
+        }
+    }
+
+    void DataTable::DrawValue(const Database::Value& value)
+    {
+        // Formatted straight into ImGui's buffer, no string per cell.
+        std::visit(
+                [](const auto& v) {
+                    using T = std::decay_t<decltype(v)>;
+                    if constexpr(std::is_same_v<T, std::nullptr_t>)
+                    {
+                        ImGui::TextDisabled("NULL");
+                    }
+                    else if constexpr(std::is_same_v<T, std::int64_t>)
+                    {
+                        ImGui::Text("%lld", static_cast<long long>(v));
+                    }
+                    else if constexpr(std::is_same_v<T, double>)
+                    {
+                        ImGui::Text("%.2f", v);
+                    }
+                    else if constexpr(std::is_same_v<T, std::string>)
+                    {
+                        ImGui::TextUnformatted(v.data(), v.data() + v.size());
+                    }
+                    else
+                    {
+                        ImGui::TextDisabled("%zu bytes", v.size());
+                    }
+                },
+                value);
+    }
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Core/Database.hpp"
+#include "Core/TablePager.hpp"
+
+namespace App {
+
+    // ImGui table over a TablePager: a filter box, a go-to-row box and a
+    // sortable, scrolling table that only lays out the rows in view through
+    // ImGuiListClipper. Rows still loading show as placeholders, so a frame
+    // costs the same for a thousand rows as for ten million. ImGui keeps
+    // positions in floats, which lose whole pixels far beyond a million rows,
+    // so the clipper spans at most MaxClippedRows around the visible ones and
+    // the span moves along as it is scrolled towards its ends.
+    class DataTable
+    {
+    public:
+        static constexpr std::int64_t MaxClippedRows{100000};
+
+        struct Settings
+        {
+            TablePager::Settings pager{};
+            // Header per column, the column name where missing or empty.
+            std::vector<std::string> labels{};
+            // Typing pause before the filter goes to SQL.
+            std::chrono::milliseconds filterDelay{250};
+        };
+
+        DataTable(Database& database, const Settings& settings);
+
+        DataTable(const DataTable&) = delete;
+        DataTable(DataTable&&) = delete;
+        DataTable& operator=(DataTable other) = delete;
+        DataTable& operator=(DataTable&& other) = delete;
+
+        // Fills the rest of the current window, call between Begin() and End().
+        void Render();
+
+        // Scrolls the row to the top on the next Render() and starts loading it right away.
+        void ScrollToRow(std::int64_t row);
+        // The rows shown by the last Render() all arrived.
+        [[nodiscard]] bool IsVisibleRangeLoaded() const;
+        // Waiting for rows or for the filter delay, keep rendering frames.
+        [[nodiscard]] bool IsBusy() const;
+        [[nodiscard]] const TablePager& GetPager() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void DrawToolbar();
+        void DrawTable();
+        void DrawRow(std::int64_t index, float rowHeight) const;
+        static void DrawValue(const Database::Value& value);
+
+        TablePager m_pager;
+        std::vector<std::string> m_labels{};
+        std::chrono::milliseconds m_filterDelay{};
+
+        std::array<char, 256> m_filterInput{};
+        Clock::time_point m_filterEdited{};
+        bool m_filterPending{false};
+        std::int64_t m_goToRow{1};
+
+        // First row of the clipped span.
+        std::int64_t m_rowBase{0};
+        // Row to scroll to on the next Render(), negative for none.
+        std::int64_t m_scrollTarget{-1};
+        std::int64_t m_visibleFirst{0};
+        std::int64_t m_visibleEnd{0};
+    };
+
+}
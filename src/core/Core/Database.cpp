@@ -0,0 +1,476 @@
+#include "Database.hpp"
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "Core/Instrumentor.hpp"
+#include "Core/Log.hpp"
+
+namespace App {
+
+    namespace {
+        void Bind(sqlite3_stmt* statement, const int index, const Database::Value& value)
+        {
+            std::visit(
+                    [statement, index](const auto& v) {
+                        using T = std::decay_t<decltype(v)>;
+                        if constexpr(std::is_same_v<T, std::nullptr_t>)
+                        {
+                            sqlite3_bind_null(statement, index);
+                        }
+                        else if constexpr(std::is_same_v<T, std::int64_t>)
+                        {
+                            sqlite3_bind_int64(statement, index, v);
+                        }
+                        else if constexpr(std::is_same_v<T, double>)
+                        {
+                            sqlite3_bind_double(statement, index, v);
+                        }
+                        else if constexpr(std::is_same_v<T, std::string>)
+                        {
+                            sqlite3_bind_text64(statement, index, v.data(), v.size(), SQLITE_STATIC, SQLITE_UTF8);
+                        }
+                        else
+                        {
+                            sqlite3_bind_blob64(statement, index, v.data(), v.size(), SQLITE_STATIC);
+                        }
+                    },
+                    value);
+        }
+
+        Database::Value ReadColumn(sqlite3_stmt* statement, const int column)
+        {
+            switch(sqlite3_column_type(statement, column))
+            {
+            case SQLITE_INTEGER:
+                return static_cast<std::int64_t>(sqlite3_column_int64(statement, column));
+            case SQLITE_FLOAT:
+                return sqlite3_column_double(statement, column);
+            case SQLITE_TEXT:
+            {
+                const auto* text{reinterpret_cast<const char*>(sqlite3_column_text(statement, column))};
+                return std::string(text, static_cast<std::size_t>(sqlite3_column_bytes(statement, column)));
+            }
+            case SQLITE_BLOB:
+            {
+                const auto* data{static_cast<const std::uint8_t*>(sqlite3_column_blob(statement, column))};
+                return Database::Blob(data, data + sqlite3_column_bytes(statement, column));
+            }
+            default:
+                return nullptr;
+            }
+        }
+    }
+
+    Database::StatementCache::StatementCache(const std::size_t capacity) : m_capacity(capacity)
+    {
+    }
+
+    Database::StatementCache::~StatementCache()
+    {
+        Clear();
+    }
+
+    sqlite3_stmt* Database::StatementCache::Acquire(sqlite3* connection, const std::string& sql)
+    {
+        if(const auto it{m_index.find(sql)}; it != m_index.end())
+        {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            sqlite3_stmt* statement{it->second->second};
+            sqlite3_reset(statement);
+            sqlite3_clear_bindings(statement);
+            return statement;
+        }
+
+        sqlite3_stmt* statement{nullptr};
+        if(sqlite3_prepare_v3(connection,
+                              sql.c_str(),
+                              static_cast<int>(sql.size()) + 1,
+                              SQLITE_PREPARE_PERSISTENT,
+                              &statement,
+                              nullptr) != SQLITE_OK)
+        {
+            return nullptr;
+        }
+
+        if(m_entries.size() >= m_capacity && !m_entries.empty())
+        {
+            sqlite3_finalize(m_entries.back().second);
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+        m_entries.emplace_front(sql, statement);
+        m_index.emplace(sql, m_entries.begin());
+        return statement;
+    }
+
+    void Database::StatementCache::Clear()
+    {
+        for(const Entry& entry: m_entries)
+        {
+            sqlite3_finalize(entry.second);
+        }
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    Database::Database() : Database(Settings{})
+    {
+    }
+
+    Database::Database(const Settings& settings) : m_settings(settings)
+    {
+        APP_PROFILE_FUNCTION();
+
+        // The writer creates the file and switches it to WAL before any reader opens it.
+        if(!OpenConnection(m_writeConnection, false))
+        {
+            return;
+        }
+        sqlite3_exec(m_writeConnection.handle, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+        // Durable at checkpoints, a power loss may only drop the last transactions.
+        sqlite3_exec(m_writeConnection.handle, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+
+        m_readConnections.resize(m_settings.readConnections);
+        for(Connection& connection: m_readConnections)
+        {
+            if(!OpenConnection(connection, true))
+            {
+                for(Connection& opened: m_readConnections)
+                {
+                    CloseConnection(opened);
+                }
+                CloseConnection(m_writeConnection);
+                return;
+            }
+        }
+
+        m_open = true;
+        m_writer = std::thread{&Database::WriterLoop, this};
+        for(Connection& connection: m_readConnections)
+        {
+            m_readers.emplace_back(&Database::ReaderLoop, this, std::ref(connection));
+        }
+    }
+
+    Database::~Database()
+    {
+        APP_PROFILE_FUNCTION();
+
+        {
+            const std::lock_guard<std::mutex> writeLock{m_writeMutex};
+            const std::lock_guard<std::mutex> readLock{m_readMutex};
+            m_stopRequested = true;
+        }
+        m_writeWakeUp.notify_all();
+        m_readWakeUp.notify_all();
+
+        // The writer commits what is still queued, pending reads are dropped.
+        if(m_writer.joinable())
+        {
+            m_writer.join();
+        }
+        for(std::thread& reader: m_readers)
+        {
+            reader.join();
+        }
+
+        for(Connection& connection: m_readConnections)
+        {
+            CloseConnection(connection);
+        }
+        CloseConnection(m_writeConnection);
+    }
+
+    bool Database::IsOpen() const
+    {
+        return m_open;
+    }
+
+    void Database::Execute(std::string sql, std::vector<Value> params, Callback callback)
+    {
+        if(!m_open)
+        {
+            FailClosed(std::move(callback));
+            return;
+        }
+        {
+            const std::lock_guard<std::mutex> lock{m_writeMutex};
+            m_writes.push_back({std::move(sql), std::move(params), std::move(callback)});
+        }
+        m_writeWakeUp.notify_one();
+    }
+
+    void Database::Query(std::string sql, std::vector<Value> params, Callback callback)
+    {
+        if(!m_open)
+        {
+            FailClosed(std::move(callback));
+            return;
+        }
+        {
+            const std::lock_guard<std::mutex> lock{m_readMutex};
+            m_reads.push_back({std::move(sql), std::move(params), std::move(callback)});
+        }
+        m_readWakeUp.notify_one();
+    }
+
+    void Database::Flush()
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::unique_lock<std::mutex> lock{m_writeMutex};
+        m_writeDrained.wait(lock, [this] { return !m_open || (m_writes.empty() && m_writesInFlight == 0); });
+    }
+
+    void Database::DispatchCompleted()
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::vector<Completed> completed;
+        {
+            const std::lock_guard<std::mutex> lock{m_completedMutex};
+            if(m_completed.empty())
+            {
+                return;
+            }
+            completed.swap(m_completed);
+        }
+
+        for(const Completed& entry: completed)
+        {
+            if(entry.callback)
+            {
+                entry.callback(entry.result);
+            }
+        }
+    }
+
+    void Database::SetCompletionNotifier(std::function<void()> notifier)
+    {
+        const std::lock_guard<std::mutex> lock{m_completedMutex};
+        m_completionNotifier = std::move(notifier);
+    }
+
+    bool Database::OpenConnection(Connection& connection, const bool readOnly) const
+    {
+        const int flags{(readOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)
+                        | SQLITE_OPEN_NOMUTEX};
+        if(sqlite3_open_v2(m_settings.path.c_str(), &connection.handle, flags, nullptr) != SQLITE_OK)
+        {
+            APP_ERROR("Can't open database {}: {}", m_settings.path, sqlite3_errmsg(connection.handle));
+            sqlite3_close(connection.handle);
+            connection.handle = nullptr;
+            return false;
+        }
+
+        sqlite3_busy_timeout(connection.handle, static_cast<int>(m_settings.busyTimeout.count()));
+        connection.statements = std::make_unique<StatementCache>(m_settings.statementCacheSize);
+        return true;
+    }
+
+    void Database::CloseConnection(Connection& connection)
+    {
+        if(connection.statements != nullptr)
+        {
+            connection.statements->Clear();
+        }
+        sqlite3_close(connection.handle);
+        connection.handle = nullptr;
+    }
+
+    void Database::WriterLoop()
+    {
+        std::vector<Task> batch;
+        std::vector<Completed> completed;
+
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock{m_writeMutex};
+                m_writesInFlight = 0;
+                m_writeDrained.notify_all();
+                m_writeWakeUp.wait(lock, [this] { return m_stopRequested || !m_writes.empty(); });
+                if(m_writes.empty())
+                {
+                    break;
+                }
+
+                // Everything queued while the previous transaction ran goes into this one.
+                const std::size_t count{std::min(m_writes.size(), m_settings.maxBatchSize)};
+                for(std::size_t i = 0; i < count; ++i)
+                {
+                    batch.push_back(std::move(m_writes.front()));
+                    m_writes.pop_front();
+                }
+                m_writesInFlight = count;
+            }
+
+            {
+                APP_PROFILE_SCOPE("Database::WriteBatch");
+
+                // Busy already waited out busyTimeout. Without a transaction every
+                // statement would commit on its own and COMMIT fail after them.
+                if(sqlite3_exec(m_writeConnection.handle, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK)
+                {
+                    const std::string error{sqlite3_errmsg(m_writeConnection.handle)};
+                    APP_ERROR("Database transaction could not begin, dropping {} writes: {}", batch.size(), error);
+                    for(Task& task: batch)
+                    {
+                        if(task.callback)
+                        {
+                            Result result{};
+                            result.error = error;
+                            completed.push_back({std::move(task.callback), std::move(result)});
+                        }
+                    }
+                    batch.clear();
+                    Complete(completed);
+                    continue;
+                }
+                for(Task& task: batch)
+                {
+                    Result result{Run(m_writeConnection, task, false)};
+                    if(!result.Succeeded())
+                    {
+                        APP_ERROR("Database write failed: {} ({})", result.error, task.sql);
+                    }
+                    if(task.callback)
+                    {
+                        completed.push_back({std::move(task.callback), std::move(result)});
+                    }
+                }
+                if(sqlite3_exec(m_writeConnection.handle, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK)
+                {
+                    const std::string error{sqlite3_errmsg(m_writeConnection.handle)};
+                    APP_ERROR("Database commit failed: {}", error);
+                    sqlite3_exec(m_writeConnection.handle, "ROLLBACK;", nullptr, nullptr, nullptr);
+                    for(Completed& entry: completed)
+                    {
+                        entry.result.error = error;
+                    }
+                }
+            }
+
+            batch.clear();
+            Complete(completed);
+        }
+
+        m_writeDrained.notify_all();
+    }
+
+    void Database::ReaderLoop(Connection& connection)
+    {
+        std::vector<Completed> completed;
+
+        while(true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock{m_readMutex};
+                m_readWakeUp.wait(lock, [this] { return m_stopRequested || !m_reads.empty(); });
+                if(m_stopRequested)
+                {
+                    break;
+                }
+                task = std::move(m_reads.front());
+                m_reads.pop_front();
+            }
+
+            APP_PROFILE_SCOPE("Database::Query");
+            Result result{Run(connection, task, true)};
+            if(task.callback)
+            {
+                completed.push_back({std::move(task.callback), std::move(result)});
+                Complete(completed);
+            }
+        }
+    }
+
+    Database::Result Database::Run(Connection& connection, const Task& task, const bool collectRows)
+    {
+        Result result{};
+
+        sqlite3_stmt* statement{connection.statements->Acquire(connection.handle, task.sql)};
+        if(statement == nullptr)
+        {
+            result.error = sqlite3_errmsg(connection.handle);
+            return result;
+        }
+
+        for(std::size_t i = 0; i < task.params.size(); ++i)
+        {
+            Bind(statement, static_cast<int>(i) + 1, task.params[i]);
+        }
+
+        const int columnCount{sqlite3_column_count(statement)};
+        if(collectRows)
+        {
+            result.columns.reserve(static_cast<std::size_t>(columnCount));
+            for(int column = 0; column < columnCount; ++column)
+            {
+                result.columns.emplace_back(sqlite3_column_name(statement, column));
+            }
+        }
+
+        int status{SQLITE_OK};
+        while((status = sqlite3_step(statement)) == SQLITE_ROW)
+        {
+            if(!collectRows)
+            {
+                continue;
+            }
+            Row& row{result.rows.emplace_back()};
+            row.reserve(static_cast<std::size_t>(columnCount));
+            for(int column = 0; column < columnCount; ++column)
+            {
+                row.push_back(ReadColumn(statement, column));
+            }
+        }
+
+        if(status != SQLITE_DONE)
+        {
+            result.error = sqlite3_errmsg(connection.handle);
+        }
+        result.changes = sqlite3_changes64(connection.handle);
+        result.lastInsertRowId = sqlite3_last_insert_rowid(connection.handle);
+
+        // Releases the read snapshot, bound parameters must not outlive the task.
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        return result;
+    }
+
+    void Database::Complete(std::vector<Completed>& completed)
+    {
+        if(completed.empty())
+        {
+            return;
+        }
+
+        // Called under the lock, SetCompletionNotifier() may replace it from another thread.
+        const std::lock_guard<std::mutex> lock{m_completedMutex};
+        for(Completed& entry: completed)
+        {
+            m_completed.push_back(std::move(entry));
+        }
+        completed.clear();
+        if(m_completionNotifier)
+        {
+            m_completionNotifier();
+        }
+    }
+
+    void Database::FailClosed(Callback callback)
+    {
+        if(!callback)
+        {
+            return;
+        }
+        Result result{};
+        result.error = "Database " + m_settings.path + " is not open";
+        std::vector<Completed> completed;
+        completed.push_back({std::move(callback), std::move(result)});
+        Complete(completed);
+    }
+
+}
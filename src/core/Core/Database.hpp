@@ -0,0 +1,163 @@
+#pragma once
+#include <sqlite3.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace App {
+
+    // Owns the SQLite database in WAL mode. Writes go to one writer thread that
+    // commits everything queued so far as a single transaction, reads are served
+    // by a small pool of read-only connections. Like HttpClient, callbacks are
+    // queued until the owner calls DispatchCompleted() in the frame loop.
+    class Database
+    {
+    public:
+        struct Settings
+        {
+            std::string path{"app.db"};
+            std::size_t readConnections{2};
+            // Upper bound of statements committed in one transaction.
+            std::size_t maxBatchSize{1024};
+            // Prepared statements kept per connection, least recently used go first.
+            std::size_t statementCacheSize{64};
+            std::chrono::milliseconds busyTimeout{5000};
+        };
+
+        using Blob = std::vector<std::uint8_t>;
+        using Value = std::variant<std::nullptr_t, std::int64_t, double, std::string, Blob>;
+        using Row = std::vector<Value>;
+
+        struct Result
+        {
+            std::vector<std::string> columns;
+            std::vector<Row> rows;
+            std::string error;
+            std::int64_t changes{0};
+            std::int64_t lastInsertRowId{0};
+
+            [[nodiscard]] bool Succeeded() const
+            {
+                return error.empty();
+            }
+        };
+
+        using Callback = std::function<void(const Result& result)>;
+
+        Database();
+        explicit Database(const Settings& settings);
+        ~Database();
+
+        Database(const Database&) = delete;
+        Database(Database&&) = delete;
+        Database& operator=(Database other) = delete;
+        Database& operator=(Database&& other) = delete;
+
+        [[nodiscard]] bool IsOpen() const;
+
+        // Thread-safe. Runs on the writer connection, batched with other writes.
+        // When the database did not open, the callback gets an error result.
+        void Execute(std::string sql, std::vector<Value> params = {}, Callback callback = {});
+        // Thread-safe. Runs on one of the read connections, same error when not open.
+        void Query(std::string sql, std::vector<Value> params, Callback callback);
+
+        // Blocks until every write queued so far is committed.
+        void Flush();
+
+        // Runs the callbacks of finished statements on the calling thread.
+        void DispatchCompleted();
+
+        // Called on a worker thread whenever a result gets queued. It runs under
+        // the database's lock and must not call back into the database.
+        void SetCompletionNotifier(std::function<void()> notifier);
+
+    private:
+        struct Task
+        {
+            std::string sql;
+            std::vector<Value> params;
+            Callback callback;
+        };
+
+        struct Completed
+        {
+            Callback callback;
+            Result result;
+        };
+
+        // Prepared statements of one connection keyed by their SQL text.
+        class StatementCache
+        {
+        public:
+            explicit StatementCache(std::size_t capacity);
+            ~StatementCache();
+
+            StatementCache(const StatementCache&) = delete;
+            StatementCache(StatementCache&&) = delete;
+            StatementCache& operator=(StatementCache other) = delete;
+            StatementCache& operator=(StatementCache&& other) = delete;
+
+            // Returns a reset statement or nullptr, the error is left on the connection.
+            sqlite3_stmt* Acquire(sqlite3* connection, const std::string& sql);
+            void Clear();
+
+        private:
+            using Entry = std::pair<std::string, sqlite3_stmt*>;
+
+            std::size_t m_capacity;
+            std::list<Entry> m_entries;
+            std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+        };
+
+        struct Connection
+        {
+            sqlite3* handle{nullptr};
+            std::unique_ptr<StatementCache> statements;
+        };
+
+        bool OpenConnection(Connection& connection, bool readOnly) const;
+        static void CloseConnection(Connection& connection);
+
+        void WriterLoop();
+        void ReaderLoop(Connection& connection);
+        static Result Run(Connection& connection, const Task& task, bool collectRows);
+        void Complete(std::vector<Completed>& completed);
+        // Queues the error result of a statement that cannot run.
+        void FailClosed(Callback callback);
+
+        Settings m_settings;
+        bool m_open{false};
+
+        Connection m_writeConnection{};
+        std::vector<Connection> m_readConnections;
+        std::thread m_writer;
+        std::vector<std::thread> m_readers;
+
+        std::mutex m_writeMutex;
+        std::condition_variable m_writeWakeUp;
+        std::condition_variable m_writeDrained;
+        std::deque<Task> m_writes;
+        std::size_t m_writesInFlight{0};
+
+        std::mutex m_readMutex;
+        std::condition_variable m_readWakeUp;
+        std::deque<Task> m_reads;
+
+        bool m_stopRequested{false};
+
+        std::mutex m_completedMutex;
+        std::vector<Completed> m_completed;
+        std::function<void()> m_completionNotifier;
+    };
+
+}
@@ -0,0 +1,458 @@
+#include "FontAtlasCache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <type_traits>
+#include "Core/Instrumentor.hpp"
+#include "Core/Log.hpp"
+
+namespace App {
+
+    namespace {
+        constexpr std::uint32_t CacheMagic{0x4C544146}; // "FATL"
+        constexpr std::uint32_t CacheFormatVersion{1};
+        constexpr std::uint32_t TexLinesCount{IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1};
+
+        class Fnv1a
+        {
+        public:
+            void Add(const void* data, const std::size_t size)
+            {
+                const auto* bytes{static_cast<const unsigned char*>(data)};
+                for(std::size_t i = 0; i < size; ++i)
+                {
+                    m_hash = (m_hash ^ bytes[i]) * 0x100000001B3ULL;
+                }
+            }
+
+            template<typename T>
+            void Add(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                Add(&value, sizeof(T));
+            }
+
+            [[nodiscard]] std::uint64_t Get() const
+            {
+                return m_hash;
+            }
+
+        private:
+            std::uint64_t m_hash{0xCBF29CE484222325ULL};
+        };
+
+        class Writer
+        {
+        public:
+            template<typename T>
+            void Write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                WriteBytes(&value, sizeof(T));
+            }
+
+            void WriteBytes(const void* data, const std::size_t size)
+            {
+                const auto* bytes{static_cast<const char*>(data)};
+                m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+            }
+
+            [[nodiscard]] const std::vector<char>& GetBuffer() const
+            {
+                return m_buffer;
+            }
+
+        private:
+            std::vector<char> m_buffer{};
+        };
+
+        // Bounds checked, a short or corrupt file only fails the load.
+        class Reader
+        {
+        public:
+            explicit Reader(const std::vector<char>& buffer) : m_buffer(buffer) {}
+
+            template<typename T>
+            bool Read(T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                return ReadBytes(&value, sizeof(T));
+            }
+
+            bool ReadBytes(void* data, const std::size_t size)
+            {
+                if(m_buffer.size() - m_position < size)
+                {
+                    return false;
+                }
+                std::memcpy(data, m_buffer.data() + m_position, size);
+                m_position += size;
+                return true;
+            }
+
+            [[nodiscard]] std::size_t GetRemaining() const
+            {
+                return m_buffer.size() - m_position;
+            }
+
+        private:
+            const std::vector<char>& m_buffer;
+            std::size_t m_position{0};
+        };
+
+        struct CachedGlyph
+        {
+            std::uint32_t codepoint;
+            float advanceX;
+            float x0, y0, x1, y1;
+            float u0, v0, u1, v1;
+        };
+
+        struct CachedRect
+        {
+            std::uint16_t width, height;
+            std::uint16_t x, y;
+            std::uint32_t glyphId;
+            float glyphAdvanceX;
+            ImVec2 glyphOffset;
+        };
+
+        struct CachedFont
+        {
+            float fontSize{0.0F};
+            float ascent{0.0F};
+            float descent{0.0F};
+            std::vector<CachedGlyph> glyphs{};
+        };
+
+        struct CachedAtlas
+        {
+            std::int32_t texWidth{0};
+            std::int32_t texHeight{0};
+            ImVec2 texUvScale{};
+            ImVec2 texUvWhitePixel{};
+            ImVec4 texUvLines[TexLinesCount]{};
+            std::int32_t packIdMouseCursors{-1};
+            std::int32_t packIdLines{-1};
+            std::vector<CachedRect> rects{};
+            std::vector<CachedFont> fonts{};
+            std::vector<unsigned char> pixels{};
+        };
+
+        bool ReadFile(const std::filesystem::path& path, std::vector<char>& content)
+        {
+            std::error_code error{};
+            const auto size{std::filesystem::file_size(path, error)};
+            std::ifstream file{path, std::ios::binary};
+            if(error || !file)
+            {
+                return false;
+            }
+            content.resize(static_cast<std::size_t>(size));
+            file.read(content.data(), static_cast<std::streamsize>(content.size()));
+            return static_cast<std::size_t>(file.gcount()) == content.size();
+        }
+
+        template<typename T>
+        bool ReadCount(Reader& reader, T& count, const std::size_t elementSize)
+        {
+            // A count larger than the rest of the file is corruption, not an allocation.
+            return reader.Read(count) && static_cast<std::size_t>(count) <= reader.GetRemaining() / elementSize;
+        }
+
+        bool Parse(const std::vector<char>& content, const std::uint64_t key, CachedAtlas& atlas)
+        {
+            Reader reader{content};
+
+            std::uint32_t magic{0};
+            std::uint32_t version{0};
+            std::uint64_t fileKey{0};
+            if(!reader.Read(magic) || !reader.Read(version) || !reader.Read(fileKey)
+               || magic != CacheMagic || version != CacheFormatVersion || fileKey != key)
+            {
+                return false;
+            }
+
+            std::uint32_t linesCount{0};
+            if(!reader.Read(atlas.texWidth) || !reader.Read(atlas.texHeight)
+               || !reader.Read(atlas.texUvScale) || !reader.Read(atlas.texUvWhitePixel)
+               || !reader.Read(linesCount) || linesCount != TexLinesCount
+               || !reader.ReadBytes(atlas.texUvLines, sizeof(atlas.texUvLines))
+               || !reader.Read(atlas.packIdMouseCursors) || !reader.Read(atlas.packIdLines))
+            {
+                return false;
+            }
+
+            std::uint32_t rectCount{0};
+            if(!ReadCount(reader, rectCount, sizeof(CachedRect)))
+            {
+                return false;
+            }
+            atlas.rects.resize(rectCount);
+            if(!reader.ReadBytes(atlas.rects.data(), rectCount * sizeof(CachedRect)))
+            {
+                return false;
+            }
+
+            std::uint32_t fontCount{0};
+            if(!ReadCount(reader, fontCount, 3 * sizeof(float) + sizeof(std::uint32_t)))
+            {
+                return false;
+            }
+            atlas.fonts.resize(fontCount);
+            for(CachedFont& font: atlas.fonts)
+            {
+                std::uint32_t glyphCount{0};
+                if(!reader.Read(font.fontSize) || !reader.Read(font.ascent) || !reader.Read(font.descent)
+                   || !ReadCount(reader, glyphCount, sizeof(CachedGlyph)))
+                {
+                    return false;
+                }
+                font.glyphs.resize(glyphCount);
+                if(!reader.ReadBytes(font.glyphs.data(), glyphCount * sizeof(CachedGlyph)))
+                {
+                    return false;
+                }
+            }
+
+            if(atlas.texWidth <= 0 || atlas.texHeight <= 0
+               || reader.GetRemaining() != static_cast<std::size_t>(atlas.texWidth) * static_cast<std::size_t>(atlas.texHeight))
+            {
+                return false;
+            }
+            atlas.pixels.resize(reader.GetRemaining());
+            return reader.ReadBytes(atlas.pixels.data(), atlas.pixels.size());
+        }
+
+        // Puts the atlas into the state ImFontAtlas::Build leaves it in, minus
+        // the input font data which is not needed after building.
+        void Apply(const CachedAtlas& cached, ImFontAtlas& atlas)
+        {
+            atlas.TexWidth = cached.texWidth;
+            atlas.TexHeight = cached.texHeight;
+            atlas.TexUvScale = cached.texUvScale;
+            atlas.TexUvWhitePixel = cached.texUvWhitePixel;
+            std::memcpy(atlas.TexUvLines, cached.texUvLines, sizeof(cached.texUvLines));
+            atlas.PackIdMouseCursors = cached.packIdMouseCursors;
+            atlas.PackIdLines = cached.packIdLines;
+
+            for(const CachedRect& cachedRect: cached.rects)
+            {
+                ImFontAtlasCustomRect rect{};
+                rect.Width = cachedRect.width;
+                rect.Height = cachedRect.height;
+                rect.X = cachedRect.x;
+                rect.Y = cachedRect.y;
+                rect.GlyphID = cachedRect.glyphId;
+                rect.GlyphAdvanceX = cachedRect.glyphAdvanceX;
+                rect.GlyphOffset = cachedRect.glyphOffset;
+                atlas.CustomRects.push_back(rect);
+            }
+
+            for(const CachedFont& cachedFont: cached.fonts)
+            {
+                ImFont* font{IM_NEW(ImFont)};
+                font->ContainerAtlas = &atlas;
+                font->FontSize = cachedFont.fontSize;
+                font->Ascent = cachedFont.ascent;
+                font->Descent = cachedFont.descent;
+                font->Glyphs.reserve(static_cast<int>(cachedFont.glyphs.size()));
+                for(const CachedGlyph& glyph: cachedFont.glyphs)
+                {
+                    // The advance was final when saved, no config adjusts it again.
+                    font->AddGlyph(nullptr, static_cast<ImWchar>(glyph.codepoint),
+                                   glyph.x0, glyph.y0, glyph.x1, glyph.y1,
+                                   glyph.u0, glyph.v0, glyph.u1, glyph.v1,
+                                   glyph.advanceX);
+                }
+                font->BuildLookupTable();
+                atlas.Fonts.push_back(font);
+            }
+
+            // ImFontAtlas frees its pixels with IM_FREE.
+            atlas.TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(cached.pixels.size()));
+            std::memcpy(atlas.TexPixelsAlpha8, cached.pixels.data(), cached.pixels.size());
+            atlas.TexPixelsUseColors = false;
+            atlas.TexReady = true;
+        }
+
+        void HashRanges(Fnv1a& hash, const ImWchar* ranges)
+        {
+            if(ranges == nullptr)
+            {
+                hash.Add(std::uint32_t{0});
+                return;
+            }
+            for(; *ranges != 0; ++ranges)
+            {
+                hash.Add(*ranges);
+            }
+            hash.Add(std::uint32_t{0});
+        }
+    }
+
+    FontAtlasCache::FontAtlasCache(std::filesystem::path file) : m_file(std::move(file)) {}
+
+    std::vector<ImFont*> FontAtlasCache::Build(ImFontAtlas& atlas, const std::vector<FontSource>& sources)
+    {
+        APP_PROFILE_FUNCTION();
+
+        m_loadedFromCache = false;
+
+        Fnv1a hash{};
+        hash.Add(CacheFormatVersion);
+        hash.Add(std::int32_t{IMGUI_VERSION_NUM});
+        hash.Add(static_cast<std::uint32_t>(sizeof(ImWchar)));
+        hash.Add(atlas.Flags);
+        hash.Add(atlas.TexDesiredWidth);
+        hash.Add(atlas.TexGlyphPadding);
+
+        std::vector<std::vector<char>> fontData(sources.size());
+        for(std::size_t i = 0; i < sources.size(); ++i)
+        {
+            const FontSource& source{sources[i]};
+            if(!ReadFile(source.file, fontData[i]) || fontData[i].empty())
+            {
+                APP_ERROR("Could not read font {}", source.file.string());
+                return {};
+            }
+            hash.Add(fontData[i].data(), fontData[i].size());
+            hash.Add(source.sizePixels);
+            hash.Add(source.mergeMode);
+            HashRanges(hash, source.glyphRanges);
+        }
+        const std::uint64_t key{hash.Get()};
+
+        if(Load(atlas, key))
+        {
+            m_loadedFromCache = true;
+            return {atlas.Fonts.begin(), atlas.Fonts.end()};
+        }
+
+        {
+            APP_PROFILE_SCOPE("Rasterize fonts");
+
+            for(std::size_t i = 0; i < sources.size(); ++i)
+            {
+                const FontSource& source{sources[i]};
+
+                ImFontConfig config{};
+                config.MergeMode = source.mergeMode;
+                std::snprintf(config.Name, sizeof(config.Name), "%s, %.0fpx",
+                              source.file.filename().string().c_str(), static_cast<double>(source.sizePixels));
+
+                // The atlas takes over the copy and frees it with IM_FREE.
+                void* data{IM_ALLOC(fontData[i].size())};
+                std::memcpy(data, fontData[i].data(), fontData[i].size());
+                atlas.AddFontFromMemoryTTF(data, static_cast<int>(fontData[i].size()), source.sizePixels, &config, source.glyphRanges);
+            }
+
+            atlas.Build();
+        }
+
+        Save(atlas, key);
+        return {atlas.Fonts.begin(), atlas.Fonts.end()};
+    }
+
+    bool FontAtlasCache::WasLoadedFromCache() const
+    {
+        return m_loadedFromCache;
+    }
+
+    bool FontAtlasCache::Load(ImFontAtlas& atlas, const std::uint64_t key) const
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::vector<char> content{};
+        CachedAtlas cached{};
+        if(!ReadFile(m_file, content) || !Parse(content, key, cached))
+        {
+            return false;
+        }
+
+        Apply(cached, atlas);
+        return true;
+    }
+
+    void FontAtlasCache::Save(const ImFontAtlas& atlas, const std::uint64_t key) const
+    {
+        APP_PROFILE_FUNCTION();
+
+        if(atlas.TexPixelsAlpha8 == nullptr || atlas.TexPixelsUseColors)
+        {
+            return;
+        }
+
+        Writer writer{};
+        writer.Write(CacheMagic);
+        writer.Write(CacheFormatVersion);
+        writer.Write(key);
+
+        writer.Write(static_cast<std::int32_t>(atlas.TexWidth));
+        writer.Write(static_cast<std::int32_t>(atlas.TexHeight));
+        writer.Write(atlas.TexUvScale);
+        writer.Write(atlas.TexUvWhitePixel);
+        writer.Write(TexLinesCount);
+        writer.WriteBytes(atlas.TexUvLines, sizeof(atlas.TexUvLines));
+        writer.Write(static_cast<std::int32_t>(atlas.PackIdMouseCursors));
+        writer.Write(static_cast<std::int32_t>(atlas.PackIdLines));
+
+        writer.Write(static_cast<std::uint32_t>(atlas.CustomRects.Size));
+        for(const ImFontAtlasCustomRect& rect: atlas.CustomRects)
+        {
+            // Glyph rects point at a font, only the atlas' own cursor and line rects are kept.
+            if(rect.Font != nullptr)
+            {
+                return;
+            }
+            writer.Write(CachedRect{rect.Width, rect.Height, rect.X, rect.Y,
+                                    rect.GlyphID, rect.GlyphAdvanceX, rect.GlyphOffset});
+        }
+
+        writer.Write(static_cast<std::uint32_t>(atlas.Fonts.Size));
+        for(const ImFont* font: atlas.Fonts)
+        {
+            writer.Write(font->FontSize);
+            writer.Write(font->Ascent);
+            writer.Write(font->Descent);
+            writer.Write(static_cast<std::uint32_t>(font->Glyphs.Size));
+            for(const ImFontGlyph& glyph: font->Glyphs)
+            {
+                writer.Write(CachedGlyph{glyph.Codepoint, glyph.AdvanceX,
+                                         glyph.X0, glyph.Y0, glyph.X1, glyph.Y1,
+                                         glyph.U0, glyph.V0, glyph.U1, glyph.V1});
+            }
+        }
+
+        writer.WriteBytes(atlas.TexPixelsAlpha8, static_cast<std::size_t>(atlas.TexWidth) * static_cast<std::size_t>(atlas.TexHeight));
+
+        // Written aside and renamed, a crash never leaves a torn cache behind.
+        std::error_code error{};
+        if(m_file.has_parent_path())
+        {
+            std::filesystem::create_directories(m_file.parent_path(), error);
+        }
+
+        std::filesystem::path temporary{m_file};
+        temporary += ".tmp";
+        {
+            std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+            const std::vector<char>& buffer{writer.GetBuffer()};
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if(!file)
+            {
+                APP_WARN("Could not write the font atlas cache {}", temporary.string());
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporary, m_file, error);
+        if(error)
+        {
+            APP_WARN("Could not replace the font atlas cache {}: {}", m_file.string(), error.message());
+            std::filesystem::remove(temporary, error);
+        }
+    }
+
+}
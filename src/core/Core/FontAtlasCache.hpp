@@ -0,0 +1,44 @@
+#pragma once
+#include <imgui.h>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace App {
+
+    struct FontSource
+    {
+        std::filesystem::path file;
+        float sizePixels{0.0F};
+        // Zero terminated pairs like ImFontAtlas::GetGlyphRangesDefault(), the
+        // caller keeps them alive. nullptr is the default Latin range.
+        const ImWchar* glyphRanges{nullptr};
+        // Adds the glyphs to the previous font instead of a new one, e.g. icons.
+        bool mergeMode{false};
+    };
+
+    // Keeps a built ImGui font atlas on disk: texture pixels, glyph metrics and
+    // the atlas' custom rects. The key hashes the font files, sizes, glyph
+    // ranges, the atlas flags and the ImGui version, so any change rasterizes
+    // again and replaces the file. A matching file skips stb_truetype entirely.
+    class FontAtlasCache
+    {
+    public:
+        explicit FontAtlasCache(std::filesystem::path file);
+
+        // Fills an empty atlas with the sources and builds it. Returns the
+        // atlas' fonts in the order they were added, empty when a font file
+        // cannot be read; the atlas is left untouched then.
+        std::vector<ImFont*> Build(ImFontAtlas& atlas, const std::vector<FontSource>& sources);
+
+        [[nodiscard]] bool WasLoadedFromCache() const;
+
+    private:
+        bool Load(ImFontAtlas& atlas, std::uint64_t key) const;
+        void Save(const ImFontAtlas& atlas, std::uint64_t key) const;
+
+        std::filesystem::path m_file;
+        bool m_loadedFromCache{false};
+    };
+
+}
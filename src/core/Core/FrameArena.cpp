@@ -0,0 +1,79 @@
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace App {
+
+    FrameArena::FrameArena() : FrameArena(Settings{}) {}
+
+    FrameArena::FrameArena(const Settings& settings) : m_blockSize(std::max<std::size_t>(settings.blockSize, 1)) {}
+
+    void* FrameArena::Allocate(const std::size_t size, const std::size_t alignment)
+    {
+        while(true)
+        {
+            if(m_current < m_blocks.size())
+            {
+                Block& block{m_blocks[m_current]};
+                const auto base{reinterpret_cast<std::uintptr_t>(block.data.get())};
+                const std::uintptr_t aligned{(base + m_offset + alignment - 1) & ~(std::uintptr_t{alignment} - 1)};
+                const std::size_t begin{static_cast<std::size_t>(aligned - base)};
+                if(begin + size <= block.size)
+                {
+                    m_offset = begin + size;
+                    m_used += size;
+                    m_peak = std::max(m_peak, m_used);
+                    return block.data.get() + begin;
+                }
+
+                // The rest of this block stays unused until the next Reset().
+                if(m_current + 1 < m_blocks.size())
+                {
+                    ++m_current;
+                    m_offset = 0;
+                    continue;
+                }
+            }
+
+            // Only the first frames, or one that needs more than any before it.
+            const std::size_t blockSize{std::max(m_blockSize, size + alignment)};
+            m_blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[blockSize]), blockSize});
+            m_current = m_blocks.size() - 1;
+            m_offset = 0;
+        }
+    }
+
+    void FrameArena::Reset()
+    {
+        // A frame that spilled over gets one block holding all of it, so the
+        // next frames are back to a single bump pointer. Safe, nothing is live.
+        if(m_blocks.size() > 1)
+        {
+            std::size_t capacity{0};
+            for(const Block& block: m_blocks)
+            {
+                capacity += block.size;
+            }
+            m_blocks.clear();
+            m_blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[capacity]), capacity});
+        }
+
+        m_current = 0;
+        m_offset = 0;
+        m_used = 0;
+    }
+
+    FrameArena::Stats FrameArena::GetStats() const
+    {
+        Stats stats{};
+        stats.used = m_used;
+        stats.peak = m_peak;
+        stats.blocks = m_blocks.size();
+        for(const Block& block: m_blocks)
+        {
+            stats.capacity += block.size;
+        }
+        return stats;
+    }
+
+}
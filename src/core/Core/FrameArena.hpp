@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace App {
+
+    // Linear allocator for what lives no longer than a frame. Allocating is
+    // bumping an offset and nothing is freed on its own: Reset() at the top
+    // of every frame drops everything at once. A frame that needed more than
+    // the block makes Reset() replace the blocks with one as large as all of
+    // them, so after a few frames the heap is no longer touched at all.
+    // One thread only, the UI thread's arena is Application's.
+    class FrameArena
+    {
+    public:
+        struct Settings
+        {
+            std::size_t blockSize{256 * 1024};
+        };
+
+        struct Stats
+        {
+            // Since the last Reset().
+            std::size_t used{0};
+            // Most used in one frame.
+            std::size_t peak{0};
+            std::size_t capacity{0};
+            std::size_t blocks{0};
+        };
+
+        FrameArena();
+        explicit FrameArena(const Settings& settings);
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena(FrameArena&&) = delete;
+        FrameArena& operator=(FrameArena other) = delete;
+        FrameArena& operator=(FrameArena&& other) = delete;
+
+        // Never returns null, a request larger than a block gets a block of its own.
+        [[nodiscard]] void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+        // Everything allocated since the last Reset() is invalid afterwards.
+        void Reset();
+
+        [[nodiscard]] Stats GetStats() const;
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size{0};
+        };
+
+        std::vector<Block> m_blocks{};
+        std::size_t m_blockSize{0};
+        std::size_t m_current{0};
+        std::size_t m_offset{0};
+        std::size_t m_used{0};
+        std::size_t m_peak{0};
+    };
+
+    // For standard containers holding per-frame temporaries. Deallocation is
+    // a no-op, the memory comes back with FrameArena::Reset(). Without an
+    // arena it falls back to the heap, e.g. before Application set one.
+    template<typename T>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+        explicit FrameAllocator(FrameArena* arena) noexcept : m_arena(arena) {}
+
+        template<typename U>
+        // Rebinding, as containers do for their nodes, keeps the arena.
+        // NOLINTNEXTLINE(google-explicit-constructor)
+        FrameAllocator(const FrameAllocator<U>& other) noexcept : m_arena(other.GetArena())
+        {}
+
+        [[nodiscard]] T* allocate(const std::size_t count)
+        {
+            if(m_arena == nullptr)
+            {
+                return static_cast<T*>(::operator new(count * sizeof(T)));
+            }
+            return static_cast<T*>(m_arena->Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* pointer, const std::size_t /*count*/) noexcept
+        {
+            if(m_arena == nullptr)
+            {
+                ::operator delete(pointer);
+            }
+        }
+
+        [[nodiscard]] FrameArena* GetArena() const noexcept
+        {
+            return m_arena;
+        }
+
+        template<typename U>
+        friend bool operator==(const FrameAllocator& lhs, const FrameAllocator<U>& rhs) noexcept
+        {
+            return lhs.m_arena == rhs.GetArena();
+        }
+
+        template<typename U>
+        friend bool operator!=(const FrameAllocator& lhs, const FrameAllocator<U>& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        FrameArena* m_arena{nullptr};
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+}
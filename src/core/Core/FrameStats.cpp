@@ -0,0 +1,232 @@
+#include "FrameStats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include "Core/AllocationCounter.hpp"
+
+namespace App {
+
+    namespace {
+        constexpr std::size_t FrameIndex{FrameStats::PhaseCount};
+        constexpr std::size_t AllocationsIndex{FrameStats::PhaseCount + 1};
+
+        // Nearest-rank percentile of sorted values.
+        double Percentile(const std::vector<double>& sorted, const double percent)
+        {
+            const auto rank{static_cast<std::size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())))};
+            return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+        }
+
+        FrameStats::Summary Summarize(std::vector<double>& values)
+        {
+            FrameStats::Summary summary{};
+            if(values.empty())
+            {
+                return summary;
+            }
+
+            std::sort(values.begin(), values.end());
+
+            double sum{0.0};
+            for(const double value: values)
+            {
+                sum += value;
+            }
+
+            summary.min = values.front();
+            summary.mean = sum / static_cast<double>(values.size());
+            summary.p50 = Percentile(values, 50.0);
+            summary.p95 = Percentile(values, 95.0);
+            summary.p99 = Percentile(values, 99.0);
+            summary.max = values.back();
+            return summary;
+        }
+
+        nlohmann::json ToJson(const FrameStats::Summary& summary)
+        {
+            return {
+                    {"min", summary.min},
+                    {"mean", summary.mean},
+                    {"p50", summary.p50},
+                    {"p95", summary.p95},
+                    {"p99", summary.p99},
+                    {"max", summary.max}
+            };
+        }
+
+        void PrintRow(std::FILE* stream, const char* name, const FrameStats::Summary& summary)
+        {
+            std::fprintf(stream, "%-10s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+                         name, summary.min, summary.mean, summary.p50, summary.p95, summary.p99, summary.max);
+        }
+    }
+
+    const char* FrameStats::GetPhaseName(const Phase phase)
+    {
+        switch(phase)
+        {
+        case Phase::Events: return "Events";
+        case Phase::NewFrame: return "NewFrame";
+        case Phase::BuildUi: return "BuildUi";
+        case Phase::Render: return "Render";
+        case Phase::Swap: return "Swap";
+        case Phase::Count: break;
+        }
+        return "";
+    }
+
+    void FrameStats::Reserve(const std::size_t frames)
+    {
+        m_samples.reserve(frames);
+
+        const std::lock_guard<std::mutex> lock{m_latencyMutex};
+        m_inputLatencies.reserve(frames);
+    }
+
+    void FrameStats::Clear()
+    {
+        m_samples.clear();
+        m_inFrame = false;
+
+        const std::lock_guard<std::mutex> lock{m_latencyMutex};
+        m_inputLatencies.clear();
+    }
+
+    void FrameStats::BeginFrame()
+    {
+        m_current = {};
+        m_allocationsAtFrameStart = AllocationCounter::GetThreadAllocations();
+        m_frameStart = Clock::now();
+        m_lapStart = m_frameStart;
+        m_inFrame = true;
+    }
+
+    void FrameStats::Lap(const Phase phase)
+    {
+        if(!m_inFrame)
+        {
+            return;
+        }
+
+        const auto now{Clock::now()};
+        m_current[static_cast<std::size_t>(phase)] += (now - m_lapStart).count();
+        m_lapStart = now;
+    }
+
+    void FrameStats::EndFrame()
+    {
+        if(!m_inFrame)
+        {
+            return;
+        }
+
+        m_current[FrameIndex] = (Clock::now() - m_frameStart).count();
+        m_current[AllocationsIndex] =
+                static_cast<std::int64_t>(AllocationCounter::GetThreadAllocations() - m_allocationsAtFrameStart);
+        m_samples.push_back(m_current);
+        m_inFrame = false;
+    }
+
+    void FrameStats::AddInputLatency(const std::chrono::microseconds latency)
+    {
+        const std::lock_guard<std::mutex> lock{m_latencyMutex};
+        m_inputLatencies.push_back(latency.count());
+    }
+
+    std::size_t FrameStats::GetFrameCount() const
+    {
+        return m_samples.size();
+    }
+
+    FrameStats::Report FrameStats::GetReport() const
+    {
+        Report report{};
+        report.frames = m_samples.size();
+
+        constexpr double NanosecondsPerMillisecond{1.0e6};
+        std::vector<double> values(m_samples.size());
+        const auto summarize{[&](const std::size_t index) {
+            std::transform(m_samples.begin(), m_samples.end(), values.begin(), [index](const Sample& sample) {
+                return static_cast<double>(sample[index]) / NanosecondsPerMillisecond;
+            });
+            return Summarize(values);
+        }};
+
+        report.frame = summarize(FrameIndex);
+        for(std::size_t phase = 0; phase < PhaseCount; ++phase)
+        {
+            report.phases[phase] = summarize(phase);
+        }
+
+        report.allocationsCounted = AllocationCounter::IsEnabled();
+        for(const Sample& sample: m_samples)
+        {
+            const auto allocations{static_cast<std::uint64_t>(sample[AllocationsIndex])};
+            report.allocations += allocations;
+            report.maxFrameAllocations = std::max(report.maxFrameAllocations, allocations);
+            report.allocatingFrames += allocations > 0 ? 1 : 0;
+        }
+
+        constexpr double MicrosecondsPerMillisecond{1.0e3};
+        const std::lock_guard<std::mutex> lock{m_latencyMutex};
+        report.inputFrames = m_inputLatencies.size();
+        values.resize(m_inputLatencies.size());
+        std::transform(m_inputLatencies.begin(), m_inputLatencies.end(), values.begin(), [](const std::int64_t latency) {
+            return static_cast<double>(latency) / MicrosecondsPerMillisecond;
+        });
+        report.inputLatency = Summarize(values);
+        return report;
+    }
+
+    void FrameStats::Print(const Report& report, std::FILE* stream)
+    {
+        std::fprintf(stream, "%zu frames, milliseconds\n", report.frames);
+        std::fprintf(stream, "%-10s %8s %8s %8s %8s %8s %8s\n", "", "min", "mean", "p50", "p95", "p99", "max");
+        PrintRow(stream, "Frame", report.frame);
+        for(std::size_t phase = 0; phase < PhaseCount; ++phase)
+        {
+            PrintRow(stream, GetPhaseName(static_cast<Phase>(phase)), report.phases[phase]);
+        }
+        std::fprintf(stream, "input to present over %zu frames with input\n", report.inputFrames);
+        PrintRow(stream, "Latency", report.inputLatency);
+        if(report.allocationsCounted)
+        {
+            std::fprintf(stream, "heap allocations: %llu, at most %llu in a frame, %zu frames allocated\n",
+                         static_cast<unsigned long long>(report.allocations),
+                         static_cast<unsigned long long>(report.maxFrameAllocations),
+                         report.allocatingFrames);
+        }
+        else
+        {
+            std::fprintf(stream, "heap allocations: not counted, build with COUNT_ALLOCATIONS\n");
+        }
+    }
+
+    bool FrameStats::WriteJson(const Report& report, const std::string& path)
+    {
+        nlohmann::json phases = nlohmann::json::object();
+        for(std::size_t phase = 0; phase < PhaseCount; ++phase)
+        {
+            phases[GetPhaseName(static_cast<Phase>(phase))] = ToJson(report.phases[phase]);
+        }
+
+        const nlohmann::json json = {
+                {"frames", report.frames},
+                {"unit", "ms"},
+                {"frame", ToJson(report.frame)},
+                {"phases", phases},
+                {"inputFrames", report.inputFrames},
+                {"inputLatency", ToJson(report.inputLatency)},
+                {"allocationsCounted", report.allocationsCounted},
+                {"allocations", report.allocations},
+                {"maxFrameAllocations", report.maxFrameAllocations},
+                {"allocatingFrames", report.allocatingFrames}
+        };
+
+        std::ofstream file{path};
+        file << json.dump(4) << '\n';
+        return static_cast<bool>(file);
+    }
+
+}
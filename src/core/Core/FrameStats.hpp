@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace App {
+
+    // Collects CPU frame times split into the phases of Application::Run and
+    // reports min/mean/percentiles over all recorded frames. Meant for the
+    // headless benchmark, recording a frame is a handful of clock reads.
+    class FrameStats
+    {
+    public:
+        enum class Phase : std::size_t
+        {
+            Events,
+            NewFrame,
+            BuildUi,
+            Render,
+            Swap,
+            Count
+        };
+
+        static constexpr std::size_t PhaseCount{static_cast<std::size_t>(Phase::Count)};
+
+        struct Summary
+        {
+            double min{0.0};
+            double mean{0.0};
+            double p50{0.0};
+            double p95{0.0};
+            double p99{0.0};
+            double max{0.0};
+        };
+
+        struct Report
+        {
+            std::size_t frames{0};
+            // All durations in milliseconds.
+            Summary frame{};
+            std::array<Summary, PhaseCount> phases{};
+            // Input-to-present, over the frames that carried input.
+            std::size_t inputFrames{0};
+            Summary inputLatency{};
+            // operator new calls on the frame's thread, see AllocationCounter.
+            bool allocationsCounted{false};
+            std::uint64_t allocations{0};
+            std::uint64_t maxFrameAllocations{0};
+            std::size_t allocatingFrames{0};
+        };
+
+        [[nodiscard]] static const char* GetPhaseName(Phase phase);
+
+        // Frames beyond the reserved count still record, they may reallocate.
+        void Reserve(std::size_t frames);
+        void Clear();
+
+        void BeginFrame();
+        // Ends the current phase, it spans the time since BeginFrame or the previous Lap.
+        void Lap(Phase phase);
+        void EndFrame();
+        // Safe from any thread, e.g. the render thread presenting the frame.
+        void AddInputLatency(std::chrono::microseconds latency);
+
+        [[nodiscard]] std::size_t GetFrameCount() const;
+        [[nodiscard]] Report GetReport() const;
+
+        static void Print(const Report& report, std::FILE* stream);
+        // Returns false when the file cannot be written.
+        static bool WriteJson(const Report& report, const std::string& path);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+        // Phase durations followed by the whole frame, in nanoseconds, then
+        // the heap allocations the frame made.
+        using Sample = std::array<std::int64_t, PhaseCount + 2>;
+
+        std::vector<Sample> m_samples{};
+        Sample m_current{};
+        std::uint64_t m_allocationsAtFrameStart{0};
+        Clock::time_point m_frameStart{};
+        Clock::time_point m_lapStart{};
+        bool m_inFrame{false};
+
+        mutable std::mutex m_latencyMutex;
+        std::vector<std::int64_t> m_inputLatencies{};
+    };
+
+}
@@ -0,0 +1,183 @@
+#include "GpuProfiler.hpp"
+#include <algorithm>
+#include <glad/glad.h>
+
+namespace App::Debug {
+
+    namespace {
+        // The GPU and CPU clocks drift apart slowly, re-measure their offset now and then.
+        constexpr std::chrono::seconds ClockSyncInterval{1};
+    }
+
+    void GpuProfiler::Init()
+    {
+        if(m_enabled)
+        {
+            return;
+        }
+
+        if(GLAD_GL_VERSION_3_3 == 0)
+        {
+            APP_WARN("GPU profiling disabled, timer queries need OpenGL 3.3.");
+            return;
+        }
+
+        GLint counterBits{0};
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+        if(counterBits == 0)
+        {
+            APP_WARN("GPU profiling disabled, the driver has no timestamp counter.");
+            return;
+        }
+
+        if(m_track == nullptr)
+        {
+            m_track = &Instrumentor::Get().CreateTrack("GPU");
+        }
+
+        SynchronizeClocks();
+        m_enabled = true;
+    }
+
+    void GpuProfiler::Shutdown()
+    {
+        if(!m_enabled)
+        {
+            return;
+        }
+
+        // Nothing waits on these any more, so stalling for the frames in flight is fine here.
+        glFinish();
+        for(std::size_t i = 1; i <= FramesInFlight; ++i)
+        {
+            CollectFrame(m_frames[(m_frameIndex + i) % FramesInFlight]);
+        }
+
+        for(Frame& frame: m_frames)
+        {
+            if(!frame.queries.empty())
+            {
+                glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+            }
+            frame = Frame{};
+        }
+        m_openScopes.clear();
+        m_enabled = false;
+    }
+
+    void GpuProfiler::BeginFrame()
+    {
+        if(!m_enabled)
+        {
+            return;
+        }
+
+        if(std::chrono::steady_clock::now() - m_lastClockSync > ClockSyncInterval)
+        {
+            SynchronizeClocks();
+        }
+
+        // The slot we are about to reuse was issued FramesInFlight frames ago.
+        m_frameIndex = (m_frameIndex + 1) % FramesInFlight;
+        Frame& frame{m_frames[m_frameIndex]};
+        CollectFrame(frame);
+        frame.usedQueries = 0;
+        frame.scopes.clear();
+        m_openScopes.clear();
+    }
+
+    void GpuProfiler::BeginScope(const ScopeDescriptor& descriptor)
+    {
+        if(!m_enabled)
+        {
+            return;
+        }
+
+        Frame& frame{m_frames[m_frameIndex]};
+        m_openScopes.push_back(frame.scopes.size());
+        frame.scopes.push_back({&descriptor, IssueTimestamp(frame), 0});
+    }
+
+    void GpuProfiler::EndScope()
+    {
+        if(!m_enabled || m_openScopes.empty())
+        {
+            return;
+        }
+
+        Frame& frame{m_frames[m_frameIndex]};
+        frame.scopes[m_openScopes.back()].endQuery = IssueTimestamp(frame);
+        m_openScopes.pop_back();
+    }
+
+    std::uint64_t GpuProfiler::GetDroppedFrameCount() const
+    {
+        return m_droppedFrames;
+    }
+
+    std::size_t GpuProfiler::IssueTimestamp(Frame& frame)
+    {
+        if(frame.usedQueries == frame.queries.size())
+        {
+            const auto grown{std::max<std::size_t>(frame.queries.size() * 2, 16)};
+            const auto added{grown - frame.queries.size()};
+            frame.queries.resize(grown);
+            glGenQueries(static_cast<GLsizei>(added), frame.queries.data() + (grown - added));
+        }
+
+        const std::size_t index{frame.usedQueries++};
+        glQueryCounter(frame.queries[index], GL_TIMESTAMP);
+        return index;
+    }
+
+    void GpuProfiler::CollectFrame(Frame& frame)
+    {
+        if(frame.usedQueries == 0)
+        {
+            return;
+        }
+
+        // Queries complete in order, so the newest one tells for the whole frame.
+        GLint available{GL_FALSE};
+        glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available == GL_FALSE)
+        {
+            ++m_droppedFrames;
+            return;
+        }
+
+        for(const Scope& scope: frame.scopes)
+        {
+            // A scope left open at the end of its frame has no end timestamp.
+            if(scope.endQuery == 0)
+            {
+                continue;
+            }
+
+            GLuint64 begin{0};
+            GLuint64 end{0};
+            glGetQueryObjectui64v(frame.queries[scope.beginQuery], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frame.queries[scope.endQuery], GL_QUERY_RESULT, &end);
+
+            const std::chrono::nanoseconds start{static_cast<std::int64_t>(begin) + m_clockOffsetNs};
+            const std::chrono::nanoseconds elapsed{static_cast<std::int64_t>(end - begin)};
+            Instrumentor::Get().WriteProfile(
+                    *m_track,
+                    {scope.descriptor,
+                     FloatingPointMicroseconds{start},
+                     std::chrono::duration_cast<std::chrono::microseconds>(elapsed)});
+        }
+    }
+
+    void GpuProfiler::SynchronizeClocks()
+    {
+        GLint64 gpuNow{0};
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        const auto cpuNow{std::chrono::steady_clock::now()};
+
+        m_clockOffsetNs = std::chrono::duration_cast<std::chrono::nanoseconds>(cpuNow.time_since_epoch()).count()
+                          - gpuNow;
+        m_lastClockSync = cpuNow;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Core/Instrumentor.hpp"
+
+namespace App::Debug {
+
+    // Measures GPU durations with GL_TIMESTAMP queries and writes them to a
+    // "GPU" track of the Instrumentor, shifted onto the CPU clock. Results are
+    // read back FramesInFlight frames later, a frame whose queries are still
+    // not available by then is dropped instead of stalling the pipeline.
+    class GpuProfiler
+    {
+    public:
+        static constexpr std::size_t FramesInFlight{4};
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler(GpuProfiler&&) = delete;
+        GpuProfiler& operator=(GpuProfiler other) = delete;
+        GpuProfiler& operator=(GpuProfiler&& other) = delete;
+
+        // Init and Shutdown need the GL context current, everything else must
+        // run on the thread owning it.
+        void Init();
+        void Shutdown();
+
+        // Call once per frame before the first GPU scope.
+        void BeginFrame();
+
+        void BeginScope(const ScopeDescriptor& descriptor);
+        void EndScope();
+
+        [[nodiscard]] std::uint64_t GetDroppedFrameCount() const;
+
+        static GpuProfiler& Get()
+        {
+            static GpuProfiler instance;
+            return instance;
+        }
+
+    private:
+        struct Scope
+        {
+            const ScopeDescriptor* descriptor;
+            std::size_t beginQuery;
+            std::size_t endQuery;
+        };
+
+        struct Frame
+        {
+            std::vector<unsigned int> queries;
+            std::size_t usedQueries{0};
+            std::vector<Scope> scopes;
+        };
+
+        GpuProfiler() = default;
+        ~GpuProfiler() = default;
+
+        std::size_t IssueTimestamp(Frame& frame);
+        void CollectFrame(Frame& frame);
+        void SynchronizeClocks();
+
+        bool m_enabled{false};
+        ThreadEventBuffer* m_track{nullptr};
+        std::array<Frame, FramesInFlight> m_frames{};
+        std::size_t m_frameIndex{0};
+        std::vector<std::size_t> m_openScopes;
+
+        // CPU steady_clock minus GPU timestamp, in nanoseconds.
+        std::int64_t m_clockOffsetNs{0};
+        std::chrono::steady_clock::time_point m_lastClockSync{};
+        std::uint64_t m_droppedFrames{0};
+    };
+
+    class GpuScope
+    {
+    public:
+        explicit GpuScope(const ScopeDescriptor& descriptor)
+                : m_active(Instrumentor::Get().IsCategoryActive(descriptor.category))
+        {
+            if(m_active)
+            {
+                GpuProfiler::Get().BeginScope(descriptor);
+            }
+        }
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope(GpuScope&&) = delete;
+        GpuScope& operator=(GpuScope other) = delete;
+        GpuScope& operator=(GpuScope&& other) = delete;
+
+        ~GpuScope()
+        {
+            if(m_active)
+            {
+                GpuProfiler::Get().EndScope();
+            }
+        }
+
+    private:
+        const bool m_active;
+    };
+
+}
+
+#if APP_PROFILE
+#define APP_PROFILE_GPU_INIT() ::App::Debug::GpuProfiler::Get().Init()
+#define APP_PROFILE_GPU_SHUTDOWN() ::App::Debug::GpuProfiler::Get().Shutdown()
+#define APP_PROFILE_GPU_FRAME() ::App::Debug::GpuProfiler::Get().BeginFrame()
+#define APP_PROFILE_GPU_SCOPE(name)                                                  \
+  static constexpr ::App::Debug::ScopeDescriptor JOIN(gpuScopeDescriptor, __LINE__){ \
+    name, __FILE__, __LINE__, ::App::Debug::ProfileCategory::Gpu                     \
+  };                                                                                 \
+  const ::App::Debug::GpuScope JOIN(gpuScope, __LINE__) {                            \
+    JOIN(gpuScopeDescriptor, __LINE__)                                               \
+  }
+#else
+#define APP_PROFILE_GPU_INIT()
+#define APP_PROFILE_GPU_SHUTDOWN()
+#define APP_PROFILE_GPU_FRAME()
+#define APP_PROFILE_GPU_SCOPE(name)
+#endif
\ No newline at end of file
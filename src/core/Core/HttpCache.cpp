@@ -0,0 +1,844 @@
+#include "HttpCache.hpp"
+#include <curl/curl.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <string_view>
+#include <unordered_set>
+#include "Core/Instrumentor.hpp"
+#include "Core/Log.hpp"
+
+namespace App {
+
+    namespace {
+        // Upper bound of the Last-Modified heuristic.
+        constexpr std::int64_t MaxHeuristicMs{24 * 60 * 60 * 1000};
+        constexpr std::string_view FileSuffix{".body"};
+        // Request headers that pick a different response for the same URL.
+        constexpr std::array<std::string_view, 4> VaryingHeaders{"accept", "accept-language", "authorization", "cookie"};
+
+        struct CacheControl
+        {
+            bool noStore{false};
+            bool noCache{false};
+            bool mustRevalidate{false};
+            // In seconds, negative when not given.
+            std::int64_t maxAge{-1};
+            std::int64_t staleWhileRevalidate{-1};
+        };
+
+        std::int64_t NowMs()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        std::string ToLower(std::string_view text)
+        {
+            std::string lower{text};
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](const unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            return lower;
+        }
+
+        std::string_view Trim(std::string_view text)
+        {
+            while(!text.empty() && (text.front() == ' ' || text.front() == '\t' || text.front() == '"'))
+            {
+                text.remove_prefix(1);
+            }
+            while(!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '"'))
+            {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        // The URL, followed by a space and a hash of the varying request
+        // headers when there are any. A URL has no spaces, and the hash keeps
+        // credentials out of the table.
+        std::string GetKey(const HttpClient::Request& request)
+        {
+            std::vector<std::string> varying{};
+            for(const std::string& header: request.headers)
+            {
+                const std::string_view line{header};
+                const std::size_t colon{line.find(':')};
+                if(colon == std::string_view::npos)
+                {
+                    continue;
+                }
+                const std::string name{ToLower(Trim(line.substr(0, colon)))};
+                if(std::find(VaryingHeaders.begin(), VaryingHeaders.end(), name) != VaryingHeaders.end())
+                {
+                    varying.push_back(name + ':' + std::string{Trim(line.substr(colon + 1))});
+                }
+            }
+            if(varying.empty())
+            {
+                return request.url;
+            }
+
+            // FNV-1a, the same in every build so stored keys stay valid.
+            std::sort(varying.begin(), varying.end());
+            std::uint64_t hash{14695981039346656037ULL};
+            for(const std::string& line: varying)
+            {
+                for(const char c: line)
+                {
+                    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+                }
+                hash = (hash ^ static_cast<unsigned char>('\n')) * 1099511628211ULL;
+            }
+            std::array<char, 24> suffix{};
+            std::snprintf(suffix.data(), suffix.size(), " %016" PRIx64, hash);
+            return request.url + suffix.data();
+        }
+
+        std::int64_t ParseSeconds(const std::string_view text)
+        {
+            std::int64_t seconds{-1};
+            std::from_chars(text.data(), text.data() + text.size(), seconds);
+            return seconds;
+        }
+
+        // An HTTP date in milliseconds since the Unix epoch, negative when missing or invalid.
+        std::int64_t ParseDate(const std::string* text)
+        {
+            if(text == nullptr || text->empty())
+            {
+                return -1;
+            }
+            const time_t time{curl_getdate(text->c_str(), nullptr)};
+            return time < 0 ? -1 : static_cast<std::int64_t>(time) * 1000;
+        }
+
+        CacheControl ParseCacheControl(const HttpClient::Response& response)
+        {
+            CacheControl control{};
+            for(const auto& [name, value]: response.headers)
+            {
+                if(name != "cache-control")
+                {
+                    continue;
+                }
+
+                const std::string_view directives{value};
+                std::size_t begin{0};
+                while(begin < directives.size())
+                {
+                    const std::size_t end{std::min(directives.find(',', begin), directives.size())};
+                    const std::string_view directive{Trim(directives.substr(begin, end - begin))};
+                    const std::size_t equals{directive.find('=')};
+                    const std::string key{ToLower(Trim(directive.substr(0, equals)))};
+                    const std::string_view argument{equals == std::string_view::npos ? std::string_view{} : Trim(directive.substr(equals + 1))};
+
+                    if(key == "no-store")
+                    {
+                        control.noStore = true;
+                    }
+                    else if(key == "no-cache")
+                    {
+                        control.noCache = true;
+                    }
+                    else if(key == "must-revalidate")
+                    {
+                        control.mustRevalidate = true;
+                    }
+                    else if(key == "max-age")
+                    {
+                        control.maxAge = ParseSeconds(argument);
+                    }
+                    else if(key == "stale-while-revalidate")
+                    {
+                        control.staleWhileRevalidate = ParseSeconds(argument);
+                    }
+                    begin = end + 1;
+                }
+            }
+            return control;
+        }
+
+        bool WriteFile(const std::filesystem::path& path, const std::string& content)
+        {
+            std::error_code error{};
+            std::filesystem::create_directories(path.parent_path(), error);
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            file.write(content.data(), static_cast<std::streamsize>(content.size()));
+            return static_cast<bool>(file);
+        }
+
+        // Anything but the size the entry recorded is a damaged body.
+        std::shared_ptr<const std::string> ReadFile(const std::filesystem::path& path, const std::int64_t expectedSize)
+        {
+            std::error_code error{};
+            const auto size{std::filesystem::file_size(path, error)};
+            std::ifstream file{path, std::ios::binary};
+            if(error || !file || size != static_cast<std::uintmax_t>(expectedSize))
+            {
+                return nullptr;
+            }
+            auto content{std::make_shared<std::string>(static_cast<std::size_t>(size), '\0')};
+            file.read(content->data(), static_cast<std::streamsize>(content->size()));
+            if(static_cast<std::size_t>(file.gcount()) != content->size())
+            {
+                return nullptr;
+            }
+            return content;
+        }
+
+        std::chrono::microseconds Since(const std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    HttpCache::HttpCache(HttpClient& client, Database& database, JobSystem& jobs)
+            : HttpCache(client, database, jobs, Settings{})
+    {
+    }
+
+    HttpCache::HttpCache(HttpClient& client, Database& database, JobSystem& jobs, const Settings& settings)
+            : m_client(client), m_database(database), m_jobs(jobs), m_settings(settings),
+              m_self(std::make_shared<HttpCache*>(this)), m_fileCounter(static_cast<std::uint64_t>(NowMs()))
+    {
+        Load();
+    }
+
+    void HttpCache::Send(HttpClient::Request request, Callback callback)
+    {
+        APP_PROFILE_FUNCTION();
+
+        const bool cacheable{request.method == "GET" && !request.onData};
+        std::string key{cacheable ? GetKey(request) : std::string{}};
+        Waiter waiter{std::move(request), std::move(key), std::move(callback), Clock::now()};
+        if(!cacheable)
+        {
+            Forward(std::move(waiter));
+            return;
+        }
+        if(!m_loaded)
+        {
+            m_queued.push_back(std::move(waiter));
+            return;
+        }
+        Lookup(std::move(waiter));
+    }
+
+    bool HttpCache::IsLoaded() const
+    {
+        return m_loaded;
+    }
+
+    std::size_t HttpCache::GetEntryCount() const
+    {
+        return m_index.size();
+    }
+
+    const HttpCache::Stats& HttpCache::GetStats() const
+    {
+        return m_stats;
+    }
+
+    void HttpCache::Load()
+    {
+        m_database.Execute("CREATE TABLE IF NOT EXISTS http_cache("
+                           "url TEXT PRIMARY KEY, "
+                           "file TEXT NOT NULL, "
+                           "etag TEXT NOT NULL, "
+                           "last_modified TEXT NOT NULL, "
+                           "fresh_until INTEGER NOT NULL, "
+                           "stale_until INTEGER NOT NULL, "
+                           "size INTEGER NOT NULL, "
+                           "used INTEGER NOT NULL)",
+                           {},
+                           [self = std::weak_ptr<HttpCache*>{m_self}](const Database::Result& created) {
+                               const auto cache{self.lock()};
+                               if(cache == nullptr)
+                               {
+                                   return;
+                               }
+                               if(!created.Succeeded())
+                               {
+                                   (*cache)->OnLoaded(created);
+                                   return;
+                               }
+                               // Only once the table exists, the readers do not wait for the writer.
+                               (*cache)->m_database.Query("SELECT url, file, etag, last_modified, fresh_until, stale_until, size, used "
+                                                          "FROM http_cache",
+                                                          {},
+                                                          [self](const Database::Result& result) {
+                                                              if(const auto loaded{self.lock()})
+                                                              {
+                                                                  (*loaded)->OnLoaded(result);
+                                                              }
+                                                          });
+                           });
+    }
+
+    void HttpCache::OnLoaded(const Database::Result& result)
+    {
+        APP_PROFILE_FUNCTION();
+
+        if(!result.Succeeded())
+        {
+            APP_WARN("Could not load the HTTP cache index: {}", result.error);
+        }
+
+        auto files{std::make_shared<std::unordered_set<std::string>>()};
+        for(const Database::Row& row: result.rows)
+        {
+            const auto* url{std::get_if<std::string>(&row[0])};
+            const auto* file{std::get_if<std::string>(&row[1])};
+            const auto* etag{std::get_if<std::string>(&row[2])};
+            const auto* lastModified{std::get_if<std::string>(&row[3])};
+            const auto* freshUntil{std::get_if<std::int64_t>(&row[4])};
+            const auto* staleUntil{std::get_if<std::int64_t>(&row[5])};
+            const auto* size{std::get_if<std::int64_t>(&row[6])};
+            const auto* used{std::get_if<std::int64_t>(&row[7])};
+            if(url == nullptr || file == nullptr || etag == nullptr || lastModified == nullptr || freshUntil == nullptr
+               || staleUntil == nullptr || size == nullptr || used == nullptr)
+            {
+                continue;
+            }
+
+            m_index[*url] = Entry{*file, *etag, *lastModified, *freshUntil, *staleUntil, *size, *used, nullptr};
+            m_diskBytes += static_cast<std::size_t>(*size);
+            files->insert(*file);
+        }
+
+        // Bodies without a row are left over from a crash between writing the
+        // file and its row. Swept before anything new is written.
+        const JobSystem::Handle sweep{m_jobs.Schedule([directory = m_settings.directory, files] {
+            APP_PROFILE_SCOPE("HttpCache::Sweep");
+            std::error_code error{};
+            for(std::filesystem::directory_iterator it{directory, error}, end{}; !error && it != end; it.increment(error))
+            {
+                const std::filesystem::path& path{it->path()};
+                if(path.extension() == FileSuffix && files->count(path.filename().string()) == 0)
+                {
+                    std::error_code removeError{};
+                    std::filesystem::remove(path, removeError);
+                }
+            }
+        })};
+        m_jobs.ScheduleOnMainThread([self = std::weak_ptr<HttpCache*>{m_self}] {
+            const auto cache{self.lock()};
+            if(cache == nullptr)
+            {
+                return;
+            }
+
+            HttpCache& owner{**cache};
+            owner.m_loaded = true;
+            owner.EvictDisk();
+            for(Waiter& waiter: std::exchange(owner.m_queued, {}))
+            {
+                owner.Lookup(std::move(waiter));
+            }
+        }, {sweep});
+    }
+
+    void HttpCache::Forward(Waiter waiter)
+    {
+        HttpClient::Request request{std::move(waiter.request)};
+        const bool unsafe{request.method != "GET" && request.method != "HEAD" && request.method != "OPTIONS"};
+        std::string url{unsafe ? request.url : std::string{}};
+        m_client.Send(std::move(request),
+                      [self = std::weak_ptr<HttpCache*>{m_self}, url = std::move(url), waiter = std::move(waiter)](
+                              const HttpClient::Response& response) {
+                          const auto cache{self.lock()};
+                          if(cache == nullptr)
+                          {
+                              return;
+                          }
+                          if(!url.empty() && response.Succeeded())
+                          {
+                              (*cache)->RemoveUrl(url);
+                          }
+                          waiter.callback({response.status,
+                                           std::make_shared<const std::string>(response.body),
+                                           response.cancelled ? std::string{"Cancelled"} : response.error,
+                                           Source::Network,
+                                           false,
+                                           Since(waiter.start)});
+                      });
+    }
+
+    void HttpCache::Lookup(Waiter waiter)
+    {
+        const auto it{m_index.find(waiter.key)};
+        if(it == m_index.end())
+        {
+            Fetch(std::move(waiter));
+            return;
+        }
+
+        const std::int64_t now{NowMs()};
+        const Entry& entry{it->second};
+        if(now < entry.freshUntil)
+        {
+            Serve(std::move(waiter), false, false);
+        }
+        else if(now < entry.staleUntil)
+        {
+            ++m_stats.staleServed;
+            Serve(std::move(waiter), true, true);
+        }
+        else
+        {
+            Fetch(std::move(waiter));
+        }
+    }
+
+    void HttpCache::Serve(Waiter waiter, const bool stale, const bool revalidate)
+    {
+        const std::string key{waiter.key};
+        if(std::shared_ptr<const std::string> body{FindInMemory(key)})
+        {
+            ++m_stats.memoryHits;
+            OnRead(std::move(waiter), stale, revalidate, Source::Memory, std::move(body));
+            return;
+        }
+
+        const auto it{m_index.find(key)};
+        if(it == m_index.end())
+        {
+            // Removed while the waiter was on its way here.
+            OnRead(std::move(waiter), stale, revalidate, Source::Network, nullptr);
+            return;
+        }
+        if(it->second.writing != nullptr)
+        {
+            // Its file may be half written yet.
+            ++m_stats.memoryHits;
+            OnRead(std::move(waiter), stale, revalidate, Source::Memory, it->second.writing);
+            return;
+        }
+
+        auto body{std::make_shared<std::shared_ptr<const std::string>>()};
+        const JobSystem::Handle read{m_jobs.Schedule([path = m_settings.directory / it->second.file, size = it->second.size, body] {
+            APP_PROFILE_SCOPE("HttpCache::Read");
+            *body = ReadFile(path, size);
+        })};
+        m_jobs.ScheduleOnMainThread(
+                [self = std::weak_ptr<HttpCache*>{m_self}, key, file = it->second.file, waiter = std::move(waiter), stale, revalidate, body]() mutable {
+                    const auto cache{self.lock()};
+                    if(cache == nullptr)
+                    {
+                        return;
+                    }
+
+                    HttpCache& owner{**cache};
+                    const auto entry{owner.m_index.find(key)};
+                    // A body replaced while it was read is not remembered for the new entry.
+                    const bool current{entry != owner.m_index.end() && entry->second.file == file};
+                    if(*body != nullptr && current)
+                    {
+                        ++owner.m_stats.diskHits;
+                        owner.Remember(key, *body);
+                        entry->second.used = NowMs();
+                        owner.m_database.Execute("UPDATE http_cache SET used = ? WHERE url = ?", {entry->second.used, key});
+                    }
+                    else if(*body == nullptr && current)
+                    {
+                        // Deleted or damaged behind our back, the network has it.
+                        owner.Remove(key);
+                    }
+                    owner.OnRead(std::move(waiter), stale, revalidate, Source::Disk, std::move(*body));
+                },
+                {read});
+    }
+
+    void HttpCache::OnRead(Waiter waiter, const bool stale, const bool revalidate, const Source source, std::shared_ptr<const std::string> body)
+    {
+        if(body == nullptr)
+        {
+            Fetch(std::move(waiter));
+            return;
+        }
+
+        waiter.callback({200, body, {}, source, stale, Since(waiter.start)});
+        if(revalidate)
+        {
+            waiter.served = std::move(body);
+            Fetch(std::move(waiter));
+        }
+    }
+
+    void HttpCache::Fetch(Waiter waiter)
+    {
+        // Waiters on one key differ at most in headers that do not change the
+        // response, the first one's request goes out for all of them.
+        HttpClient::Request request{waiter.request};
+        std::string key{waiter.key};
+        const auto [pending, first]{m_inFlight.try_emplace(key)};
+        pending->second.push_back(std::move(waiter));
+        if(!first)
+        {
+            return;
+        }
+
+        const auto it{m_index.find(key)};
+        const bool conditional{it != m_index.end()};
+        if(conditional)
+        {
+            ++m_stats.revalidations;
+            if(!it->second.etag.empty())
+            {
+                request.headers.push_back("If-None-Match: " + it->second.etag);
+            }
+            if(!it->second.lastModified.empty())
+            {
+                request.headers.push_back("If-Modified-Since: " + it->second.lastModified);
+            }
+        }
+        else
+        {
+            ++m_stats.fetches;
+        }
+
+        m_client.Send(std::move(request),
+                      [self = std::weak_ptr<HttpCache*>{m_self}, key = std::move(key), conditional](const HttpClient::Response& response) {
+                          if(const auto cache{self.lock()})
+                          {
+                              (*cache)->OnFetched(key, conditional, response);
+                          }
+                      });
+    }
+
+    void HttpCache::OnFetched(const std::string& key, const bool conditional, const HttpClient::Response& response)
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::vector<Waiter> waiters{};
+        if(const auto pending{m_inFlight.find(key)}; pending != m_inFlight.end())
+        {
+            waiters = std::move(pending->second);
+            m_inFlight.erase(pending);
+        }
+
+        const std::int64_t now{NowMs()};
+        const auto stored{m_index.find(key)};
+        const bool notModified{response.status == 304 && response.error.empty()};
+        if(stored != m_index.end() && notModified)
+        {
+            ++m_stats.notModified;
+            Renew(key, stored->second, response, now);
+            for(Waiter& waiter: waiters)
+            {
+                if(waiter.served == nullptr)
+                {
+                    Serve(std::move(waiter), false, false);
+                }
+            }
+            return;
+        }
+        if(conditional && notModified)
+        {
+            // The entry it refers to was removed or evicted meanwhile. The
+            // requests go out again, now without the validators.
+            for(Waiter& waiter: waiters)
+            {
+                if(waiter.served == nullptr)
+                {
+                    Fetch(std::move(waiter));
+                }
+            }
+            return;
+        }
+
+        const bool failed{!response.error.empty() || response.cancelled || response.status >= 500};
+        if(failed && stored != m_index.end() && stored->second.staleUntil > stored->second.freshUntil)
+        {
+            // The stored copy beats an error, unless the server said it must not be used stale.
+            for(Waiter& waiter: waiters)
+            {
+                if(waiter.served == nullptr)
+                {
+                    ++m_stats.staleServed;
+                    Serve(std::move(waiter), true, false);
+                }
+            }
+            return;
+        }
+
+        const auto body{std::make_shared<const std::string>(response.body)};
+        if(!failed && !Store(key, response, body, now))
+        {
+            // No longer cacheable, changed into an error or gone.
+            Remove(key);
+        }
+
+        for(Waiter& waiter: waiters)
+        {
+            if(waiter.served != nullptr && (!response.Succeeded() || *waiter.served == *body))
+            {
+                // It already has a copy and nothing better came.
+                continue;
+            }
+            waiter.callback({response.status,
+                             body,
+                             response.cancelled ? std::string{"Cancelled"} : response.error,
+                             Source::Network,
+                             false,
+                             Since(waiter.start)});
+        }
+    }
+
+    HttpCache::Freshness HttpCache::GetFreshness(const HttpClient::Response& response, const std::int64_t now, const std::string& lastModified) const
+    {
+        const CacheControl control{ParseCacheControl(response)};
+        const std::int64_t date{ParseDate(response.FindHeader("date"))};
+        const std::int64_t base{date >= 0 ? date : now};
+
+        std::int64_t lifetime{0};
+        if(control.noCache)
+        {
+            lifetime = 0;
+        }
+        else if(control.maxAge >= 0)
+        {
+            lifetime = control.maxAge * 1000;
+        }
+        else if(const std::string* expires{response.FindHeader("expires")}; expires != nullptr)
+        {
+            // Invalid dates, e.g. "0", mean already expired.
+            lifetime = std::max<std::int64_t>(ParseDate(expires) - base, 0);
+        }
+        else if(const std::int64_t modified{ParseDate(&lastModified)}; modified >= 0)
+        {
+            lifetime = std::clamp<std::int64_t>((base - modified) / 10, 0, MaxHeuristicMs);
+        }
+
+        // Time it spent in caches on the way and on the wire, by whichever says more.
+        std::int64_t age{date >= 0 ? std::max<std::int64_t>(now - date, 0) : 0};
+        if(const std::string* ageHeader{response.FindHeader("age")}; ageHeader != nullptr)
+        {
+            age = std::max(age, ParseSeconds(*ageHeader) * 1000);
+        }
+
+        std::int64_t staleWindow{0};
+        if(!control.noCache && !control.mustRevalidate)
+        {
+            staleWindow = control.staleWhileRevalidate >= 0
+                                  ? control.staleWhileRevalidate * 1000
+                                  : std::chrono::duration_cast<std::chrono::milliseconds>(m_settings.staleWhileRevalidate).count();
+        }
+
+        // Varying on anything else would need one entry per request header value.
+        const std::string* vary{response.FindHeader("vary")};
+        const bool varies{vary != nullptr && ToLower(*vary) != "accept-encoding"};
+
+        Freshness freshness{};
+        freshness.storable = !control.noStore && !varies;
+        freshness.freshUntil = now + lifetime - age;
+        freshness.staleUntil = freshness.freshUntil + staleWindow;
+        return freshness;
+    }
+
+    bool HttpCache::Store(const std::string& key, const HttpClient::Response& response, const std::shared_ptr<const std::string>& body,
+                          const std::int64_t now)
+    {
+        const std::string* etag{response.FindHeader("etag")};
+        const std::string* lastModified{response.FindHeader("last-modified")};
+        const std::string noValidator{};
+        const Freshness freshness{GetFreshness(response, now, lastModified != nullptr ? *lastModified : noValidator)};
+        const bool useful{freshness.staleUntil > now || etag != nullptr || lastModified != nullptr};
+        if(response.status != 200 || !freshness.storable || !useful || body->size() > m_settings.maxEntryBytes)
+        {
+            return false;
+        }
+
+        std::array<char, 64> name{};
+        std::snprintf(name.data(), name.size(), "%016zx-%" PRIx64 "%s",
+                      std::hash<std::string>{}(key), m_fileCounter++, FileSuffix.data());
+
+        Entry& entry{m_index[key]};
+        const std::string replaced{std::exchange(entry.file, name.data())};
+        m_diskBytes -= static_cast<std::size_t>(entry.size);
+        entry.etag = etag != nullptr ? *etag : std::string{};
+        entry.lastModified = lastModified != nullptr ? *lastModified : std::string{};
+        entry.freshUntil = freshness.freshUntil;
+        entry.staleUntil = freshness.staleUntil;
+        entry.size = static_cast<std::int64_t>(body->size());
+        entry.used = now;
+        entry.writing = body;
+        m_diskBytes += body->size();
+        ++m_stats.stored;
+        Remember(key, body);
+
+        // Every body gets a new file: the row switches over once it is
+        // written and the old file goes after that, so a crash never sees a
+        // half-written body. Readers get it from entry.writing until then.
+        auto written{std::make_shared<bool>(false)};
+        const JobSystem::Handle write{m_jobs.Schedule([path = m_settings.directory / entry.file, body, written] {
+            APP_PROFILE_SCOPE("HttpCache::Write");
+            *written = WriteFile(path, *body);
+        })};
+        m_jobs.ScheduleOnMainThread([self = std::weak_ptr<HttpCache*>{m_self}, key, file = entry.file, written, replaced] {
+            if(const auto cache{self.lock()})
+            {
+                (*cache)->OnWritten(key, file, *written, replaced);
+            }
+        }, {write});
+
+        EvictDisk();
+        return true;
+    }
+
+    void HttpCache::OnWritten(const std::string& key, const std::string& file, const bool written, const std::string& replaced)
+    {
+        const auto it{m_index.find(key)};
+        const bool current{it != m_index.end() && it->second.file == file};
+        if(!written)
+        {
+            APP_WARN("Could not write the HTTP cache file {}", file);
+        }
+        if(!written && current)
+        {
+            Remove(key);
+            return;
+        }
+        if(!current)
+        {
+            // Replaced or removed while it was written.
+            m_jobs.Schedule([path = m_settings.directory / file] {
+                std::error_code error{};
+                std::filesystem::remove(path, error);
+            });
+            return;
+        }
+
+        Entry& entry{it->second};
+        entry.writing.reset();
+        m_database.Execute("INSERT OR REPLACE INTO http_cache(url, file, etag, last_modified, fresh_until, stale_until, size, used) "
+                           "VALUES(?, ?, ?, ?, ?, ?, ?, ?)",
+                           {key, entry.file, entry.etag, entry.lastModified, entry.freshUntil, entry.staleUntil, entry.size, entry.used},
+                           [self = std::weak_ptr<HttpCache*>{m_self}, replaced](const Database::Result& result) {
+                               const auto cache{self.lock()};
+                               if(cache == nullptr || replaced.empty() || !result.Succeeded())
+                               {
+                                   return;
+                               }
+                               (*cache)->m_jobs.Schedule([path = (*cache)->m_settings.directory / replaced] {
+                                   std::error_code error{};
+                                   std::filesystem::remove(path, error);
+                               });
+                           });
+    }
+
+    void HttpCache::Renew(const std::string& key, Entry& entry, const HttpClient::Response& response, const std::int64_t now)
+    {
+        // A 304 may update the validators, otherwise the stored ones still hold.
+        if(const std::string* etag{response.FindHeader("etag")}; etag != nullptr)
+        {
+            entry.etag = *etag;
+        }
+        if(const std::string* lastModified{response.FindHeader("last-modified")}; lastModified != nullptr)
+        {
+            entry.lastModified = *lastModified;
+        }
+
+        const Freshness freshness{GetFreshness(response, now, entry.lastModified)};
+        entry.freshUntil = freshness.freshUntil;
+        entry.staleUntil = freshness.staleUntil;
+        entry.used = now;
+        m_database.Execute("UPDATE http_cache SET etag = ?, last_modified = ?, fresh_until = ?, stale_until = ?, used = ? WHERE url = ?",
+                           {entry.etag, entry.lastModified, entry.freshUntil, entry.staleUntil, entry.used, key});
+    }
+
+    void HttpCache::Remove(const std::string& key)
+    {
+        Forget(key);
+
+        const auto it{m_index.find(key)};
+        if(it == m_index.end())
+        {
+            return;
+        }
+
+        m_diskBytes -= static_cast<std::size_t>(it->second.size);
+        m_jobs.Schedule([path = m_settings.directory / it->second.file] {
+            std::error_code error{};
+            std::filesystem::remove(path, error);
+        });
+        m_index.erase(it);
+        m_database.Execute("DELETE FROM http_cache WHERE url = ?", {key});
+    }
+
+    void HttpCache::RemoveUrl(const std::string& url)
+    {
+        std::vector<std::string> keys{};
+        for(const auto& [key, entry]: m_index)
+        {
+            if(key.compare(0, url.size(), url) == 0 && (key.size() == url.size() || key[url.size()] == ' '))
+            {
+                keys.push_back(key);
+            }
+        }
+        for(const std::string& key: keys)
+        {
+            Remove(key);
+        }
+    }
+
+    void HttpCache::EvictDisk()
+    {
+        // A scan per entry evicted, the index holds a few thousand at most.
+        while(m_diskBytes > m_settings.diskBytes && !m_index.empty())
+        {
+            const auto oldest{std::min_element(m_index.begin(), m_index.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.second.used < rhs.second.used;
+            })};
+            ++m_stats.evicted;
+            Remove(std::string{oldest->first});
+        }
+    }
+
+    std::shared_ptr<const std::string> HttpCache::FindInMemory(const std::string& key)
+    {
+        const auto it{m_memoryIndex.find(key)};
+        if(it == m_memoryIndex.end())
+        {
+            return nullptr;
+        }
+        m_memory.splice(m_memory.begin(), m_memory, it->second);
+        return it->second->second;
+    }
+
+    void HttpCache::Remember(const std::string& key, std::shared_ptr<const std::string> body)
+    {
+        Forget(key);
+        if(body->size() > m_settings.memoryBytes)
+        {
+            return;
+        }
+
+        m_memoryBytes += body->size();
+        m_memory.emplace_front(key, std::move(body));
+        m_memoryIndex[key] = m_memory.begin();
+        while(m_memoryBytes > m_settings.memoryBytes)
+        {
+            Forget(std::string{m_memory.back().first});
+        }
+    }
+
+    void HttpCache::Forget(const std::string& key)
+    {
+        const auto it{m_memoryIndex.find(key)};
+        if(it == m_memoryIndex.end())
+        {
+            return;
+        }
+        m_memoryBytes -= it->second->second->size();
+        m_memory.erase(it->second);
+        m_memoryIndex.erase(it);
+    }
+
+}
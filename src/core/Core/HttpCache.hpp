@@ -0,0 +1,204 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Core/Database.hpp"
+#include "Core/HttpClient.hpp"
+#include "Core/JobSystem.hpp"
+
+namespace App {
+
+    // HTTP cache in front of an HttpClient that survives restarts. The
+    // metadata of every entry is a row of the http_cache table, loaded into
+    // an index once, the body a file of its own in the cache directory, and
+    // the most recently used bodies are kept in memory as well. Freshness
+    // follows Cache-Control max-age, else Expires, else a tenth of the time
+    // since Last-Modified. A stale entry is revalidated with If-None-Match
+    // and If-Modified-Since, so an unchanged one costs a 304 without a body.
+    // Within its stale-while-revalidate window the stored copy is served
+    // right away and the revalidation runs behind it. Files are read and
+    // written on the JobSystem. Use it from the UI thread only: callbacks
+    // run from HttpClient::DispatchCompleted() and
+    // JobSystem::DispatchMainThread(), or before Send() returns for a fresh
+    // copy in memory.
+    class HttpCache
+    {
+    public:
+        struct Settings
+        {
+            std::filesystem::path directory{"http_cache"};
+            std::size_t memoryBytes{16 * 1024 * 1024};
+            std::size_t diskBytes{256 * 1024 * 1024};
+            // Larger bodies are passed on without being stored.
+            std::size_t maxEntryBytes{8 * 1024 * 1024};
+            // For responses that do not set their own, must-revalidate and no-cache turn it off.
+            std::chrono::seconds staleWhileRevalidate{std::chrono::hours{24}};
+        };
+
+        enum class Source
+        {
+            Network,
+            Memory,
+            Disk
+        };
+
+        struct Response
+        {
+            long status{0};
+            // Never null, shared with the cache.
+            std::shared_ptr<const std::string> body;
+            // Empty unless the transfer itself failed, HTTP error codes are in status.
+            std::string error;
+            Source source{Source::Network};
+            // Past its freshness, served while a revalidation runs or because it failed.
+            bool stale{false};
+            // From Send() to the callback.
+            std::chrono::microseconds elapsed{};
+
+            [[nodiscard]] bool Succeeded() const
+            {
+                return error.empty() && status >= 200 && status < 300;
+            }
+        };
+
+        // Runs once, or a second time with the new body when a stale copy was
+        // served and the revalidation brought a different one.
+        using Callback = std::function<void(const Response& response)>;
+
+        struct Stats
+        {
+            std::size_t memoryHits{0};
+            std::size_t diskHits{0};
+            // Requests without a stored copy to compare to.
+            std::size_t fetches{0};
+            std::size_t revalidations{0};
+            std::size_t notModified{0};
+            std::size_t staleServed{0};
+            std::size_t stored{0};
+            std::size_t evicted{0};
+        };
+
+        HttpCache(HttpClient& client, Database& database, JobSystem& jobs);
+        HttpCache(HttpClient& client, Database& database, JobSystem& jobs, const Settings& settings);
+        // Callbacks of requests still on their way are dropped.
+        ~HttpCache() = default;
+
+        HttpCache(const HttpCache&) = delete;
+        HttpCache(HttpCache&&) = delete;
+        HttpCache& operator=(HttpCache other) = delete;
+        HttpCache& operator=(HttpCache&& other) = delete;
+
+        // GETs without onData go through the cache, everything else straight
+        // to the network. A successful unsafe method, e.g. a POST, drops what
+        // is stored for its URL. GETs for the same URL with the same Accept,
+        // Accept-Language, Authorization and Cookie headers share one stored
+        // copy and one request on its way, different values of those get
+        // their own. Waits for the index before the first one goes out.
+        void Send(HttpClient::Request request, Callback callback);
+
+        // The index finished loading.
+        [[nodiscard]] bool IsLoaded() const;
+        [[nodiscard]] std::size_t GetEntryCount() const;
+        [[nodiscard]] const Stats& GetStats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            // Relative to the cache directory.
+            std::string file;
+            std::string etag;
+            std::string lastModified;
+            // Milliseconds since the Unix epoch. Served as it is up to
+            // freshUntil, stale while revalidating up to staleUntil.
+            std::int64_t freshUntil{0};
+            std::int64_t staleUntil{0};
+            std::int64_t size{0};
+            std::int64_t used{0};
+            // The body while its file is written, readers get it from here
+            // until then. Not part of the table row.
+            std::shared_ptr<const std::string> writing{};
+        };
+
+        struct Waiter
+        {
+            // As the caller sent it, a fetch after a failed read goes out with its headers and timeout.
+            HttpClient::Request request;
+            // The URL, plus a hash of the headers that change the response when it has any.
+            std::string key;
+            Callback callback;
+            Clock::time_point start{};
+            // The stale body it was given, nullptr while it got nothing yet.
+            std::shared_ptr<const std::string> served{};
+        };
+
+        struct Freshness
+        {
+            bool storable{false};
+            std::int64_t freshUntil{0};
+            std::int64_t staleUntil{0};
+        };
+
+        using MemoryEntry = std::pair<std::string, std::shared_ptr<const std::string>>;
+
+        void Load();
+        void OnLoaded(const Database::Result& result);
+        void Forward(Waiter waiter);
+        void Lookup(Waiter waiter);
+        // Hands the stored body to the waiter from memory or disk. With
+        // revalidate it then sends the waiter's request, in case the body changed.
+        void Serve(Waiter waiter, bool stale, bool revalidate);
+        // Without a body the network is asked instead.
+        void OnRead(Waiter waiter, bool stale, bool revalidate, Source source, std::shared_ptr<const std::string> body);
+        // Joins the request for the waiter's key on its way or sends the
+        // waiter's request, conditional when something is stored.
+        void Fetch(Waiter waiter);
+        // Conditional when the stored copy's validators went with the request.
+        void OnFetched(const std::string& key, bool conditional, const HttpClient::Response& response);
+
+        [[nodiscard]] Freshness GetFreshness(const HttpClient::Response& response, std::int64_t now, const std::string& lastModified) const;
+        bool Store(const std::string& key, const HttpClient::Response& response, const std::shared_ptr<const std::string>& body, std::int64_t now);
+        void OnWritten(const std::string& key, const std::string& file, bool written, const std::string& replaced);
+        // A 304 renews the stored entry with what it says.
+        void Renew(const std::string& key, Entry& entry, const HttpClient::Response& response, std::int64_t now);
+        void Remove(const std::string& key);
+        // Removes the entries of the URL for every value of the varying headers.
+        void RemoveUrl(const std::string& url);
+        void EvictDisk();
+
+        [[nodiscard]] std::shared_ptr<const std::string> FindInMemory(const std::string& key);
+        void Remember(const std::string& key, std::shared_ptr<const std::string> body);
+        void Forget(const std::string& key);
+
+        HttpClient& m_client;
+        Database& m_database;
+        JobSystem& m_jobs;
+        Settings m_settings;
+        // Callbacks and jobs hold it weakly, the cache may be gone when they run.
+        std::shared_ptr<HttpCache*> m_self;
+
+        bool m_loaded{false};
+        std::vector<Waiter> m_queued{};
+        // By Waiter::key, the table's url column holds the same.
+        std::unordered_map<std::string, Entry> m_index{};
+        std::size_t m_diskBytes{0};
+        std::uint64_t m_fileCounter{0};
+        std::unordered_map<std::string, std::vector<Waiter>> m_inFlight{};
+
+        // Most recently used first.
+        std::list<MemoryEntry> m_memory{};
+        std::unordered_map<std::string, std::list<MemoryEntry>::iterator> m_memoryIndex{};
+        std::size_t m_memoryBytes{0};
+
+        Stats m_stats{};
+    };
+
+}
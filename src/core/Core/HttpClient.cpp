@@ -0,0 +1,343 @@
+#include "HttpClient.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <utility>
+#include "Core/Instrumentor.hpp"
+#include "Core/Log.hpp"
+
+namespace App {
+
+    namespace {
+        // Upper bound for one curl_multi_poll, new work interrupts it through curl_multi_wakeup.
+        constexpr int PollTimeoutMs{1000};
+    }
+
+    struct HttpClient::Transfer
+    {
+        RequestId id{0};
+        Request request;
+        Callback callback;
+        Response response;
+        CURL* easy{nullptr};
+        curl_slist* headers{nullptr};
+        std::chrono::steady_clock::time_point start{};
+        std::array<char, CURL_ERROR_SIZE> errorBuffer{};
+
+        ~Transfer()
+        {
+            curl_slist_free_all(headers);
+            curl_easy_cleanup(easy);
+        }
+
+        static std::size_t ReceiveBody(char* data, std::size_t size, std::size_t count, void* userData)
+        {
+            auto* transfer{static_cast<Transfer*>(userData)};
+            const std::size_t length{size * count};
+            if(transfer->request.onData)
+            {
+                // Anything but the full length makes curl fail the transfer with CURLE_WRITE_ERROR.
+                return transfer->request.onData(std::string_view{data, length}) ? length : 0;
+            }
+            transfer->response.body.append(data, length);
+            return length;
+        }
+
+        static std::size_t ReceiveHeader(char* data, std::size_t size, std::size_t count, void* userData)
+        {
+            auto* transfer{static_cast<Transfer*>(userData)};
+            const std::size_t length{size * count};
+            const std::string_view line{data, length};
+            if(line.rfind("HTTP/", 0) == 0)
+            {
+                // A new status line, after a redirect or a 100 Continue.
+                transfer->response.headers.clear();
+                return length;
+            }
+
+            const std::size_t colon{line.find(':')};
+            if(colon == std::string_view::npos)
+            {
+                return length;
+            }
+            std::string name{line.substr(0, colon)};
+            std::transform(name.begin(), name.end(), name.begin(), [](const unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            std::string_view value{line.substr(colon + 1)};
+            while(!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            {
+                value.remove_prefix(1);
+            }
+            while(!value.empty() && (value.back() == '\r' || value.back() == '\n' || value.back() == ' '))
+            {
+                value.remove_suffix(1);
+            }
+            transfer->response.headers.emplace_back(std::move(name), std::string{value});
+            return length;
+        }
+    };
+
+    HttpClient::HttpClient() : HttpClient(Settings{})
+    {
+    }
+
+    HttpClient::HttpClient(const Settings& settings) : m_http2(settings.http2)
+    {
+        APP_PROFILE_FUNCTION();
+
+        // Reference counted by curl, the owner of the first client must be the main thread.
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        m_multi = curl_multi_init();
+        curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, settings.maxConnections);
+        curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, settings.maxConnectionsPerHost);
+
+        m_worker = std::thread{&HttpClient::WorkerLoop, this};
+    }
+
+    HttpClient::~HttpClient()
+    {
+        APP_PROFILE_FUNCTION();
+
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            m_stopRequested = true;
+        }
+        curl_multi_wakeup(m_multi);
+        m_worker.join();
+
+        // Nobody is left to receive these, drop them without their callbacks.
+        for(auto& [id, transfer]: m_running)
+        {
+            curl_multi_remove_handle(m_multi, transfer->easy);
+        }
+        m_running.clear();
+        m_submitted.clear();
+
+        curl_multi_cleanup(m_multi);
+        curl_global_cleanup();
+    }
+
+    HttpClient::RequestId HttpClient::Send(Request request, Callback callback)
+    {
+        APP_PROFILE_FUNCTION();
+
+        auto transfer{std::make_unique<Transfer>()};
+        transfer->request = std::move(request);
+        transfer->callback = std::move(callback);
+
+        RequestId id{0};
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            id = m_nextId++;
+            transfer->id = id;
+            m_submitted.push_back(std::move(transfer));
+            ++m_pendingCount;
+        }
+        curl_multi_wakeup(m_multi);
+
+        return id;
+    }
+
+    void HttpClient::Cancel(const RequestId id)
+    {
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            m_cancelled.push_back(id);
+        }
+        curl_multi_wakeup(m_multi);
+    }
+
+    void HttpClient::DispatchCompleted()
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::vector<Completed> completed;
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            if(m_completed.empty())
+            {
+                return;
+            }
+            completed.swap(m_completed);
+        }
+
+        for(Completed& entry: completed)
+        {
+            if(entry.callback)
+            {
+                entry.callback(entry.response);
+            }
+        }
+    }
+
+    void HttpClient::SetCompletionNotifier(std::function<void()> notifier)
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_completionNotifier = std::move(notifier);
+    }
+
+    std::size_t HttpClient::GetPendingCount() const
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        return m_pendingCount;
+    }
+
+    void HttpClient::WorkerLoop()
+    {
+        std::vector<std::unique_ptr<Transfer>> submitted;
+        std::vector<RequestId> cancelled;
+
+        while(true)
+        {
+            {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_stopRequested)
+                {
+                    break;
+                }
+                submitted.swap(m_submitted);
+                cancelled.swap(m_cancelled);
+            }
+
+            for(std::unique_ptr<Transfer>& transfer: submitted)
+            {
+                StartTransfer(std::move(transfer));
+            }
+            submitted.clear();
+
+            for(const RequestId id: cancelled)
+            {
+                if(const auto it{m_running.find(id)}; it != m_running.end())
+                {
+                    Transfer& transfer{*it->second};
+                    curl_multi_remove_handle(m_multi, transfer.easy);
+                    transfer.response.cancelled = true;
+                    Complete(std::move(transfer.callback), std::move(transfer.response));
+                    m_running.erase(it);
+                }
+            }
+            cancelled.clear();
+
+            {
+                APP_PROFILE_SCOPE("HttpClient::Perform");
+
+                int runningHandles{0};
+                if(const CURLMcode code{curl_multi_perform(m_multi, &runningHandles)}; code != CURLM_OK)
+                {
+                    APP_ERROR("curl_multi_perform failed: {}", curl_multi_strerror(code));
+                }
+
+                int queuedMessages{0};
+                while(const CURLMsg* message{curl_multi_info_read(m_multi, &queuedMessages)})
+                {
+                    if(message->msg == CURLMSG_DONE)
+                    {
+                        FinishTransfer(message->easy_handle, message->data.result);
+                    }
+                }
+            }
+
+            curl_multi_poll(m_multi, nullptr, 0, PollTimeoutMs, nullptr);
+        }
+    }
+
+    void HttpClient::StartTransfer(std::unique_ptr<Transfer> transfer)
+    {
+        APP_PROFILE_FUNCTION();
+
+        const Request& request{transfer->request};
+        CURL* easy{curl_easy_init()};
+        transfer->easy = easy;
+        transfer->start = std::chrono::steady_clock::now();
+
+        curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer->errorBuffer.data());
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(easy, CURLOPT_DEFAULT_PROTOCOL, "https");
+        curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, static_cast<long>(request.timeout.count()));
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &Transfer::ReceiveBody);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &Transfer::ReceiveHeader);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, transfer.get());
+
+        if(m_http2)
+        {
+            curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            // Rather wait for a connection that can multiplex than open another one.
+            curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+        }
+
+        if(request.method == "HEAD")
+        {
+            curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+        }
+        else if(request.method != "GET")
+        {
+            curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+        }
+
+        if(!request.body.empty())
+        {
+            // Not copied by curl, the Transfer owns the body until the handle is gone.
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body.data());
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+        }
+
+        for(const std::string& header: request.headers)
+        {
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        }
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+
+        if(const CURLMcode code{curl_multi_add_handle(m_multi, easy)}; code != CURLM_OK)
+        {
+            transfer->response.error = curl_multi_strerror(code);
+            Complete(std::move(transfer->callback), std::move(transfer->response));
+            return;
+        }
+
+        const RequestId id{transfer->id};
+        m_running.emplace(id, std::move(transfer));
+    }
+
+    void HttpClient::FinishTransfer(CURL* easy, const CURLcode result)
+    {
+        APP_PROFILE_FUNCTION();
+
+        Transfer* transfer{nullptr};
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, &transfer);
+        curl_multi_remove_handle(m_multi, easy);
+
+        Response& response{transfer->response};
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &response.status);
+        response.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - transfer->start);
+        if(result != CURLE_OK)
+        {
+            response.error = transfer->errorBuffer[0] != '\0' ? transfer->errorBuffer.data()
+                                                                : curl_easy_strerror(result);
+        }
+
+        Complete(std::move(transfer->callback), std::move(response));
+        m_running.erase(transfer->id);
+    }
+
+    void HttpClient::Complete(Callback callback, Response response)
+    {
+        // Called under the lock, SetCompletionNotifier() may replace it from another thread.
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_completed.push_back({std::move(callback), std::move(response)});
+        --m_pendingCount;
+        if(m_completionNotifier)
+        {
+            m_completionNotifier();
+        }
+    }
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <curl/curl.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace App {
+
+    // Runs HTTP requests on a worker thread driving one curl multi handle, so
+    // connections are reused and HTTP/2 streams multiplexed across requests.
+    // Callbacks never run on the worker, they are queued until the owner
+    // calls DispatchCompleted(), normally once per frame on the UI thread.
+    class HttpClient
+    {
+    public:
+        using RequestId = std::uint64_t;
+
+        struct Settings
+        {
+            long maxConnections{16};
+            long maxConnectionsPerHost{6};
+            // Negotiated through ALPN on https, plain http stays on HTTP/1.1.
+            bool http2{true};
+        };
+
+        struct Request
+        {
+            std::string method{"GET"};
+            std::string url;
+            std::vector<std::string> headers;
+            std::string body;
+            // Covers the whole transfer, zero waits forever.
+            std::chrono::milliseconds timeout{std::chrono::seconds{30}};
+            // Receives the body chunk by chunk on the worker thread instead of
+            // Response::body, e.g. for a JsonStreamParser. Returning false aborts.
+            std::function<bool(std::string_view chunk)> onData;
+        };
+
+        struct Response
+        {
+            long status{0};
+            // Of the last response after redirects, names in lower case.
+            std::vector<std::pair<std::string, std::string>> headers;
+            std::string body;
+            // Empty unless the transfer itself failed, HTTP error codes are in status.
+            std::string error;
+            bool cancelled{false};
+            std::chrono::microseconds elapsed{};
+
+            [[nodiscard]] bool Succeeded() const
+            {
+                return error.empty() && !cancelled && status >= 200 && status < 300;
+            }
+
+            // The first header of that name, given in lower case, nullptr when missing.
+            [[nodiscard]] const std::string* FindHeader(const std::string_view name) const
+            {
+                for(const auto& [headerName, value]: headers)
+                {
+                    if(headerName == name)
+                    {
+                        return &value;
+                    }
+                }
+                return nullptr;
+            }
+        };
+
+        using Callback = std::function<void(const Response& response)>;
+
+        HttpClient();
+        explicit HttpClient(const Settings& settings);
+        ~HttpClient();
+
+        HttpClient(const HttpClient&) = delete;
+        HttpClient(HttpClient&&) = delete;
+        HttpClient& operator=(HttpClient other) = delete;
+        HttpClient& operator=(HttpClient&& other) = delete;
+
+        // Thread-safe, the callback runs later from DispatchCompleted().
+        RequestId Send(Request request, Callback callback);
+        // Thread-safe, a request that already finished is not affected.
+        void Cancel(RequestId id);
+
+        // Runs the callbacks of finished requests on the calling thread.
+        void DispatchCompleted();
+
+        // Called on the worker thread whenever a response gets queued, e.g. to
+        // wake up an idle main loop. It runs under the client's lock and must
+        // not call back into the client.
+        void SetCompletionNotifier(std::function<void()> notifier);
+
+        [[nodiscard]] std::size_t GetPendingCount() const;
+
+    private:
+        struct Transfer;
+
+        struct Completed
+        {
+            Callback callback;
+            Response response;
+        };
+
+        void WorkerLoop();
+        void StartTransfer(std::unique_ptr<Transfer> transfer);
+        void FinishTransfer(CURL* easy, CURLcode result);
+        void Complete(Callback callback, Response response);
+
+        CURLM* m_multi{nullptr};
+        std::thread m_worker;
+        bool m_stopRequested{false};
+
+        // Shared with the worker thread.
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<Transfer>> m_submitted;
+        std::vector<RequestId> m_cancelled;
+        std::vector<Completed> m_completed;
+        std::size_t m_pendingCount{0};
+        RequestId m_nextId{1};
+        std::function<void()> m_completionNotifier;
+
+        // Worker thread only.
+        std::unordered_map<RequestId, std::unique_ptr<Transfer>> m_running;
+        bool m_http2{true};
+    };
+
+}
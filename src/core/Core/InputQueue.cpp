@@ -0,0 +1,165 @@
+#include "InputQueue.hpp"
+#include <algorithm>
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    namespace {
+        // SDL_PeepEvents takes SDL's queue lock once per batch instead of once
+        // per event, and pumps the platform queue only once per Drain().
+        constexpr std::size_t BatchSize{128};
+
+        bool IsGeometryChange(const SDL_WindowEvent& event)
+        {
+            return event.event == SDL_WINDOWEVENT_MOVED
+                   || event.event == SDL_WINDOWEVENT_RESIZED
+                   || event.event == SDL_WINDOWEVENT_SIZE_CHANGED;
+        }
+    }
+
+    InputQueue::InputQueue() : InputQueue(Settings{}) {}
+
+    InputQueue::InputQueue(const Settings& settings)
+            : m_entries(std::max<std::size_t>(settings.capacity, 1)),
+              m_batch(BatchSize),
+              m_coalesce(settings.coalesce)
+    {
+    }
+
+    bool InputQueue::Drain()
+    {
+        APP_PROFILE_FUNCTION();
+
+        SDL_PumpEvents();
+
+        // SDL stamps events in milliseconds since SDL_Init, one clock read
+        // moves the whole drain onto the steady clock.
+        const Clock::time_point now{Clock::now()};
+        const Uint32 ticks{SDL_GetTicks()};
+
+        while(m_count < m_entries.size())
+        {
+            const auto wanted{static_cast<int>(std::min(BatchSize, m_entries.size() - m_count))};
+            const int received{SDL_PeepEvents(m_batch.data(), wanted, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)};
+            if(received <= 0)
+            {
+                break;
+            }
+
+            for(int i = 0; i < received; ++i)
+            {
+                const SDL_Event& event{m_batch[static_cast<std::size_t>(i)]};
+                const std::size_t before{m_count};
+                Push(event);
+                if(m_count > before)
+                {
+                    // Pushed by another thread since the clock read, e.g. a wake-up.
+                    const Uint32 age{ticks > event.common.timestamp ? ticks - event.common.timestamp : 0};
+                    m_entries[m_count - 1].time = now - std::chrono::milliseconds{age};
+                }
+            }
+            m_stats.polled += static_cast<std::size_t>(received);
+
+            if(received < wanted)
+            {
+                break;
+            }
+        }
+
+        return m_count == m_entries.size();
+    }
+
+    const InputQueue::Stats& InputQueue::GetStats() const
+    {
+        return m_stats;
+    }
+
+    void InputQueue::ResetStats()
+    {
+        m_stats = {};
+    }
+
+    void InputQueue::Push(const SDL_Event& event)
+    {
+        if(m_coalesce && m_count > 0 && Merge(m_entries[m_count - 1], event))
+        {
+            ++m_stats.coalesced;
+            return;
+        }
+
+        m_entries[m_count].event = event;
+        ++m_count;
+    }
+
+    bool InputQueue::Merge(Entry& previous, const SDL_Event& event)
+    {
+        SDL_Event& merged{previous.event};
+        if(merged.type != event.type)
+        {
+            return false;
+        }
+
+        // The merged event keeps the earliest timestamp, the latency counts from there.
+        switch(event.type)
+        {
+        case SDL_MOUSEMOTION:
+            if(merged.motion.windowID != event.motion.windowID
+               || merged.motion.which != event.motion.which
+               || merged.motion.state != event.motion.state)
+            {
+                return false;
+            }
+            merged.motion.x = event.motion.x;
+            merged.motion.y = event.motion.y;
+            merged.motion.xrel += event.motion.xrel;
+            merged.motion.yrel += event.motion.yrel;
+            return true;
+
+        case SDL_MOUSEWHEEL:
+            if(merged.wheel.windowID != event.wheel.windowID
+               || merged.wheel.which != event.wheel.which
+               || merged.wheel.direction != event.wheel.direction)
+            {
+                return false;
+            }
+            merged.wheel.x += event.wheel.x;
+            merged.wheel.y += event.wheel.y;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            merged.wheel.preciseX += event.wheel.preciseX;
+            merged.wheel.preciseY += event.wheel.preciseY;
+#endif
+#if SDL_VERSION_ATLEAST(2, 26, 0)
+            merged.wheel.mouseX = event.wheel.mouseX;
+            merged.wheel.mouseY = event.wheel.mouseY;
+#endif
+            return true;
+
+        case SDL_FINGERMOTION:
+            if(merged.tfinger.touchId != event.tfinger.touchId || merged.tfinger.fingerId != event.tfinger.fingerId)
+            {
+                return false;
+            }
+            merged.tfinger.x = event.tfinger.x;
+            merged.tfinger.y = event.tfinger.y;
+            merged.tfinger.dx += event.tfinger.dx;
+            merged.tfinger.dy += event.tfinger.dy;
+            merged.tfinger.pressure = event.tfinger.pressure;
+            return true;
+
+        case SDL_WINDOWEVENT:
+            if(merged.window.windowID != event.window.windowID
+               || merged.window.event != event.window.event
+               || !IsGeometryChange(event.window))
+            {
+                return false;
+            }
+            merged.window.data1 = event.window.data1;
+            merged.window.data2 = event.window.data2;
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+}
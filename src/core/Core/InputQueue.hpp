@@ -0,0 +1,79 @@
+#pragma once
+#include <SDL.h>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace App {
+
+    // Takes SDL's event queue in batches into a buffer allocated once, folds
+    // events that only cost time to replay into their predecessor and hands
+    // the rest out in one pass. Only directly consecutive events are merged:
+    // motion into motion of the same pointer with the same buttons held,
+    // wheel into wheel, finger motion into motion of the same finger, and a
+    // window's size or position into its next change, so anything with an
+    // order, buttons, keys or text, stays exactly where it was.
+    class InputQueue
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Settings
+        {
+            // Events held per Drain(), a burst beyond it takes more rounds.
+            std::size_t capacity{1024};
+            // Drain() without merging, e.g. to compare against.
+            bool coalesce{true};
+        };
+
+        struct Entry
+        {
+            SDL_Event event;
+            // When the earliest of the merged events happened, on the steady clock.
+            Clock::time_point time;
+        };
+
+        struct Stats
+        {
+            std::size_t polled{0};
+            std::size_t coalesced{0};
+            std::size_t dispatched{0};
+        };
+
+        InputQueue();
+        explicit InputQueue(const Settings& settings);
+
+        // Takes everything SDL has pending, or until the buffer is full.
+        // Returns true when it filled up, Dispatch() and Drain() again then.
+        bool Drain();
+
+        // Calls handler(const Entry&) in order for everything drained and
+        // empties the buffer.
+        template<typename Handler>
+        void Dispatch(Handler&& handler)
+        {
+            for(std::size_t i = 0; i < m_count; ++i)
+            {
+                handler(static_cast<const Entry&>(m_entries[i]));
+            }
+            m_stats.dispatched += m_count;
+            m_count = 0;
+        }
+
+        // Since construction or the last ResetStats().
+        [[nodiscard]] const Stats& GetStats() const;
+        void ResetStats();
+
+    private:
+        void Push(const SDL_Event& event);
+        // Folds event into the previous entry when nothing observable is lost.
+        [[nodiscard]] static bool Merge(Entry& previous, const SDL_Event& event);
+
+        std::vector<Entry> m_entries;
+        std::size_t m_count{0};
+        std::vector<SDL_Event> m_batch;
+        bool m_coalesce{true};
+        Stats m_stats{};
+    };
+
+}
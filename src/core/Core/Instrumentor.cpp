@@ -0,0 +1,469 @@
+#include "Instrumentor.hpp"
+#include <cmath>
+#include <sstream>
+#include <string_view>
+#include "Core/TraceFormat.hpp"
+
+namespace App::Debug {
+
+    namespace {
+        // How long the writer sleeps between two drains of the thread buffers.
+        constexpr std::chrono::milliseconds WriterInterval{10};
+
+        std::int64_t ToNanoseconds(const FloatingPointMicroseconds time)
+        {
+            return std::llround(time.count() * 1000.0);
+        }
+    }
+
+    ThreadEventBuffer::ThreadEventBuffer(const std::thread::id threadId) : m_threadId(threadId)
+    {
+        std::stringstream stream;
+        stream << threadId;
+        m_traceThreadId = stream.str();
+    }
+
+    ThreadEventBuffer::ThreadEventBuffer(std::string trackName) : m_traceThreadId(std::move(trackName))
+    {}
+
+    void ThreadEventBuffer::Discard()
+    {
+        m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    std::uint64_t ThreadEventBuffer::TakeDroppedCount()
+    {
+        return m_dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    std::thread::id ThreadEventBuffer::GetThreadId() const
+    {
+        return m_threadId;
+    }
+
+    const std::string& ThreadEventBuffer::GetTraceThreadId() const
+    {
+        return m_traceThreadId;
+    }
+
+    void ThreadEventBuffer::SetTraceThreadId(std::string traceThreadId)
+    {
+        m_traceThreadId = std::move(traceThreadId);
+    }
+
+    ThreadEventBuffer::State ThreadEventBuffer::GetState() const
+    {
+        return m_state;
+    }
+
+    void ThreadEventBuffer::SetState(const State state)
+    {
+        m_state = state;
+    }
+
+    void ThreadEventBuffer::Reassign(const std::thread::id threadId)
+    {
+        std::stringstream stream;
+        stream << threadId;
+        m_threadId = threadId;
+        m_traceThreadId = stream.str();
+        m_state = State::Owned;
+    }
+
+    Instrumentor::ThreadBufferLease::~ThreadBufferLease()
+    {
+        Instrumentor::Get().ReleaseThread(buffer);
+    }
+
+    Instrumentor::~Instrumentor()
+    {
+        std::lock_guard lock(m_mutex);
+        InternalEndSession();
+        m_sink = nullptr;
+        StopWriter();
+    }
+
+    void Instrumentor::BeginSession(const std::string& name, const std::string& filepath, const SessionFormat format)
+    {
+        std::lock_guard lock(m_mutex);
+
+        if(m_currentSession != nullptr)
+        {
+            // If there is already a current session, then close it before beginning new one.
+            // Subsequent profiling output meant for the original session will end up in the
+            // newly opened session instead.  That's better than having badly formatted
+            // profiling output.
+            APP_ERROR("Instrumentor::begin_session('{0}') when session '{1}' already open.",
+                      name,
+                      m_currentSession->name);
+            InternalEndSession();
+        }
+
+        // A running writer only feeds the sink, hand it everything recorded so far.
+        StopWriter();
+
+        m_outputStream.open(filepath, std::ios::out | std::ios::trunc | std::ios::binary);
+        if(m_outputStream.is_open())
+        {
+            m_droppedEvents.store(0, std::memory_order_relaxed);
+            m_nameIds.clear();
+            m_threadIndices.clear();
+            m_nextThreadIndex = 0;
+
+            m_format = format;
+            m_currentSession = std::make_unique<InstrumentationSession>(name);
+            WriteHeader();
+        }
+        else
+        {
+            APP_ERROR("Instrumentor could not open results file '{0}'.", filepath);
+        }
+
+        if(m_currentSession != nullptr || m_sink != nullptr)
+        {
+            StartWriter();
+        }
+    }
+
+    void Instrumentor::EndSession()
+    {
+        std::lock_guard lock(m_mutex);
+        InternalEndSession();
+    }
+
+    void Instrumentor::AttachSink(ProfileSink* sink)
+    {
+        std::lock_guard lock(m_mutex);
+        StopWriter();
+        m_sink = sink;
+        StartWriter();
+    }
+
+    void Instrumentor::DetachSink(const ProfileSink* sink)
+    {
+        std::lock_guard lock(m_mutex);
+        if(m_sink != sink)
+        {
+            return;
+        }
+
+        StopWriter();
+        m_sink = nullptr;
+        if(m_currentSession != nullptr)
+        {
+            StartWriter();
+        }
+    }
+
+    void Instrumentor::SetCategoryMask(const std::uint32_t mask)
+    {
+        std::lock_guard lock(m_mutex);
+        m_categoryMask.store(mask, std::memory_order_relaxed);
+        if(m_writerThread.joinable())
+        {
+            m_activeCategoryMask.store(mask, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint32_t Instrumentor::GetCategoryMask() const
+    {
+        return m_categoryMask.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t Instrumentor::GetDroppedEventCount() const
+    {
+        return m_droppedEvents.load(std::memory_order_relaxed);
+    }
+
+    std::size_t Instrumentor::GetBufferCount()
+    {
+        std::lock_guard lock(m_buffersMutex);
+        return m_buffers.size();
+    }
+
+    ThreadEventBuffer& Instrumentor::CreateTrack(const std::string& name)
+    {
+        std::lock_guard lock(m_buffersMutex);
+        m_buffers.emplace_back(std::make_unique<ThreadEventBuffer>(name));
+        return *m_buffers.back();
+    }
+
+    void Instrumentor::SetThreadName(const std::string& name)
+    {
+        ThreadEventBuffer& buffer{GetThreadBuffer()};
+        std::lock_guard lock(m_buffersMutex);
+        buffer.SetTraceThreadId(name);
+    }
+
+    const ScopeDescriptor& Instrumentor::CreateDescriptor(const std::string& name, const ProfileCategory category)
+    {
+        std::lock_guard lock(m_descriptorsMutex);
+        const std::string& storedName{m_descriptorNames.emplace_back(name)};
+        return m_descriptors.emplace_back(ScopeDescriptor{storedName.c_str(), "", 0, category});
+    }
+
+    ThreadEventBuffer* Instrumentor::RegisterThread()
+    {
+        std::lock_guard lock(m_buffersMutex);
+        for(const auto& buffer: m_buffers)
+        {
+            if(buffer->GetState() == ThreadEventBuffer::State::Free)
+            {
+                buffer->Reassign(std::this_thread::get_id());
+                return buffer.get();
+            }
+        }
+        m_buffers.emplace_back(std::make_unique<ThreadEventBuffer>(std::this_thread::get_id()));
+        return m_buffers.back().get();
+    }
+
+    void Instrumentor::ReleaseThread(ThreadEventBuffer* buffer)
+    {
+        std::lock_guard lock(m_buffersMutex);
+        if(m_draining)
+        {
+            buffer->SetState(ThreadEventBuffer::State::Released);
+            return;
+        }
+
+        // The lock keeps a writer from starting, nothing else consumes it now.
+        buffer->Discard();
+        [[maybe_unused]] const auto dropped{buffer->TakeDroppedCount()};
+        buffer->SetState(ThreadEventBuffer::State::Free);
+    }
+
+    void Instrumentor::StartWriter()
+    {
+        if(m_writerThread.joinable())
+        {
+            return;
+        }
+
+        // Whatever was pushed while nobody was recording (a thread racing the
+        // flag) is stale.
+        {
+            std::lock_guard lock(m_buffersMutex);
+            for(const auto& buffer: m_buffers)
+            {
+                buffer->Discard();
+                [[maybe_unused]] const auto dropped{buffer->TakeDroppedCount()};
+            }
+            m_draining = true;
+        }
+
+        m_writerStopRequested = false;
+        m_writerThread = std::thread(&Instrumentor::WriterLoop, this);
+        m_activeCategoryMask.store(m_categoryMask.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    void Instrumentor::StopWriter()
+    {
+        if(!m_writerThread.joinable())
+        {
+            return;
+        }
+
+        m_activeCategoryMask.store(0, std::memory_order_release);
+
+        {
+            std::lock_guard lock(m_writerMutex);
+            m_writerStopRequested = true;
+        }
+        m_writerWakeUp.notify_one();
+        m_writerThread.join();
+
+        // The writer is gone, pick up whatever was recorded after its last pass.
+        DrainBuffers();
+
+        std::lock_guard lock(m_buffersMutex);
+        m_draining = false;
+    }
+
+    void Instrumentor::WriterLoop()
+    {
+        std::unique_lock lock(m_writerMutex);
+        while(!m_writerStopRequested)
+        {
+            m_writerWakeUp.wait_for(lock, WriterInterval, [this] { return m_writerStopRequested; });
+
+            lock.unlock();
+            DrainBuffers();
+            lock.lock();
+        }
+    }
+
+    void Instrumentor::DrainBuffers()
+    {
+        m_batch.clear();
+        std::uint64_t droppedInBatch{0};
+        const bool writeFile{m_currentSession != nullptr};
+
+        {
+            std::lock_guard lock(m_buffersMutex);
+            for(const auto& buffer: m_buffers)
+            {
+                m_chunk.clear();
+                const auto count{buffer->Drain([this, writeFile, &buffer](const ProfileResult& result) {
+                    if(writeFile)
+                    {
+                        AppendEvent(*buffer, result);
+                    }
+                    if(m_sink != nullptr)
+                    {
+                        m_sink->OnProfileResult(buffer->GetThreadId(), result);
+                    }
+                })};
+
+                if(writeFile && count > 0 && m_format == SessionFormat::Binary)
+                {
+                    AppendEventsChunk(*buffer, count);
+                }
+                droppedInBatch += buffer->TakeDroppedCount();
+
+                // Its thread is gone and nothing is left, the next thread gets
+                // a trace index of its own.
+                if(buffer->GetState() == ThreadEventBuffer::State::Released)
+                {
+                    buffer->SetState(ThreadEventBuffer::State::Free);
+                    m_threadIndices.erase(buffer.get());
+                }
+            }
+        }
+
+        if(droppedInBatch > 0)
+        {
+            const auto total{m_droppedEvents.fetch_add(droppedInBatch, std::memory_order_relaxed) + droppedInBatch};
+            if(writeFile)
+            {
+                AppendDroppedCounter(total);
+            }
+        }
+
+        if(!m_batch.empty())
+        {
+            m_outputStream.write(m_batch.data(), static_cast<std::streamsize>(m_batch.size()));
+        }
+    }
+
+    void Instrumentor::AppendEvent(const ThreadEventBuffer& buffer, const ProfileResult& result)
+    {
+        if(m_format == SessionFormat::ChromeJson)
+        {
+            TraceFormat::AppendChromeEvent(m_batch,
+                                           result.descriptor->name,
+                                           GetCategoryName(result.descriptor->category),
+                                           result.elapsedTime.count(),
+                                           buffer.GetTraceThreadId(),
+                                           result.start.count());
+            return;
+        }
+
+        const auto [it, inserted]{m_nameIds.try_emplace(result.descriptor, m_nameIds.size())};
+        if(inserted)
+        {
+            m_batch.push_back(static_cast<char>(TraceFormat::ChunkType::Name));
+            TraceFormat::AppendVarint(m_batch, it->second);
+            TraceFormat::AppendString(m_batch, result.descriptor->name);
+            TraceFormat::AppendString(m_batch, GetCategoryName(result.descriptor->category));
+        }
+
+        const auto start{ToNanoseconds(result.start)};
+        if(m_chunk.empty())
+        {
+            // The first event carries the chunk base, every following start is a delta.
+            TraceFormat::AppendVarint(m_chunk, static_cast<std::uint64_t>(start));
+            m_chunkPreviousStart = start;
+        }
+        TraceFormat::AppendVarint(m_chunk, it->second);
+        TraceFormat::AppendZigZag(m_chunk, start - m_chunkPreviousStart);
+        TraceFormat::AppendVarint(m_chunk, static_cast<std::uint64_t>(result.elapsedTime.count()));
+        m_chunkPreviousStart = start;
+    }
+
+    void Instrumentor::AppendEventsChunk(const ThreadEventBuffer& buffer, const std::size_t count)
+    {
+        using TraceFormat::ChunkType;
+
+        // Counted on its own, entries of exited threads are erased from the map.
+        const auto [it, inserted]{m_threadIndices.try_emplace(&buffer, m_nextThreadIndex)};
+        if(inserted)
+        {
+            ++m_nextThreadIndex;
+            m_batch.push_back(static_cast<char>(ChunkType::Thread));
+            TraceFormat::AppendVarint(m_batch, it->second);
+            TraceFormat::AppendString(m_batch, buffer.GetTraceThreadId());
+        }
+
+        m_batch.push_back(static_cast<char>(ChunkType::Events));
+        TraceFormat::AppendVarint(m_batch, it->second);
+        TraceFormat::AppendVarint(m_batch, count);
+        m_batch.append(m_chunk);
+    }
+
+    void Instrumentor::AppendDroppedCounter(const std::uint64_t total)
+    {
+        const auto now{FloatingPointMicroseconds{std::chrono::steady_clock::now().time_since_epoch()}};
+        if(m_format == SessionFormat::Binary)
+        {
+            m_batch.push_back(static_cast<char>(TraceFormat::ChunkType::Counter));
+            TraceFormat::AppendVarint(m_batch, static_cast<std::uint64_t>(ToNanoseconds(now)));
+            TraceFormat::AppendVarint(m_batch, total);
+        }
+        else
+        {
+            TraceFormat::AppendChromeDroppedCounter(m_batch, now.count(), total);
+        }
+    }
+
+    void Instrumentor::WriteHeader()
+    {
+        if(m_format == SessionFormat::Binary)
+        {
+            std::string header{TraceFormat::Magic};
+            TraceFormat::AppendVarint(header, TraceFormat::Version);
+            m_outputStream << header;
+        }
+        else
+        {
+            m_outputStream << TraceFormat::ChromeHeader;
+        }
+        m_outputStream.flush();
+    }
+
+    void Instrumentor::WriteFooter()
+    {
+        if(m_format == SessionFormat::ChromeJson)
+        {
+            m_outputStream << TraceFormat::ChromeFooter;
+        }
+        m_outputStream.flush();
+    }
+
+    void Instrumentor::InternalEndSession()
+    {
+        if(m_currentSession == nullptr)
+        {
+            return;
+        }
+
+        StopWriter();
+
+        const auto dropped{m_droppedEvents.load(std::memory_order_relaxed)};
+        if(dropped > 0)
+        {
+            APP_WARN("Instrumentor session '{0}' dropped {1} events, thread buffers were full.",
+                     m_currentSession->name,
+                     dropped);
+        }
+
+        WriteFooter();
+        m_outputStream.close();
+        m_currentSession.reset();
+
+        if(m_sink != nullptr)
+        {
+            StartWriter();
+        }
+    }
+
+}
\ No newline at end of file
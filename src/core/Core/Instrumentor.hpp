@@ -1,24 +1,82 @@
 #pragma once
-#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <fstream>
-#include <iomanip>
-#include <sstream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "Core/Log.hpp"
 
 namespace App::Debug {
 
     using FloatingPointMicroseconds = std::chrono::duration<double, std::micro>;
 
+    // Bit flags, see Instrumentor::SetCategoryMask().
+    enum class ProfileCategory : std::uint32_t
+    {
+        Function = 1U << 0U,
+        Scope = 1U << 1U,
+        // Scopes entered many times per frame, e.g. once per event or item.
+        Hot = 1U << 2U,
+        // GPU-side durations measured by the GpuProfiler.
+        Gpu = 1U << 3U
+    };
+
+    constexpr std::uint32_t AllProfileCategories{0xFFFFFFFFU};
+
+    constexpr std::uint32_t ToMask(const ProfileCategory category)
+    {
+        return static_cast<std::uint32_t>(category);
+    }
+
+    // The "cat" of its events in a Chrome trace.
+    constexpr const char* GetCategoryName(const ProfileCategory category)
+    {
+        switch(category)
+        {
+        case ProfileCategory::Function:
+            return "function";
+        case ProfileCategory::Scope:
+            return "scope";
+        case ProfileCategory::Hot:
+            return "hot";
+        case ProfileCategory::Gpu:
+            return "gpu";
+        }
+        return "function";
+    }
+
+    // One per profiled scope, built at compile time by the APP_PROFILE_* macros
+    // and referenced by pointer so entering a scope never allocates.
+    struct ScopeDescriptor
+    {
+        const char* name;
+        const char* file;
+        std::uint32_t line;
+        ProfileCategory category;
+    };
+
     struct ProfileResult
     {
-        std::string name;
-        FloatingPointMicroseconds start;
-        std::chrono::microseconds elapsedTime;
-        std::thread::id threadOd;
+        const ScopeDescriptor* descriptor{nullptr};
+        FloatingPointMicroseconds start{};
+        std::chrono::microseconds elapsedTime{};
+    };
+
+    enum class SessionFormat
+    {
+        // Chrome trace JSON, loadable in chrome://tracing or Perfetto as is.
+        ChromeJson,
+        // Compact Core/TraceFormat.hpp stream, turn it into Chrome JSON with trace-convert.
+        Binary
     };
 
     struct InstrumentationSession
@@ -28,74 +86,158 @@ namespace App::Debug {
         {}
     };
 
-    class Instrumentor
+    // Single-producer/single-consumer ring. The owning thread pushes, the
+    // Instrumentor writer thread drains. A full ring drops the new event and
+    // counts it instead of blocking the profiled thread.
+    class ThreadEventBuffer
     {
     public:
-        Instrumentor(const Instrumentor&) = delete;
-        Instrumentor(Instrumentor&&) = delete;
-        Instrumentor& operator=(Instrumentor other) = delete;
-        Instrumentor& operator=(Instrumentor&& other) = delete;
+        static constexpr std::size_t Capacity{4096};
 
-        void BeginSession(const std::string& name, const std::string& filepath = "results.json")
+        enum class State
         {
-            std::lock_guard lock(m_mutex);
+            Owned,
+            // Its thread exited, the events it left are still to be drained.
+            Released,
+            // Drained, the next new thread takes it over.
+            Free
+        };
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
 
-            if(m_currentSession != nullptr)
-            {
-                // If there is already a current session, then close it before beginning new one.
-                // Subsequent profiling output meant for the original session will end up in the
-                // newly opened session instead.  That's better than having badly formatted
-                // profiling output.
-                APP_ERROR("Instrumentor::begin_session('{0}') when session '{1}' already open.",
-                          name,
-                          m_currentSession->name);
-                InternalEndSession();
-            }
-            m_outputStream.open(filepath);
+        explicit ThreadEventBuffer(std::thread::id threadId);
+        // A track that is not a thread, e.g. the GPU. Whoever owns it is its only producer.
+        explicit ThreadEventBuffer(std::string trackName);
+
+        ThreadEventBuffer(const ThreadEventBuffer&) = delete;
+        ThreadEventBuffer(ThreadEventBuffer&&) = delete;
+        ThreadEventBuffer& operator=(ThreadEventBuffer other) = delete;
+        ThreadEventBuffer& operator=(ThreadEventBuffer&& other) = delete;
 
-            if(m_outputStream.is_open())
+        void Push(const ProfileResult& result)
+        {
+            const std::size_t head{m_head.load(std::memory_order_relaxed)};
+            if(head - m_tail.load(std::memory_order_acquire) == Capacity)
             {
-                m_currentSession = std::make_unique<InstrumentationSession>(name);
-                WriteHeader();
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
             }
-            else
+
+            m_events[head & (Capacity - 1)] = result;
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+        // Consumer side only.
+        template<typename Consumer>
+        std::size_t Drain(Consumer&& consumer)
+        {
+            const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+            const std::size_t head{m_head.load(std::memory_order_acquire)};
+            for(std::size_t i = tail; i != head; ++i)
             {
-                APP_ERROR("Instrumentor could not open results file '{0}'.", filepath);
+                consumer(m_events[i & (Capacity - 1)]);
             }
+            m_tail.store(head, std::memory_order_release);
+            return head - tail;
         }
 
-        void EndSession()
+        // Consumer side only.
+        void Discard();
+
+        [[nodiscard]] std::uint64_t TakeDroppedCount();
+        [[nodiscard]] std::thread::id GetThreadId() const;
+        // The thread id as written to the "tid" of a trace.
+        [[nodiscard]] const std::string& GetTraceThreadId() const;
+        // With the Instrumentor's buffer list locked, the writer reads it under the same lock.
+        void SetTraceThreadId(std::string traceThreadId);
+
+        // State and takeover, with the Instrumentor's buffer list locked.
+        [[nodiscard]] State GetState() const;
+        void SetState(State state);
+        // Hands a Free, drained buffer to another thread.
+        void Reassign(std::thread::id threadId);
+
+    private:
+        alignas(64) std::atomic<std::size_t> m_head{0};
+        alignas(64) std::atomic<std::size_t> m_tail{0};
+        alignas(64) std::atomic<std::uint64_t> m_dropped{0};
+        std::thread::id m_threadId;
+        std::string m_traceThreadId;
+        State m_state{State::Owned};
+        std::array<ProfileResult, Capacity> m_events{};
+    };
+
+    // Receives every recorded event on the Instrumentor writer thread, with or
+    // without a session file being written at the same time.
+    class ProfileSink
+    {
+    public:
+        ProfileSink() = default;
+        virtual ~ProfileSink() = default;
+
+        ProfileSink(const ProfileSink&) = delete;
+        ProfileSink(ProfileSink&&) = delete;
+        ProfileSink& operator=(ProfileSink other) = delete;
+        ProfileSink& operator=(ProfileSink&& other) = delete;
+
+        virtual void OnProfileResult(std::thread::id threadId, const ProfileResult& result) = 0;
+    };
+
+    class Instrumentor
+    {
+    public:
+        Instrumentor(const Instrumentor&) = delete;
+        Instrumentor(Instrumentor&&) = delete;
+        Instrumentor& operator=(Instrumentor other) = delete;
+        Instrumentor& operator=(Instrumentor&& other) = delete;
+
+        void BeginSession(const std::string& name,
+                          const std::string& filepath = "results.json",
+                          SessionFormat format = SessionFormat::ChromeJson);
+        void EndSession();
+
+        // Only one sink at a time. Events are recorded while a session or a sink is attached.
+        void AttachSink(ProfileSink* sink);
+        void DetachSink(const ProfileSink* sink);
+
+        // Categories outside the mask are skipped before their scope even reads the clock.
+        void SetCategoryMask(std::uint32_t mask);
+        [[nodiscard]] std::uint32_t GetCategoryMask() const;
+
+        [[nodiscard]] bool IsCategoryActive(const ProfileCategory category) const
         {
-            std::lock_guard lock(m_mutex);
-            InternalEndSession();
+            return (m_activeCategoryMask.load(std::memory_order_relaxed) & ToMask(category)) != 0;
         }
 
         void WriteProfile(const ProfileResult& result)
         {
-            std::stringstream json;
-
-            std::string name{result.name};
-            std::replace(name.begin(), name.end(), '"', '\'');
-
-            json << std::setprecision(3) << std::fixed;
-            json << ",{";
-            json << R"("cat":"function",)";
-            json << "\"dur\":" << (result.elapsedTime.count()) << ',';
-            json << R"("name":")" << name << "\",";
-            json << R"("ph":"X",)";
-            json << "\"pid\":0,";
-            json << R"("tid":")" << result.threadOd << "\",";
-            json << "\"ts\":" << result.start.count();
-            json << "}";
-
-            std::lock_guard lock(m_mutex);
-            if(m_currentSession != nullptr)
+            WriteProfile(GetThreadBuffer(), result);
+        }
+
+        void WriteProfile(ThreadEventBuffer& track, const ProfileResult& result)
+        {
+            if(m_activeCategoryMask.load(std::memory_order_relaxed) != 0)
             {
-                m_outputStream << json.str();
-                m_outputStream.flush();
+                track.Push(result);
             }
         }
 
+        // Shows up next to the thread tracks in the trace, lives as long as the Instrumentor.
+        ThreadEventBuffer& CreateTrack(const std::string& name);
+
+        // Names the calling thread's track instead of its id, e.g. "Job worker 2".
+        // Call it before the thread records anything, a binary trace keeps the
+        // name its first events were written under.
+        void SetThreadName(const std::string& name);
+
+        // For scope names only known at run time, e.g. startup tasks. Lives as
+        // long as the Instrumentor, create one per name rather than per event.
+        const ScopeDescriptor& CreateDescriptor(const std::string& name, ProfileCategory category);
+
+        // Events lost because a thread produced them faster than the writer drained them.
+        [[nodiscard]] std::uint64_t GetDroppedEventCount() const;
+        // Thread buffers and tracks allocated so far, those of exited threads are reused.
+        [[nodiscard]] std::size_t GetBufferCount();
+
         static Instrumentor& Get()
         {
             static Instrumentor instance;
@@ -103,49 +245,101 @@ namespace App::Debug {
         }
 
     private:
-        Instrumentor() : m_currentSession(nullptr)
-        {}
+        Instrumentor() = default;
+        ~Instrumentor();
 
-        ~Instrumentor()
+        // Hands the thread's buffer back when the thread exits, so short-lived
+        // threads do not leave one behind each.
+        struct ThreadBufferLease
         {
-            EndSession();
-        }
+            ThreadEventBuffer* buffer;
 
-        void WriteHeader()
-        {
-            m_outputStream << R"({"otherData": {},"traceEvents":[{})";
-            m_outputStream.flush();
-        }
+            explicit ThreadBufferLease(ThreadEventBuffer* leased) : buffer(leased)
+            {}
+            ~ThreadBufferLease();
+
+            ThreadBufferLease(const ThreadBufferLease&) = delete;
+            ThreadBufferLease(ThreadBufferLease&&) = delete;
+            ThreadBufferLease& operator=(ThreadBufferLease other) = delete;
+            ThreadBufferLease& operator=(ThreadBufferLease&& other) = delete;
+        };
 
-        void WriteFooter()
+        ThreadEventBuffer& GetThreadBuffer()
         {
-            m_outputStream << "]}";
-            m_outputStream.flush();
+            thread_local ThreadBufferLease lease{RegisterThread()};
+            return *lease.buffer;
         }
 
-        // Note: you must already own lock on m_Mutex before
+        // Takes over a Free buffer before it creates one.
+        ThreadEventBuffer* RegisterThread();
+        // The writer drains what is left before the buffer is reused.
+        void ReleaseThread(ThreadEventBuffer* buffer);
+
+        // Session state and the sink only change while the writer is stopped.
+        // Both must be called with m_mutex held.
+        void StartWriter();
+        void StopWriter();
+
+        void WriterLoop();
+        void DrainBuffers();
+        void AppendEvent(const ThreadEventBuffer& buffer, const ProfileResult& result);
+        void AppendEventsChunk(const ThreadEventBuffer& buffer, std::size_t count);
+        void AppendDroppedCounter(std::uint64_t total);
+
+        void WriteHeader();
+        void WriteFooter();
+
+        // Note: you must already own lock on m_mutex before
         // calling InternalEndSession()
-        void InternalEndSession()
-        {
-            if(m_currentSession != nullptr)
-            {
-                WriteFooter();
-                m_outputStream.close();
-            }
-        }
+        void InternalEndSession();
 
         std::mutex m_mutex;
         std::unique_ptr<InstrumentationSession> m_currentSession;
         std::ofstream m_outputStream;
+        SessionFormat m_format{SessionFormat::ChromeJson};
+        ProfileSink* m_sink{nullptr};
+        std::atomic<std::uint32_t> m_categoryMask{AllProfileCategories};
+        // m_categoryMask while recording, zero otherwise.
+        std::atomic<std::uint32_t> m_activeCategoryMask{0};
+
+        std::mutex m_buffersMutex;
+        std::vector<std::unique_ptr<ThreadEventBuffer>> m_buffers;
+        // Under m_buffersMutex. While the writer is stopped nobody drains, a
+        // released buffer is discarded and freed right away.
+        bool m_draining{false};
+
+        std::mutex m_descriptorsMutex;
+        // Deques keep the addresses handed out stable.
+        std::deque<std::string> m_descriptorNames;
+        std::deque<ScopeDescriptor> m_descriptors;
+
+        std::thread m_writerThread;
+        std::mutex m_writerMutex;
+        std::condition_variable m_writerWakeUp;
+        bool m_writerStopRequested{false};
+        std::string m_batch;
+        std::atomic<std::uint64_t> m_droppedEvents{0};
+
+        // Binary sessions only, owned by the writer thread.
+        std::string m_chunk;
+        std::int64_t m_chunkPreviousStart{0};
+        std::unordered_map<const ScopeDescriptor*, std::uint64_t> m_nameIds;
+        std::unordered_map<const ThreadEventBuffer*, std::uint64_t> m_threadIndices;
+        std::uint64_t m_nextThreadIndex{0};
     };
 
     class InstrumentationTimer
     {
     public:
-        explicit InstrumentationTimer(std::string name)
-                : m_name(std::move(name)),
-                  m_startTimePoint(std::chrono::steady_clock::now())
-        {}
+        explicit InstrumentationTimer(const ScopeDescriptor& descriptor)
+                : m_descriptor(descriptor),
+                  m_stopped(!Instrumentor::Get().IsCategoryActive(descriptor.category))
+        {
+            if(!m_stopped)
+            {
+                m_startTimePoint = std::chrono::steady_clock::now();
+            }
+        }
 
         InstrumentationTimer(const InstrumentationTimer&) = delete;
         InstrumentationTimer(InstrumentationTimer&&) = delete;
@@ -169,16 +363,15 @@ namespace App::Debug {
                     - std::chrono::time_point_cast<std::chrono::microseconds>(m_startTimePoint).time_since_epoch()
             };
 
-            Instrumentor::Get().WriteProfile(
-                    {m_name, highResStart, elapsedTime, std::this_thread::get_id()});
+            Instrumentor::Get().WriteProfile({&m_descriptor, highResStart, elapsedTime});
 
             m_stopped = true;
         }
 
     private:
-        const std::string m_name;
-        bool m_stopped{false};
-        const std::chrono::time_point<std::chrono::steady_clock> m_startTimePoint;
+        const ScopeDescriptor& m_descriptor;
+        bool m_stopped;
+        std::chrono::time_point<std::chrono::steady_clock> m_startTimePoint{};
     };
 
 }
@@ -214,16 +407,26 @@ namespace App::Debug {
 #define APP_PROFILE_BEGIN_SESSION(name) ::App::Debug::Instrumentor::Get().BeginSession(name)
 #define APP_PROFILE_BEGIN_SESSION_WITH_FILE(name, filePath) \
   ::App::Debug::Instrumentor::Get().BeginSession(name, filePath)
+#define APP_PROFILE_BEGIN_SESSION_WITH_FORMAT(name, filePath, format) \
+  ::App::Debug::Instrumentor::Get().BeginSession(name, filePath, format)
 #define APP_PROFILE_END_SESSION() ::App::Debug::Instrumentor::Get().EndSession()
-#define APP_PROFILE_SCOPE(name)                                    \
-  const ::App::Debug::InstrumentationTimer JOIN(timer, __LINE__) { \
-    name                                                           \
+#define APP_PROFILE_SCOPE_CATEGORY(name, category)                                  \
+  static constexpr ::App::Debug::ScopeDescriptor JOIN(scopeDescriptor, __LINE__){ \
+    name, __FILE__, __LINE__, ::App::Debug::ProfileCategory::category           \
+  };                                                                              \
+  const ::App::Debug::InstrumentationTimer JOIN(timer, __LINE__) {                \
+    JOIN(scopeDescriptor, __LINE__)                                               \
   }
-#define APP_PROFILE_FUNCTION() APP_PROFILE_SCOPE(APP_FUNC_SIG)
+#define APP_PROFILE_SCOPE(name) APP_PROFILE_SCOPE_CATEGORY(name, Scope)
+#define APP_PROFILE_FUNCTION() APP_PROFILE_SCOPE_CATEGORY(APP_FUNC_SIG, Function)
+#define APP_PROFILE_THREAD(name) ::App::Debug::Instrumentor::Get().SetThreadName(name)
 #else
 #define APP_PROFILE_BEGIN_SESSION(name)
 #define APP_PROFILE_BEGIN_SESSION_WITH_FILE(name, filePath)
+#define APP_PROFILE_BEGIN_SESSION_WITH_FORMAT(name, filePath, format)
 #define APP_PROFILE_END_SESSION()
+#define APP_PROFILE_SCOPE_CATEGORY(name, category)
 #define APP_PROFILE_SCOPE(name)
 #define APP_PROFILE_FUNCTION()
+#define APP_PROFILE_THREAD(name)
 #endif
@@ -0,0 +1,414 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <string>
+#include <utility>
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    namespace {
+        // Which queue the calling thread owns, if it is a worker of that system.
+        struct WorkerIdentity
+        {
+            const JobSystem* system{nullptr};
+            std::size_t index{0};
+        };
+
+        thread_local WorkerIdentity t_worker{};
+
+        // Enough chunks per thread that one running long is made up by the others.
+        constexpr std::size_t ChunksPerThread{4};
+    }
+
+    bool JobSystem::Handle::IsValid() const
+    {
+        return m_job != nullptr;
+    }
+
+    bool JobSystem::Handle::IsDone() const
+    {
+        return m_job != nullptr && m_job->done.load(std::memory_order_acquire);
+    }
+
+    JobSystem::Handle::Handle(std::shared_ptr<Job> job) : m_job(std::move(job)) {}
+
+    JobSystem::JobSystem() : JobSystem(Settings{}) {}
+
+    JobSystem::JobSystem(const Settings& settings) : m_workerCount(settings.workerCount)
+    {
+        APP_PROFILE_FUNCTION();
+
+        if(m_workerCount == 0)
+        {
+            const std::size_t cores{std::thread::hardware_concurrency()};
+            m_workerCount = cores > 1 ? cores - 1 : 1;
+        }
+
+        for(std::size_t i = 0; i <= m_workerCount; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for(std::size_t i = 0; i < m_workerCount; ++i)
+        {
+            m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        APP_PROFILE_FUNCTION();
+
+        {
+            const std::lock_guard<std::mutex> lock{m_sleepMutex};
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+        m_jobFinished.notify_all();
+
+        for(std::thread& worker: m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    JobSystem::Handle JobSystem::Schedule(std::function<void()> work, const std::vector<Handle>& dependencies)
+    {
+        return Schedule(Affinity::Worker, std::move(work), dependencies);
+    }
+
+    JobSystem::Handle JobSystem::ScheduleOnMainThread(std::function<void()> work, const std::vector<Handle>& dependencies)
+    {
+        return Schedule(Affinity::MainThread, std::move(work), dependencies);
+    }
+
+    JobSystem::Handle JobSystem::Schedule(const Affinity affinity,
+                                          std::function<void()> work,
+                                          const std::vector<Handle>& dependencies)
+    {
+        auto job{std::make_shared<Job>()};
+        job->work = std::move(work);
+        job->affinity = affinity;
+
+        for(const Handle& dependency: dependencies)
+        {
+            if(!dependency.m_job)
+            {
+                continue;
+            }
+
+            Job& other{*dependency.m_job};
+            const std::lock_guard<std::mutex> lock{other.mutex};
+            if(!other.finished)
+            {
+                job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+                other.dependents.push_back(job);
+            }
+        }
+
+        Handle handle{job};
+        // Drops the hold taken at construction, dependencies may have finished meanwhile.
+        if(job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Enqueue(std::move(job));
+        }
+        return handle;
+    }
+
+    void JobSystem::Wait(const Handle& handle)
+    {
+        APP_PROFILE_FUNCTION();
+
+        if(!handle.m_job)
+        {
+            return;
+        }
+
+        const Job& job{*handle.m_job};
+        const std::size_t index{t_worker.system == this ? t_worker.index : m_workerCount};
+        while(!job.done.load(std::memory_order_acquire))
+        {
+            if(const std::shared_ptr<Job> other{TakeJob(index)})
+            {
+                Execute(*other);
+                continue;
+            }
+
+            ++m_waiterCount;
+            std::unique_lock<std::mutex> lock{m_sleepMutex};
+            m_jobFinished.wait(lock, [this, &job] {
+                return m_stopping || job.done.load(std::memory_order_acquire) || m_queuedCount.load() > 0;
+            });
+            --m_waiterCount;
+
+            // Dropped with the rest of the queue.
+            if(m_stopping && !job.done.load(std::memory_order_acquire))
+            {
+                return;
+            }
+        }
+
+        if(job.error)
+        {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+    void JobSystem::ParallelFor(const std::size_t count,
+                                std::size_t grain,
+                                const std::function<void(std::size_t begin, std::size_t end)>& body)
+    {
+        APP_PROFILE_FUNCTION();
+
+        if(count == 0)
+        {
+            return;
+        }
+        if(grain == 0)
+        {
+            grain = std::max<std::size_t>(count / ((m_workerCount + 1) * ChunksPerThread), 1);
+        }
+
+        // Every thread claims the next chunk when done with its last, so a
+        // slow chunk does not hold up the ones behind it.
+        const std::size_t chunks{(count + grain - 1) / grain};
+        std::atomic<std::size_t> nextChunk{0};
+        const auto runChunks{[&] {
+            try
+            {
+                for(std::size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunks;
+                    chunk = nextChunk.fetch_add(1, std::memory_order_relaxed))
+                {
+                    const std::size_t begin{chunk * grain};
+                    body(begin, std::min(count, begin + grain));
+                }
+            }
+            catch(...)
+            {
+                nextChunk.store(chunks, std::memory_order_relaxed);
+                throw;
+            }
+        }};
+
+        const std::size_t helperCount{std::min(m_workerCount, chunks - 1)};
+        std::vector<Handle> helpers{};
+        helpers.reserve(helperCount);
+        for(std::size_t i = 0; i < helperCount; ++i)
+        {
+            helpers.push_back(Schedule(runChunks));
+        }
+
+        std::exception_ptr error{};
+        try
+        {
+            runChunks();
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+
+        // The helpers reference this frame, wait for all of them even after an error.
+        for(const Handle& helper: helpers)
+        {
+            try
+            {
+                Wait(helper);
+            }
+            catch(...)
+            {
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void JobSystem::DispatchMainThread()
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::exception_ptr error{};
+        while(true)
+        {
+            // One at a time, swapping the queue out would allocate every frame.
+            std::shared_ptr<Job> job{};
+            {
+                const std::lock_guard<std::mutex> lock{m_mainMutex};
+                if(m_mainQueue.empty())
+                {
+                    break;
+                }
+                job = std::move(m_mainQueue.front());
+                m_mainQueue.pop_front();
+            }
+
+            Execute(*job);
+            if(job->error && !error)
+            {
+                error = job->error;
+            }
+        }
+
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void JobSystem::SetMainThreadNotifier(std::function<void()> notifier)
+    {
+        const std::lock_guard<std::mutex> lock{m_mainMutex};
+        m_mainThreadNotifier = std::move(notifier);
+    }
+
+    std::size_t JobSystem::GetWorkerCount() const
+    {
+        return m_workerCount;
+    }
+
+    void JobSystem::WorkerLoop(const std::size_t index)
+    {
+        t_worker = {this, index};
+        APP_PROFILE_THREAD("Job worker " + std::to_string(index + 1));
+
+        while(true)
+        {
+            if(const std::shared_ptr<Job> job{TakeJob(index)})
+            {
+                Execute(*job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{m_sleepMutex};
+            m_workAvailable.wait(lock, [this] { return m_stopping || m_queuedCount.load() > 0; });
+            if(m_stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    std::shared_ptr<JobSystem::Job> JobSystem::TakeJob(const std::size_t index)
+    {
+        std::shared_ptr<Job> job{};
+        {
+            // Newest first, whatever it needs was most likely just touched.
+            WorkerQueue& own{*m_queues[index]};
+            const std::lock_guard<std::mutex> lock{own.mutex};
+            if(!own.jobs.empty())
+            {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+            }
+        }
+
+        // The shared queue first, then the workers after this one in turn.
+        for(std::size_t offset = 0; !job && offset <= m_workerCount; ++offset)
+        {
+            const std::size_t victim{offset == 0 ? m_workerCount : (index + offset) % m_workerCount};
+            if(victim == index)
+            {
+                continue;
+            }
+
+            // Oldest first, the other end from where its owner works.
+            WorkerQueue& queue{*m_queues[victim]};
+            const std::lock_guard<std::mutex> lock{queue.mutex};
+            if(!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+        }
+
+        if(job)
+        {
+            m_queuedCount.fetch_sub(1);
+        }
+        return job;
+    }
+
+    void JobSystem::Enqueue(std::shared_ptr<Job> job)
+    {
+        if(job->affinity == Affinity::MainThread)
+        {
+            const std::lock_guard<std::mutex> lock{m_mainMutex};
+            m_mainQueue.push_back(std::move(job));
+            if(m_mainThreadNotifier)
+            {
+                m_mainThreadNotifier();
+            }
+            return;
+        }
+
+        // Counted before it is visible, a thief never takes the count below zero.
+        m_queuedCount.fetch_add(1);
+        {
+            WorkerQueue& queue{*m_queues[t_worker.system == this ? t_worker.index : m_workerCount]};
+            const std::lock_guard<std::mutex> lock{queue.mutex};
+            queue.jobs.push_back(std::move(job));
+        }
+
+        // Taking the lock orders the push before a sleeper's check of the count.
+        {
+            const std::lock_guard<std::mutex> lock{m_sleepMutex};
+        }
+        m_workAvailable.notify_one();
+        if(m_waiterCount.load() > 0)
+        {
+            m_jobFinished.notify_all();
+        }
+    }
+
+    void JobSystem::Execute(Job& job)
+    {
+        {
+            APP_PROFILE_SCOPE("Job");
+            try
+            {
+                job.work();
+            }
+            catch(...)
+            {
+                job.error = std::current_exception();
+            }
+        }
+        job.work = nullptr;
+
+        Finish(job);
+    }
+
+    void JobSystem::Finish(Job& job)
+    {
+        std::vector<std::shared_ptr<Job>> dependents{};
+        {
+            const std::lock_guard<std::mutex> lock{job.mutex};
+            job.finished = true;
+            dependents.swap(job.dependents);
+        }
+        job.done.store(true, std::memory_order_seq_cst);
+
+        if(m_waiterCount.load() > 0)
+        {
+            {
+                const std::lock_guard<std::mutex> lock{m_sleepMutex};
+            }
+            m_jobFinished.notify_all();
+        }
+
+        for(std::shared_ptr<Job>& dependent: dependents)
+        {
+            if(dependent->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Enqueue(std::move(dependent));
+            }
+        }
+    }
+
+}
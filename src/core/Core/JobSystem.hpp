@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace App {
+
+    // A pool of worker threads, one per core but the UI thread's. Each worker
+    // takes from the back of its own queue, so work a job spawns stays warm
+    // in its cache, and an idle one steals from the front of the others'.
+    // Jobs may depend on other jobs. Main-thread jobs only queue up once
+    // their dependencies finished and run inside DispatchMainThread(), once
+    // per frame on the UI thread, so they can touch ImGui and the
+    // Application. Workers show up as "Job worker N" in the Instrumentor trace.
+    class JobSystem
+    {
+        struct Job;
+
+    public:
+        struct Settings
+        {
+            // Zero picks one per core minus the UI thread, at least one.
+            std::size_t workerCount{0};
+        };
+
+        class Handle
+        {
+        public:
+            Handle() = default;
+
+            [[nodiscard]] bool IsValid() const;
+            // Ran or threw.
+            [[nodiscard]] bool IsDone() const;
+
+        private:
+            friend class JobSystem;
+            explicit Handle(std::shared_ptr<Job> job);
+
+            std::shared_ptr<Job> m_job{};
+        };
+
+        JobSystem();
+        explicit JobSystem(const Settings& settings);
+        // Jobs not started yet are dropped, running ones are waited for.
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem(JobSystem&&) = delete;
+        JobSystem& operator=(JobSystem other) = delete;
+        JobSystem& operator=(JobSystem&& other) = delete;
+
+        // Safe from any thread, including from inside a job. Invalid handles
+        // among the dependencies are ignored.
+        Handle Schedule(std::function<void()> work, const std::vector<Handle>& dependencies = {});
+        Handle ScheduleOnMainThread(std::function<void()> work, const std::vector<Handle>& dependencies = {});
+
+        // Runs other worker jobs while the job is not done, never main-thread
+        // ones, so do not wait on those from the UI thread. Rethrows what the job
+        // threw, its dependents still run.
+        void Wait(const Handle& handle);
+
+        // Calls body(begin, end) for consecutive ranges of at most grain
+        // indices covering [0, count), on the workers and the calling thread,
+        // and returns once all of them returned. Zero grain splits the range
+        // into a few chunks per thread. Rethrows the first exception of body.
+        void ParallelFor(std::size_t count,
+                         std::size_t grain,
+                         const std::function<void(std::size_t begin, std::size_t end)>& body);
+
+        // Runs the main-thread jobs that became ready, on the UI thread, including
+        // those they make ready. Rethrows the first exception one of them threw.
+        void DispatchMainThread();
+
+        // Called from any thread when a main-thread job became ready,
+        // typically wakes up an idle main loop to DispatchMainThread().
+        void SetMainThreadNotifier(std::function<void()> notifier);
+
+        [[nodiscard]] std::size_t GetWorkerCount() const;
+
+    private:
+        enum class Affinity
+        {
+            Worker,
+            MainThread
+        };
+
+        struct Job
+        {
+            std::function<void()> work;
+            Affinity affinity{Affinity::Worker};
+            // Plus one while Schedule() is still adding the dependencies.
+            std::atomic<std::size_t> pendingDependencies{1};
+            std::atomic<bool> done{false};
+            std::exception_ptr error{};
+
+            // Guards dependents and finished.
+            std::mutex mutex;
+            std::vector<std::shared_ptr<Job>> dependents{};
+            bool finished{false};
+        };
+
+        // Owner pushes and pops at the back, thieves take from the front.
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<std::shared_ptr<Job>> jobs{};
+        };
+
+        Handle Schedule(Affinity affinity, std::function<void()> work, const std::vector<Handle>& dependencies);
+        void WorkerLoop(std::size_t index);
+        // Own queue, then the shared one, then the other workers' queues.
+        std::shared_ptr<Job> TakeJob(std::size_t index);
+        void Enqueue(std::shared_ptr<Job> job);
+        void Execute(Job& job);
+        void Finish(Job& job);
+
+        std::size_t m_workerCount{0};
+        // One per worker, then one for jobs scheduled from outside the workers.
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues{};
+        // Across all of m_queues, lets idle threads sleep without looking into each.
+        std::atomic<std::size_t> m_queuedCount{0};
+        std::atomic<std::size_t> m_waiterCount{0};
+        bool m_stopping{false};
+
+        std::mutex m_sleepMutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_jobFinished;
+
+        std::mutex m_mainMutex;
+        std::deque<std::shared_ptr<Job>> m_mainQueue{};
+        std::function<void()> m_mainThreadNotifier{};
+
+        std::vector<std::thread> m_workers{};
+    };
+
+}
@@ -0,0 +1,674 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace App {
+
+    // Push-based JSON parser for documents that arrive in pieces, e.g. from an
+    // HttpClient::Request::onData callback. nlohmann::json::sax_parse needs the
+    // whole input up front, this one is fed chunk by chunk and keeps only the
+    // token currently being read.
+    //
+    // Sax follows the nlohmann::json_sax interface: null, boolean,
+    // number_integer, number_unsigned, number_float, string, start_object,
+    // key, end_object, start_array and end_array, each returning false to stop.
+    // parse_error is never called, errors are reported by Feed() and Finish().
+    // Accepts everything, derive from it and hide only the events a typed
+    // reader cares about.
+    struct JsonSaxDefaults
+    {
+        bool null()
+        {
+            return true;
+        }
+
+        bool boolean(bool /*value*/)
+        {
+            return true;
+        }
+
+        bool number_integer(std::int64_t /*value*/)
+        {
+            return true;
+        }
+
+        bool number_unsigned(std::uint64_t /*value*/)
+        {
+            return true;
+        }
+
+        bool number_float(double /*value*/, const std::string& /*text*/)
+        {
+            return true;
+        }
+
+        bool string(std::string& /*value*/)
+        {
+            return true;
+        }
+
+        bool start_object(std::size_t /*size*/)
+        {
+            return true;
+        }
+
+        bool key(std::string& /*key*/)
+        {
+            return true;
+        }
+
+        bool end_object()
+        {
+            return true;
+        }
+
+        bool start_array(std::size_t /*size*/)
+        {
+            return true;
+        }
+
+        bool end_array()
+        {
+            return true;
+        }
+    };
+
+    template<typename Sax>
+    class JsonStreamParser
+    {
+    public:
+        explicit JsonStreamParser(Sax& sax) : m_sax(sax)
+        {
+        }
+
+        // Returns false once the document is invalid or the handler stopped it.
+        bool Feed(std::string_view chunk)
+        {
+            std::size_t i{0};
+            while(i < chunk.size() && m_expect != Expect::Failed)
+            {
+                switch(m_token)
+                {
+                case Token::None:
+                    i = ReadStructure(chunk, i);
+                    break;
+                case Token::String:
+                    i = ReadString(chunk, i);
+                    break;
+                case Token::Number:
+                    i = ReadNumber(chunk, i);
+                    break;
+                case Token::Literal:
+                    i = ReadLiteral(chunk, i);
+                    break;
+                }
+            }
+            return m_expect != Expect::Failed;
+        }
+
+        // Call after the last chunk, true when exactly one complete value was read.
+        bool Finish()
+        {
+            if(m_token == Token::Number && m_expect != Expect::Failed)
+            {
+                EndNumber();
+            }
+            if(m_expect == Expect::Failed)
+            {
+                return false;
+            }
+            if(m_token != Token::None || m_expect != Expect::End)
+            {
+                return Fail("Unexpected end of input");
+            }
+            return true;
+        }
+
+        [[nodiscard]] const std::string& GetError() const
+        {
+            return m_error;
+        }
+
+        // Bytes consumed so far, points at the offending byte after an error.
+        [[nodiscard]] std::size_t GetPosition() const
+        {
+            return m_position;
+        }
+
+    private:
+        enum class Expect
+        {
+            Value,
+            ValueOrArrayEnd,
+            KeyOrObjectEnd,
+            Key,
+            Colon,
+            CommaOrEnd,
+            End,
+            Failed
+        };
+
+        enum class Token
+        {
+            None,
+            String,
+            Number,
+            Literal
+        };
+
+        static constexpr std::size_t UnknownSize{std::numeric_limits<std::size_t>::max()};
+
+        static bool IsWhitespace(const char c)
+        {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        bool Fail(const char* message)
+        {
+            m_expect = Expect::Failed;
+            m_error = message;
+            return false;
+        }
+
+        bool Stop(const bool keepGoing)
+        {
+            return keepGoing || Fail("Stopped by the handler");
+        }
+
+        // Called once a value is complete, moves on in the enclosing container.
+        bool AfterValue(const bool keepGoing)
+        {
+            if(!Stop(keepGoing))
+            {
+                return false;
+            }
+            m_expect = m_containers.empty() ? Expect::End : Expect::CommaOrEnd;
+            return true;
+        }
+
+        bool IsExpectingValue() const
+        {
+            return m_expect == Expect::Value || m_expect == Expect::ValueOrArrayEnd;
+        }
+
+        std::size_t ReadStructure(const std::string_view chunk, std::size_t i)
+        {
+            for(; i < chunk.size(); ++i, ++m_position)
+            {
+                const char c{chunk[i]};
+                if(IsWhitespace(c))
+                {
+                    continue;
+                }
+
+                switch(c)
+                {
+                case '{':
+                    if(!IsExpectingValue())
+                    {
+                        Fail("Unexpected '{'");
+                        return i;
+                    }
+                    m_containers.push_back('{');
+                    m_expect = Expect::KeyOrObjectEnd;
+                    if(!Stop(m_sax.start_object(UnknownSize)))
+                    {
+                        return i;
+                    }
+                    continue;
+                case '[':
+                    if(!IsExpectingValue())
+                    {
+                        Fail("Unexpected '['");
+                        return i;
+                    }
+                    m_containers.push_back('[');
+                    m_expect = Expect::ValueOrArrayEnd;
+                    if(!Stop(m_sax.start_array(UnknownSize)))
+                    {
+                        return i;
+                    }
+                    continue;
+                case '}':
+                    if((m_expect != Expect::KeyOrObjectEnd && m_expect != Expect::CommaOrEnd)
+                       || m_containers.empty() || m_containers.back() != '{')
+                    {
+                        Fail("Unexpected '}'");
+                        return i;
+                    }
+                    m_containers.pop_back();
+                    if(!AfterValue(m_sax.end_object()))
+                    {
+                        return i;
+                    }
+                    continue;
+                case ']':
+                    if((m_expect != Expect::ValueOrArrayEnd && m_expect != Expect::CommaOrEnd)
+                       || m_containers.empty() || m_containers.back() != '[')
+                    {
+                        Fail("Unexpected ']'");
+                        return i;
+                    }
+                    m_containers.pop_back();
+                    if(!AfterValue(m_sax.end_array()))
+                    {
+                        return i;
+                    }
+                    continue;
+                case ',':
+                    if(m_expect != Expect::CommaOrEnd)
+                    {
+                        Fail("Unexpected ','");
+                        return i;
+                    }
+                    m_expect = m_containers.back() == '{' ? Expect::Key : Expect::Value;
+                    continue;
+                case ':':
+                    if(m_expect != Expect::Colon)
+                    {
+                        Fail("Unexpected ':'");
+                        return i;
+                    }
+                    m_expect = Expect::Value;
+                    continue;
+                case '"':
+                    if(!IsExpectingValue() && m_expect != Expect::KeyOrObjectEnd && m_expect != Expect::Key)
+                    {
+                        Fail("Unexpected string");
+                        return i;
+                    }
+                    m_token = Token::String;
+                    m_stringIsKey = !IsExpectingValue();
+                    m_buffer.clear();
+                    ++m_position;
+                    return i + 1;
+                default:
+                    break;
+                }
+
+                if(!IsExpectingValue())
+                {
+                    Fail("Unexpected character");
+                    return i;
+                }
+                if(c == '-' || (c >= '0' && c <= '9'))
+                {
+                    m_token = Token::Number;
+                    m_buffer.clear();
+                    return i;
+                }
+                if(c == 't' || c == 'f' || c == 'n')
+                {
+                    m_token = Token::Literal;
+                    m_buffer.clear();
+                    return i;
+                }
+                Fail("Unexpected character");
+                return i;
+            }
+            return i;
+        }
+
+        std::size_t ReadString(const std::string_view chunk, std::size_t i)
+        {
+            while(i < chunk.size())
+            {
+                if(m_escapeLength > 0)
+                {
+                    if(!ReadEscape(chunk[i]))
+                    {
+                        return i;
+                    }
+                    ++i;
+                    ++m_position;
+                    continue;
+                }
+
+                // Copy plain runs in one go, strings are most of a typical payload.
+                std::size_t end{i};
+                while(end < chunk.size() && chunk[end] != '"' && chunk[end] != '\\'
+                      && static_cast<unsigned char>(chunk[end]) >= 0x20)
+                {
+                    ++end;
+                }
+                if(m_pendingHighSurrogate != 0 && end > i)
+                {
+                    Fail("Unpaired UTF-16 surrogate");
+                    return i;
+                }
+                m_buffer.append(chunk.data() + i, end - i);
+                m_position += end - i;
+                i = end;
+                if(i == chunk.size())
+                {
+                    break;
+                }
+
+                const char c{chunk[i]};
+                if(c == '\\')
+                {
+                    m_escapeLength = 1;
+                }
+                else if(c == '"')
+                {
+                    if(m_pendingHighSurrogate != 0)
+                    {
+                        Fail("Unpaired UTF-16 surrogate");
+                        return i;
+                    }
+                    m_token = Token::None;
+                    ++m_position;
+                    if(m_stringIsKey)
+                    {
+                        m_expect = Expect::Colon;
+                        Stop(m_sax.key(m_buffer));
+                    }
+                    else
+                    {
+                        AfterValue(m_sax.string(m_buffer));
+                    }
+                    return i + 1;
+                }
+                else
+                {
+                    Fail("Control character in string");
+                    return i;
+                }
+                ++i;
+                ++m_position;
+            }
+            return i;
+        }
+
+        bool ReadEscape(const char c)
+        {
+            if(m_escapeLength == 1)
+            {
+                if(m_pendingHighSurrogate != 0 && c != 'u')
+                {
+                    return Fail("Unpaired UTF-16 surrogate");
+                }
+                char decoded{0};
+                switch(c)
+                {
+                case '"': decoded = '"'; break;
+                case '\\': decoded = '\\'; break;
+                case '/': decoded = '/'; break;
+                case 'b': decoded = '\b'; break;
+                case 'f': decoded = '\f'; break;
+                case 'n': decoded = '\n'; break;
+                case 'r': decoded = '\r'; break;
+                case 't': decoded = '\t'; break;
+                case 'u':
+                    m_escapeLength = 2;
+                    m_codeUnit = 0;
+                    return true;
+                default:
+                    return Fail("Invalid escape sequence");
+                }
+                m_buffer.push_back(decoded);
+                m_escapeLength = 0;
+                return true;
+            }
+
+            std::uint32_t digit{0};
+            if(c >= '0' && c <= '9')
+            {
+                digit = static_cast<std::uint32_t>(c - '0');
+            }
+            else if(c >= 'a' && c <= 'f')
+            {
+                digit = static_cast<std::uint32_t>(c - 'a' + 10);
+            }
+            else if(c >= 'A' && c <= 'F')
+            {
+                digit = static_cast<std::uint32_t>(c - 'A' + 10);
+            }
+            else
+            {
+                return Fail("Invalid \\u escape");
+            }
+            m_codeUnit = (m_codeUnit << 4U) | digit;
+            if(++m_escapeLength < 6)
+            {
+                return true;
+            }
+            m_escapeLength = 0;
+
+            std::uint32_t codePoint{m_codeUnit};
+            if(m_pendingHighSurrogate != 0)
+            {
+                if(codePoint < 0xDC00 || codePoint > 0xDFFF)
+                {
+                    return Fail("Unpaired UTF-16 surrogate");
+                }
+                codePoint = 0x10000 + ((m_pendingHighSurrogate - 0xD800) << 10U) + (codePoint - 0xDC00);
+                m_pendingHighSurrogate = 0;
+            }
+            else if(codePoint >= 0xD800 && codePoint <= 0xDBFF)
+            {
+                m_pendingHighSurrogate = codePoint;
+                return true;
+            }
+            else if(codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+            {
+                return Fail("Unpaired UTF-16 surrogate");
+            }
+
+            AppendUtf8(codePoint);
+            return true;
+        }
+
+        void AppendUtf8(const std::uint32_t codePoint)
+        {
+            if(codePoint < 0x80)
+            {
+                m_buffer.push_back(static_cast<char>(codePoint));
+            }
+            else if(codePoint < 0x800)
+            {
+                m_buffer.push_back(static_cast<char>(0xC0U | (codePoint >> 6U)));
+                m_buffer.push_back(static_cast<char>(0x80U | (codePoint & 0x3FU)));
+            }
+            else if(codePoint < 0x10000)
+            {
+                m_buffer.push_back(static_cast<char>(0xE0U | (codePoint >> 12U)));
+                m_buffer.push_back(static_cast<char>(0x80U | ((codePoint >> 6U) & 0x3FU)));
+                m_buffer.push_back(static_cast<char>(0x80U | (codePoint & 0x3FU)));
+            }
+            else
+            {
+                m_buffer.push_back(static_cast<char>(0xF0U | (codePoint >> 18U)));
+                m_buffer.push_back(static_cast<char>(0x80U | ((codePoint >> 12U) & 0x3FU)));
+                m_buffer.push_back(static_cast<char>(0x80U | ((codePoint >> 6U) & 0x3FU)));
+                m_buffer.push_back(static_cast<char>(0x80U | (codePoint & 0x3FU)));
+            }
+        }
+
+        std::size_t ReadNumber(const std::string_view chunk, std::size_t i)
+        {
+            const std::size_t start{i};
+            while(i < chunk.size())
+            {
+                const char c{chunk[i]};
+                if((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E')
+                {
+                    break;
+                }
+                ++i;
+            }
+            m_buffer.append(chunk.data() + start, i - start);
+            m_position += i - start;
+
+            // The number only ends at a character that cannot belong to it.
+            if(i < chunk.size())
+            {
+                EndNumber();
+            }
+            return i;
+        }
+
+        void EndNumber()
+        {
+            m_token = Token::None;
+            if(!IsValidNumber(m_buffer))
+            {
+                Fail("Invalid number");
+                return;
+            }
+
+            const char* first{m_buffer.data()};
+            const char* last{first + m_buffer.size()};
+            if(m_buffer.find_first_of(".eE") == std::string::npos)
+            {
+                if(m_buffer[0] == '-')
+                {
+                    std::int64_t value{0};
+                    if(std::from_chars(first, last, value).ec == std::errc{})
+                    {
+                        AfterValue(m_sax.number_integer(value));
+                        return;
+                    }
+                }
+                else
+                {
+                    std::uint64_t value{0};
+                    if(std::from_chars(first, last, value).ec == std::errc{})
+                    {
+                        AfterValue(m_sax.number_unsigned(value));
+                        return;
+                    }
+                }
+                // Out of range integers fall back to double like nlohmann does.
+            }
+
+            double value{0.0};
+            if(std::from_chars(first, last, value).ec == std::errc::result_out_of_range)
+            {
+                // Underflow reads as zero, overflow is an error like in nlohmann.
+                const std::size_t exponent{m_buffer.find_first_of("eE")};
+                if(exponent == std::string::npos || m_buffer.find('-', exponent) == std::string::npos)
+                {
+                    Fail("Number out of range");
+                    return;
+                }
+                value = m_buffer[0] == '-' ? -0.0 : 0.0;
+            }
+            AfterValue(m_sax.number_float(value, m_buffer));
+        }
+
+        // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+        static bool IsValidNumber(const std::string_view text)
+        {
+            std::size_t i{0};
+            const auto digits{[&]() {
+                const std::size_t start{i};
+                while(i < text.size() && text[i] >= '0' && text[i] <= '9')
+                {
+                    ++i;
+                }
+                return i - start;
+            }};
+
+            if(i < text.size() && text[i] == '-')
+            {
+                ++i;
+            }
+            if(i < text.size() && text[i] == '0')
+            {
+                ++i;
+            }
+            else if(digits() == 0)
+            {
+                return false;
+            }
+            if(i < text.size() && text[i] == '.')
+            {
+                ++i;
+                if(digits() == 0)
+                {
+                    return false;
+                }
+            }
+            if(i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+            {
+                ++i;
+                if(i < text.size() && (text[i] == '+' || text[i] == '-'))
+                {
+                    ++i;
+                }
+                if(digits() == 0)
+                {
+                    return false;
+                }
+            }
+            return i == text.size();
+        }
+
+        std::size_t ReadLiteral(const std::string_view chunk, std::size_t i)
+        {
+            const std::string_view expected{m_buffer.empty() ? LiteralFor(chunk[i]) : LiteralFor(m_buffer[0])};
+            while(i < chunk.size() && m_buffer.size() < expected.size())
+            {
+                if(chunk[i] != expected[m_buffer.size()])
+                {
+                    Fail("Invalid literal");
+                    return i;
+                }
+                m_buffer.push_back(chunk[i]);
+                ++i;
+                ++m_position;
+            }
+
+            if(m_buffer.size() == expected.size())
+            {
+                m_token = Token::None;
+                if(expected[0] == 'n')
+                {
+                    AfterValue(m_sax.null());
+                }
+                else
+                {
+                    AfterValue(m_sax.boolean(expected[0] == 't'));
+                }
+            }
+            return i;
+        }
+
+        static std::string_view LiteralFor(const char first)
+        {
+            switch(first)
+            {
+            case 't':
+                return "true";
+            case 'f':
+                return "false";
+            default:
+                return "null";
+            }
+        }
+
+        Sax& m_sax;
+        Expect m_expect{Expect::Value};
+        Token m_token{Token::None};
+        // '{' or '[' per open container.
+        std::vector<char> m_containers;
+
+        // The token being read, kept across chunks.
+        std::string m_buffer;
+        bool m_stringIsKey{false};
+        int m_escapeLength{0};
+        std::uint32_t m_codeUnit{0};
+        std::uint32_t m_pendingHighSurrogate{0};
+
+        std::size_t m_position{0};
+        std::string m_error;
+    };
+
+}
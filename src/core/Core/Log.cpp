@@ -1,31 +1,145 @@
 #include "Log.hpp"
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <string>
 #include <vector>
 
 namespace App {
 
+    namespace {
+        // spdlog only knows block and overrun_oldest. This front logger drops
+        // the incoming message itself when the queue is full and hands
+        // everything else to the async logger behind it.
+        class DropNewestLogger final : public spdlog::logger
+        {
+        public:
+            DropNewestLogger(std::shared_ptr<spdlog::async_logger> asyncLogger,
+                             const std::shared_ptr<spdlog::details::thread_pool>& threadPool,
+                             const std::size_t queueSize,
+                             std::atomic<std::size_t>& dropped)
+                    : spdlog::logger(asyncLogger->name()),
+                      m_asyncLogger(std::move(asyncLogger)),
+                      m_threadPool(threadPool),
+                      m_queueSize(queueSize),
+                      m_dropped(dropped)
+            {
+                m_asyncLogger->set_level(spdlog::level::trace);
+            }
+
+        protected:
+            void sink_it_(const spdlog::details::log_msg& msg) override
+            {
+                if(const auto threadPool{m_threadPool.lock()};
+                   threadPool != nullptr && threadPool->queue_size() >= m_queueSize)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                m_asyncLogger->log(msg.time, msg.source, msg.level, msg.payload);
+            }
+
+            void flush_() override
+            {
+                m_asyncLogger->flush();
+            }
+
+        private:
+            std::shared_ptr<spdlog::async_logger> m_asyncLogger;
+            std::weak_ptr<spdlog::details::thread_pool> m_threadPool;
+            const std::size_t m_queueSize;
+            std::atomic<std::size_t>& m_dropped;
+        };
+    }
+
     Log::Log()
     {
-        std::vector<spdlog::sink_ptr> logSinks;
+        m_sinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+        m_sinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>("app.log", true));
+
+        m_sinks[0]->set_pattern("%^[%T] %n(%l): %v%$");
+        m_sinks[1]->set_pattern("[%T] [%l] %n(%l): %v");
+
+        Build(Settings{});
+    }
+
+    Log::~Log()
+    {
+        // Stops the periodic flusher and drops the logger, the thread pool then
+        // drains its queue when it goes away.
+        m_logger->flush();
+        spdlog::shutdown();
+        m_logger.reset();
+        m_threadPool.reset();
+    }
 
+    void Log::Configure(const Settings& settings)
+    {
+        Get().Build(settings);
+    }
+
+    std::size_t Log::GetDroppedMessageCount()
+    {
+        const Log& log{Get()};
+        return log.m_droppedNewest.load(std::memory_order_relaxed)
+               + (log.m_threadPool != nullptr ? log.m_threadPool->overrun_counter() : 0);
+    }
+
+    void Log::Build(const Settings& settings)
+    {
         #ifdef TRACE
         const spdlog::level::level_enum level{spdlog::level::trace};
         #else
         const spdlog::level::level_enum level{spdlog::level::debug};
         #endif
 
-        logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
-        logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>("app.log", true));
+        std::shared_ptr<spdlog::details::thread_pool> threadPool;
+        std::shared_ptr<spdlog::logger> logger;
+
+        if(settings.mode == Mode::Asynchronous)
+        {
+            threadPool = std::make_shared<spdlog::details::thread_pool>(settings.queueSize, 1);
+
+            switch(settings.overflowPolicy)
+            {
+            case OverflowPolicy::Block:
+                logger = std::make_shared<spdlog::async_logger>(
+                        "APP", begin(m_sinks), end(m_sinks), threadPool, spdlog::async_overflow_policy::block);
+                break;
+            case OverflowPolicy::DropOldest:
+                logger = std::make_shared<spdlog::async_logger>(
+                        "APP", begin(m_sinks), end(m_sinks), threadPool, spdlog::async_overflow_policy::overrun_oldest);
+                break;
+            case OverflowPolicy::DropNewest:
+                logger = std::make_shared<DropNewestLogger>(
+                        std::make_shared<spdlog::async_logger>("APP", begin(m_sinks), end(m_sinks), threadPool),
+                        threadPool,
+                        settings.queueSize,
+                        m_droppedNewest);
+                break;
+            }
+        }
+        else
+        {
+            logger = std::make_shared<spdlog::logger>("APP", begin(m_sinks), end(m_sinks));
+        }
+
+        if(m_logger != nullptr)
+        {
+            m_logger->flush();
+            spdlog::drop(m_logger->name());
+        }
 
-        logSinks[0]->set_pattern("%^[%T] %n(%l): %v%$");
-        logSinks[1]->set_pattern("[%T] [%l] %n(%l): %v");
+        spdlog::register_logger(logger);
+        spdlog::set_default_logger(logger);
+        logger->set_level(level);
+        // Errors should survive a crash, everything else is flushed periodically.
+        logger->flush_on(spdlog::level::err);
+        spdlog::flush_every(settings.flushInterval);
 
-        m_logger = std::make_shared<spdlog::logger>("APP", begin(logSinks), end(logSinks));
-        spdlog::register_logger(m_logger);
-        spdlog::set_default_logger(m_logger);
-        m_logger->set_level(level);
-        m_logger->flush_on(level);
+        m_droppedNewest.store(0, std::memory_order_relaxed);
+        m_logger = std::move(logger);
+        m_threadPool = std::move(threadPool);
     }
 
 }
\ No newline at end of file
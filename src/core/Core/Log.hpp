@@ -1,24 +1,62 @@
 #pragma once
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <vector>
+
+namespace spdlog::details {
+    class thread_pool;
+}
 
 namespace App {
 
     class Log
     {
     public:
+        enum class Mode
+        {
+            Synchronous,
+            // Messages are formatted and written by a dedicated log thread.
+            Asynchronous
+        };
+
+        // What an asynchronous logger does when its queue is full.
+        enum class OverflowPolicy
+        {
+            Block,
+            DropOldest,
+            DropNewest
+        };
+
+        struct Settings
+        {
+            Mode mode{Mode::Asynchronous};
+            std::size_t queueSize{8192};
+            OverflowPolicy overflowPolicy{OverflowPolicy::Block};
+            // Errors are always flushed right away.
+            std::chrono::seconds flushInterval{1};
+        };
+
         Log(const Log&) = delete;
         Log(const Log&&) = delete;
         Log& operator=(const Log&) = delete;
         Log& operator=(const Log&&) = delete;
-        ~Log() = default;
+        ~Log();
 
         static std::shared_ptr<spdlog::logger>& Logger()
         {
             return Get().m_logger;
         }
 
+        // Replaces the logger, so call it before other threads start logging.
+        static void Configure(const Settings& settings);
+
+        // Messages dropped by the overflow policy since the last Configure().
+        [[nodiscard]] static std::size_t GetDroppedMessageCount();
+
     private:
         // The constructor shall not be deleted but used to bootstrap the logger. Ignoring
         // the lint warning is ignoring doing `Log() = delete`.
@@ -31,6 +69,11 @@ namespace App {
             return instance;
         }
 
+        void Build(const Settings& settings);
+
+        std::vector<spdlog::sink_ptr> m_sinks;
+        std::shared_ptr<spdlog::details::thread_pool> m_threadPool;
+        std::atomic<std::size_t> m_droppedNewest{0};
         std::shared_ptr<spdlog::logger> m_logger;
     };
 
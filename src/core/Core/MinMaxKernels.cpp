@@ -0,0 +1,120 @@
+#include "MinMaxKernels.hpp"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define APP_MINMAX_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define APP_MINMAX_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace App {
+
+    namespace {
+        static_assert(MinMaxKernels::GroupSize == 8, "the vector kernels reduce two registers of four per group");
+
+        // Four groups per iteration: each group's two halves are folded into
+        // one register, then the four registers are reduced across each other.
+        constexpr std::size_t GroupsPerStep{4};
+
+#if APP_MINMAX_SSE2
+        __m128 Min4Groups(const float* values)
+        {
+            __m128 a{_mm_min_ps(_mm_loadu_ps(values), _mm_loadu_ps(values + 4))};
+            __m128 b{_mm_min_ps(_mm_loadu_ps(values + 8), _mm_loadu_ps(values + 12))};
+            __m128 c{_mm_min_ps(_mm_loadu_ps(values + 16), _mm_loadu_ps(values + 20))};
+            __m128 d{_mm_min_ps(_mm_loadu_ps(values + 24), _mm_loadu_ps(values + 28))};
+            // Lane i of every group into register i, a column-wise minimum is left.
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+            return _mm_min_ps(_mm_min_ps(a, b), _mm_min_ps(c, d));
+        }
+
+        __m128 Max4Groups(const float* values)
+        {
+            __m128 a{_mm_max_ps(_mm_loadu_ps(values), _mm_loadu_ps(values + 4))};
+            __m128 b{_mm_max_ps(_mm_loadu_ps(values + 8), _mm_loadu_ps(values + 12))};
+            __m128 c{_mm_max_ps(_mm_loadu_ps(values + 16), _mm_loadu_ps(values + 20))};
+            __m128 d{_mm_max_ps(_mm_loadu_ps(values + 24), _mm_loadu_ps(values + 28))};
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+            return _mm_max_ps(_mm_max_ps(a, b), _mm_max_ps(c, d));
+        }
+#elif APP_MINMAX_NEON
+        float32x4_t Min4Groups(const float* values)
+        {
+            const float32x4_t a{vminq_f32(vld1q_f32(values), vld1q_f32(values + 4))};
+            const float32x4_t b{vminq_f32(vld1q_f32(values + 8), vld1q_f32(values + 12))};
+            const float32x4_t c{vminq_f32(vld1q_f32(values + 16), vld1q_f32(values + 20))};
+            const float32x4_t d{vminq_f32(vld1q_f32(values + 24), vld1q_f32(values + 28))};
+            // Pairwise twice leaves one lane per group, in order.
+            return vpminq_f32(vpminq_f32(a, b), vpminq_f32(c, d));
+        }
+
+        float32x4_t Max4Groups(const float* values)
+        {
+            const float32x4_t a{vmaxq_f32(vld1q_f32(values), vld1q_f32(values + 4))};
+            const float32x4_t b{vmaxq_f32(vld1q_f32(values + 8), vld1q_f32(values + 12))};
+            const float32x4_t c{vmaxq_f32(vld1q_f32(values + 16), vld1q_f32(values + 20))};
+            const float32x4_t d{vmaxq_f32(vld1q_f32(values + 24), vld1q_f32(values + 28))};
+            return vpmaxq_f32(vpmaxq_f32(a, b), vpmaxq_f32(c, d));
+        }
+#endif
+    }
+
+    void MinMaxKernels::Reduce(const float* mins,
+                               const float* maxs,
+                               const std::size_t groups,
+                               float* outMins,
+                               float* outMaxs)
+    {
+        std::size_t group{0};
+#if APP_MINMAX_SSE2
+        for(; group + GroupsPerStep <= groups; group += GroupsPerStep)
+        {
+            _mm_storeu_ps(outMins + group, Min4Groups(mins + group * GroupSize));
+            _mm_storeu_ps(outMaxs + group, Max4Groups(maxs + group * GroupSize));
+        }
+#elif APP_MINMAX_NEON
+        for(; group + GroupsPerStep <= groups; group += GroupsPerStep)
+        {
+            vst1q_f32(outMins + group, Min4Groups(mins + group * GroupSize));
+            vst1q_f32(outMaxs + group, Max4Groups(maxs + group * GroupSize));
+        }
+#endif
+        ReduceScalar(mins + group * GroupSize, maxs + group * GroupSize, groups - group, outMins + group, outMaxs + group);
+    }
+
+    void MinMaxKernels::ReduceScalar(const float* mins,
+                                     const float* maxs,
+                                     const std::size_t groups,
+                                     float* outMins,
+                                     float* outMaxs)
+    {
+        for(std::size_t group = 0; group < groups; ++group)
+        {
+            const float* const groupMins{mins + group * GroupSize};
+            const float* const groupMaxs{maxs + group * GroupSize};
+            float low{groupMins[0]};
+            float high{groupMaxs[0]};
+            for(std::size_t i = 1; i < GroupSize; ++i)
+            {
+                low = std::min(low, groupMins[i]);
+                high = std::max(high, groupMaxs[i]);
+            }
+            outMins[group] = low;
+            outMaxs[group] = high;
+        }
+    }
+
+    const char* MinMaxKernels::GetInstructionSet()
+    {
+#if APP_MINMAX_SSE2
+        return "SSE2";
+#elif APP_MINMAX_NEON
+        return "NEON";
+#else
+        return "scalar";
+#endif
+    }
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+namespace App {
+
+    // Reduces consecutive groups of GroupSize floats to their minimum and
+    // maximum, the step between two levels of a TimeSeries. Vectorized with
+    // SSE2 on x86-64 and NEON on 64-bit ARM, both part of their baseline so
+    // no build flag or runtime check is needed, a plain loop elsewhere. NaN
+    // values make the extremes of their group unspecified.
+    class MinMaxKernels
+    {
+    public:
+        static constexpr std::size_t GroupSize{8};
+
+        MinMaxKernels() = delete;
+
+        // outMins[g] is the minimum of mins[g * GroupSize, (g + 1) * GroupSize),
+        // outMaxs[g] the maximum of maxs in the same range. Pass the same
+        // samples as mins and maxs for the first level.
+        static void Reduce(const float* mins, const float* maxs, std::size_t groups, float* outMins, float* outMaxs);
+        // The plain loop, for comparison.
+        static void ReduceScalar(const float* mins, const float* maxs, std::size_t groups, float* outMins, float* outMaxs);
+
+        // "SSE2", "NEON" or "scalar".
+        [[nodiscard]] static const char* GetInstructionSet();
+    };
+
+}
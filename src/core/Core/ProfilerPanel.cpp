@@ -0,0 +1,434 @@
+#include "ProfilerPanel.hpp"
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <imgui.h>
+#include <implot.h>
+#include "Core/FrameArena.hpp"
+#include "Core/ViewportRenderer.hpp"
+
+namespace App::Debug {
+
+    namespace {
+        // Upper bound for samples waiting on or kept by the UI thread, so a
+        // hidden-but-open panel cannot grow without limit.
+        constexpr std::size_t MaxSamples{200'000};
+
+        double NowUs()
+        {
+            return FloatingPointMicroseconds{std::chrono::steady_clock::now().time_since_epoch()}.count();
+        }
+    }
+
+    ProfilerPanel::~ProfilerPanel()
+    {
+        SetCapturing(false);
+    }
+
+    void ProfilerPanel::Render(bool* open)
+    {
+        if(!*open)
+        {
+            SetCapturing(false);
+            return;
+        }
+
+        APP_PROFILE_FUNCTION();
+
+        SetCapturing(true);
+
+        const std::size_t slot{m_frameCount % FrameHistory};
+        m_frameTimesMs[slot] = ImGui::GetIO().DeltaTime * 1000.0F;
+        m_frameStartsUs[slot] = NowUs();
+        ++m_frameCount;
+
+        CollectPending();
+        UpdateStats();
+
+        if(ImGui::Begin("Profiler", open))
+        {
+            #if !APP_PROFILE
+            ImGui::TextDisabled("Profiling scopes are compiled out in this build.");
+            #endif
+
+            DrawCategoryFilter();
+            DrawFrameTimes();
+
+            if(ImGui::CollapsingHeader("Scopes", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                DrawStatsTable();
+            }
+
+            if(ImGui::CollapsingHeader("Last frame", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                DrawFlame();
+            }
+
+            if(m_viewportRenderer != nullptr && !m_viewportRenderer->GetTimings().empty()
+               && ImGui::CollapsingHeader("Viewports"))
+            {
+                DrawViewportTimings();
+            }
+        }
+        ImGui::End();
+
+        if(!*open)
+        {
+            SetCapturing(false);
+        }
+    }
+
+    void ProfilerPanel::SetViewportRenderer(const ViewportRenderer* renderer)
+    {
+        m_viewportRenderer = renderer;
+    }
+
+    void ProfilerPanel::SetFrameArena(FrameArena* arena)
+    {
+        m_frameArena = arena;
+    }
+
+    void ProfilerPanel::OnProfileResult(const std::thread::id threadId, const ProfileResult& result)
+    {
+        std::lock_guard lock(m_pendingMutex);
+        if(m_pending.size() >= MaxSamples)
+        {
+            return;
+        }
+
+        m_pending.push_back({result.descriptor,
+                             threadId == m_uiThreadId,
+                             result.start.count(),
+                             static_cast<double>(result.elapsedTime.count())});
+    }
+
+    void ProfilerPanel::SetCapturing(const bool capturing)
+    {
+        if(capturing == m_capturing)
+        {
+            return;
+        }
+
+        m_capturing = capturing;
+        if(capturing)
+        {
+            // Set before attaching, the writer thread reads it from then on.
+            m_uiThreadId = std::this_thread::get_id();
+            Instrumentor::Get().AttachSink(this);
+            return;
+        }
+
+        Instrumentor::Get().DetachSink(this);
+
+        {
+            std::lock_guard lock(m_pendingMutex);
+            m_pending.clear();
+        }
+        m_samples.clear();
+        m_stats.clear();
+        m_flame.clear();
+        m_frameCount = 0;
+        m_latestUiSampleEndUs = 0.0;
+    }
+
+    void ProfilerPanel::CollectPending()
+    {
+        {
+            std::lock_guard lock(m_pendingMutex);
+            for(const Sample& sample: m_pending)
+            {
+                m_samples.push_back(sample);
+                if(sample.uiThread)
+                {
+                    m_latestUiSampleEndUs = std::max(m_latestUiSampleEndUs, sample.startUs + sample.durationUs);
+                }
+            }
+            m_pending.clear();
+        }
+
+        // Keep the last StatsFrameCount frames. Samples arrive in per-thread
+        // batches, so this trims roughly in time order which is good enough.
+        const std::size_t keptFrames{std::min(m_frameCount, StatsFrameCount)};
+        const double cutoffUs{m_frameStartsUs[(m_frameCount - keptFrames) % FrameHistory]};
+        while(!m_samples.empty() && (m_samples.front().startUs < cutoffUs || m_samples.size() > MaxSamples))
+        {
+            m_samples.pop_front();
+        }
+    }
+
+    void ProfilerPanel::UpdateStats()
+    {
+        // Percentiles need sorting, a few refreshes per second are plenty to read them.
+        const auto now{std::chrono::steady_clock::now()};
+        if(now - m_lastStatsUpdate < StatsInterval)
+        {
+            return;
+        }
+        m_lastStatsUpdate = now;
+
+        using Duration = std::pair<const ScopeDescriptor*, double>;
+        FrameVector<Duration> durations{FrameAllocator<Duration>{m_frameArena}};
+        durations.reserve(m_samples.size());
+        for(const Sample& sample: m_samples)
+        {
+            durations.emplace_back(sample.scope, sample.durationUs);
+        }
+        std::sort(durations.begin(), durations.end(), [](const Duration& lhs, const Duration& rhs) {
+            return lhs.first != rhs.first ? std::less<>{}(lhs.first, rhs.first) : lhs.second < rhs.second;
+        });
+
+        m_stats.clear();
+        for(auto first{durations.begin()}; first != durations.end();)
+        {
+            const auto last{std::find_if(first, durations.end(), [scope = first->first](const Duration& entry) {
+                return entry.first != scope;
+            })};
+
+            const auto count{static_cast<std::size_t>(last - first)};
+            double total{0.0};
+            for(auto it{first}; it != last; ++it)
+            {
+                total += it->second;
+            }
+
+            const auto percentile{[&](const double p) {
+                return (first + static_cast<std::ptrdiff_t>(p * static_cast<double>(count - 1)))->second;
+            }};
+
+            m_stats.push_back({first->first,
+                               count,
+                               total / static_cast<double>(count),
+                               percentile(0.50),
+                               percentile(0.99),
+                               (last - 1)->second,
+                               total});
+            first = last;
+        }
+
+        std::sort(m_stats.begin(), m_stats.end(), [](const ScopeStats& lhs, const ScopeStats& rhs) {
+            return lhs.totalUs > rhs.totalUs;
+        });
+    }
+
+    void ProfilerPanel::DrawCategoryFilter()
+    {
+        struct Toggle
+        {
+            const char* label;
+            ProfileCategory category;
+        };
+        constexpr std::array<Toggle, 4> toggles{{
+                {"Functions", ProfileCategory::Function},
+                {"Scopes", ProfileCategory::Scope},
+                {"Hot scopes", ProfileCategory::Hot},
+                {"GPU", ProfileCategory::Gpu},
+        }};
+
+        Instrumentor& instrumentor{Instrumentor::Get()};
+        std::uint32_t mask{instrumentor.GetCategoryMask()};
+        bool changed{false};
+        for(const Toggle& toggle: toggles)
+        {
+            bool enabled{(mask & ToMask(toggle.category)) != 0};
+            if(ImGui::Checkbox(toggle.label, &enabled))
+            {
+                mask ^= ToMask(toggle.category);
+                changed = true;
+            }
+            ImGui::SameLine();
+        }
+        ImGui::NewLine();
+
+        if(changed)
+        {
+            instrumentor.SetCategoryMask(mask);
+        }
+    }
+
+    void ProfilerPanel::DrawFrameTimes() const
+    {
+        const auto count{static_cast<int>(std::min(m_frameCount, FrameHistory))};
+        const auto offset{static_cast<int>(m_frameCount < FrameHistory ? 0 : m_frameCount % FrameHistory)};
+
+        if(ImPlot::BeginPlot("##FrameTimes", ImVec2(-1.0F, 150.0F), ImPlotFlags_NoMenus | ImPlotFlags_NoLegend))
+        {
+            ImPlot::SetupAxes(nullptr, "ms", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, static_cast<double>(FrameHistory), ImGuiCond_Always);
+            ImPlot::PlotLine("Frame time", m_frameTimesMs.data(), count, 1.0, 0.0, 0, offset);
+            ImPlot::EndPlot();
+        }
+    }
+
+    void ProfilerPanel::DrawStatsTable() const
+    {
+        constexpr ImGuiTableFlags flags{ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable
+                                        | ImGuiTableFlags_ScrollY};
+
+        ImGui::TextDisabled("Last %zu frames, times in ms", StatsFrameCount);
+        if(!ImGui::BeginTable("##Scopes", 6, flags, ImVec2(0.0F, 220.0F)))
+        {
+            return;
+        }
+
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Mean");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableHeadersRow();
+
+        for(const ScopeStats& stats: m_stats)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stats.scope->name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", stats.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.meanUs / 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p50Us / 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p99Us / 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.maxUs / 1000.0);
+        }
+
+        ImGui::EndTable();
+    }
+
+    void ProfilerPanel::DrawViewportTimings() const
+    {
+        constexpr ImGuiTableFlags flags{ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders};
+
+        ImGui::TextDisabled("Last frame, times in ms, the main window is not listed");
+        if(!ImGui::BeginTable("##Viewports", 3, flags))
+        {
+            return;
+        }
+
+        ImGui::TableSetupColumn("Viewport", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Render");
+        ImGui::TableSetupColumn("Swap");
+        ImGui::TableHeadersRow();
+
+        for(const ViewportRenderer::Timing& timing: m_viewportRenderer->GetTimings())
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%08X", timing.id);
+            if(timing.skipped)
+            {
+                ImGui::TableNextColumn();
+                ImGui::TextDisabled("unchanged");
+                ImGui::TableNextColumn();
+                continue;
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", static_cast<double>(timing.render.count()) / 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", static_cast<double>(timing.swap.count()) / 1000.0);
+        }
+
+        ImGui::EndTable();
+    }
+
+    void ProfilerPanel::DrawFlame()
+    {
+        // Show the newest frame whose scopes have all been handed over by the
+        // writer. Scopes spanning a frame boundary (e.g. the main loop) finish
+        // in the next frame, hence the extra frame of slack.
+        if(m_frameCount >= 3)
+        {
+            const std::size_t frame{m_frameCount - 3};
+            const double beginUs{m_frameStartsUs[frame % FrameHistory]};
+            const double endUs{m_frameStartsUs[(frame + 1) % FrameHistory]};
+            const double settledUs{m_frameStartsUs[(frame + 2) % FrameHistory]};
+
+            if(m_latestUiSampleEndUs >= settledUs)
+            {
+                m_flame.clear();
+                for(const Sample& sample: m_samples)
+                {
+                    if(sample.uiThread && sample.startUs >= beginUs && sample.startUs < endUs)
+                    {
+                        m_flame.push_back(sample);
+                    }
+                }
+
+                std::sort(m_flame.begin(), m_flame.end(), [](const Sample& lhs, const Sample& rhs) {
+                    return lhs.startUs < rhs.startUs
+                           || (lhs.startUs == rhs.startUs && lhs.durationUs > rhs.durationUs);
+                });
+
+                m_flameDepths.clear();
+                FrameVector<double> openEnds{FrameAllocator<double>{m_frameArena}};
+                for(const Sample& sample: m_flame)
+                {
+                    while(!openEnds.empty() && openEnds.back() <= sample.startUs)
+                    {
+                        openEnds.pop_back();
+                    }
+                    m_flameDepths.push_back(static_cast<int>(openEnds.size()));
+                    openEnds.push_back(sample.startUs + sample.durationUs);
+                }
+            }
+        }
+
+        if(m_flame.empty())
+        {
+            ImGui::TextDisabled("No scopes recorded on the UI thread yet.");
+            return;
+        }
+
+        double beginUs{m_flame.front().startUs};
+        double endUs{beginUs};
+        int maxDepth{0};
+        for(std::size_t i = 0; i < m_flame.size(); ++i)
+        {
+            endUs = std::max(endUs, m_flame[i].startUs + m_flame[i].durationUs);
+            maxDepth = std::max(maxDepth, m_flameDepths[i]);
+        }
+        const double rangeUs{std::max(endUs - beginUs, 1.0)};
+
+        ImGui::TextDisabled("%.3f ms", rangeUs / 1000.0);
+
+        const float rowHeight{ImGui::GetTextLineHeightWithSpacing()};
+        const float width{ImGui::GetContentRegionAvail().x};
+        const ImVec2 origin{ImGui::GetCursorScreenPos()};
+        ImGui::Dummy(ImVec2(width, rowHeight * static_cast<float>(maxDepth + 1)));
+
+        ImDrawList* drawList{ImGui::GetWindowDrawList()};
+        for(std::size_t i = 0; i < m_flame.size(); ++i)
+        {
+            const Sample& sample{m_flame[i]};
+            const auto x0{origin.x + static_cast<float>((sample.startUs - beginUs) / rangeUs) * width};
+            const auto x1{std::max(x0 + 1.0F, x0 + static_cast<float>(sample.durationUs / rangeUs) * width)};
+            const auto y0{origin.y + static_cast<float>(m_flameDepths[i]) * rowHeight};
+            const ImVec2 min{x0, y0};
+            const ImVec2 max{x1, y0 + rowHeight - 1.0F};
+
+            const float hue{static_cast<float>(std::hash<const ScopeDescriptor*>{}(sample.scope) % 16U) / 16.0F};
+            drawList->AddRectFilled(min, max, ImColor::HSV(hue, 0.45F, 0.75F));
+
+            if(x1 - x0 > 8.0F)
+            {
+                drawList->PushClipRect(min, max, true);
+                drawList->AddText(ImVec2(x0 + 2.0F, y0), IM_COL32_BLACK, sample.scope->name);
+                drawList->PopClipRect();
+            }
+
+            if(ImGui::IsMouseHoveringRect(min, max))
+            {
+                ImGui::SetTooltip("%s\n%s:%u\n%.3f ms",
+                                  sample.scope->name,
+                                  sample.scope->file,
+                                  sample.scope->line,
+                                  sample.durationUs / 1000.0);
+            }
+        }
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Core/Instrumentor.hpp"
+#include "Core/SizeClassPool.hpp"
+
+namespace App {
+    class FrameArena;
+    class ViewportRenderer;
+}
+
+namespace App::Debug {
+
+    // Dockable "Profiler" window fed live from the Instrumentor. It only
+    // subscribes as a sink while it is being rendered, a closed panel costs
+    // nothing.
+    class ProfilerPanel final : public ProfileSink
+    {
+    public:
+        ProfilerPanel() = default;
+        ~ProfilerPanel() override;
+
+        ProfilerPanel(const ProfilerPanel&) = delete;
+        ProfilerPanel(ProfilerPanel&&) = delete;
+        ProfilerPanel& operator=(ProfilerPanel other) = delete;
+        ProfilerPanel& operator=(ProfilerPanel&& other) = delete;
+
+        // Call once per frame on the UI thread, returns right away while *open is false.
+        void Render(bool* open);
+
+        void OnProfileResult(std::thread::id threadId, const ProfileResult& result) override;
+
+        // Adds the secondary viewports' render and swap times, nullptr removes them.
+        void SetViewportRenderer(const ViewportRenderer* renderer);
+        // Per-frame scratch for the statistics and the flame graph, the heap without one.
+        void SetFrameArena(FrameArena* arena);
+
+    private:
+        struct Sample
+        {
+            const ScopeDescriptor* scope;
+            bool uiThread;
+            double startUs;
+            double durationUs;
+        };
+
+        struct ScopeStats
+        {
+            const ScopeDescriptor* scope;
+            std::size_t count;
+            double meanUs;
+            double p50Us;
+            double p99Us;
+            double maxUs;
+            double totalUs;
+        };
+
+        static constexpr std::size_t FrameHistory{300};
+        static constexpr std::size_t StatsFrameCount{120};
+        static constexpr std::chrono::milliseconds StatsInterval{250};
+
+        void SetCapturing(bool capturing);
+        void CollectPending();
+        void UpdateStats();
+
+        static void DrawCategoryFilter();
+        void DrawFrameTimes() const;
+        void DrawStatsTable() const;
+        void DrawViewportTimings() const;
+        void DrawFlame();
+
+        bool m_capturing{false};
+        const ViewportRenderer* m_viewportRenderer{nullptr};
+        FrameArena* m_frameArena{nullptr};
+        std::thread::id m_uiThreadId{};
+
+        // Filled by the Instrumentor writer thread.
+        std::mutex m_pendingMutex;
+        std::vector<Sample> m_pending;
+
+        // UI thread only. Pushed at the back and trimmed at the front every
+        // frame, the pool recycles the deque's nodes.
+        std::deque<Sample, PoolAllocator<Sample>> m_samples;
+        std::array<float, FrameHistory> m_frameTimesMs{};
+        std::array<double, FrameHistory> m_frameStartsUs{};
+        std::size_t m_frameCount{0};
+        double m_latestUiSampleEndUs{0.0};
+
+        std::vector<ScopeStats> m_stats;
+        std::vector<double> m_durationScratch;
+        std::chrono::steady_clock::time_point m_lastStatsUpdate{};
+
+        std::vector<Sample> m_flame;
+        std::vector<int> m_flameDepths;
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "RenderThread.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include "Core/Instrumentor.hpp"
+#include "Core/Window.hpp"
+
+namespace App {
+
+    namespace {
+        template<typename T>
+        void CopyBuffer(const ImVector<T>& source, ImVector<T>& target)
+        {
+            // resize() keeps the capacity, operator= frees and allocates again every frame.
+            target.resize(source.Size);
+            if(source.Size > 0)
+            {
+                std::memcpy(target.Data, source.Data, static_cast<std::size_t>(source.Size) * sizeof(T));
+            }
+        }
+    }
+
+    RenderThread::RenderThread(Window& window, RenderCallback render, PresentCallback presented)
+            : m_window(window),
+              m_render(std::move(render)),
+              m_presented(std::move(presented))
+    {
+        APP_PROFILE_FUNCTION();
+
+        // A context is current on one thread at a time, release it before the
+        // render thread takes it.
+        SDL_GL_MakeCurrent(m_window.GetNativeWindow(), nullptr);
+        m_thread = std::thread{&RenderThread::RenderLoop, this};
+    }
+
+    RenderThread::~RenderThread()
+    {
+        APP_PROFILE_FUNCTION();
+
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            m_stopRequested = true;
+        }
+        m_frameQueued.notify_one();
+        m_thread.join();
+
+        SDL_GL_MakeCurrent(m_window.GetNativeWindow(), m_window.GetNativeContext());
+
+        // Allocated through ImGui on this thread, freed the same way.
+        for(Snapshot& snapshot: m_snapshots)
+        {
+            for(ImDrawList* list: snapshot.lists)
+            {
+                IM_DELETE(list);
+            }
+        }
+    }
+
+    void RenderThread::WaitForFreeSnapshot()
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::unique_lock<std::mutex> lock{m_mutex};
+        const Snapshot& snapshot{m_snapshots[m_nextToSubmit]};
+        m_slotFreed.wait(lock, [&snapshot] { return snapshot.state == SlotState::Free; });
+    }
+
+    void RenderThread::Submit(const ImDrawData& drawData, const Clock::time_point inputTime)
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::unique_lock<std::mutex> lock{m_mutex};
+        Snapshot& snapshot{m_snapshots[m_nextToSubmit]};
+        {
+            APP_PROFILE_SCOPE("WaitForSnapshot");
+            m_slotFreed.wait(lock, [&snapshot] { return snapshot.state == SlotState::Free; });
+        }
+        lock.unlock();
+
+        // A free snapshot is not touched by the render thread.
+        Copy(drawData, snapshot);
+        snapshot.inputTime = inputTime;
+
+        lock.lock();
+        snapshot.state = SlotState::Queued;
+        m_nextToSubmit = (m_nextToSubmit + 1) % m_snapshots.size();
+        lock.unlock();
+        m_frameQueued.notify_one();
+    }
+
+    void RenderThread::Copy(const ImDrawData& source, Snapshot& target)
+    {
+        APP_PROFILE_FUNCTION();
+
+        const auto count{static_cast<std::size_t>(source.CmdListsCount)};
+        while(target.lists.size() < count)
+        {
+            target.lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+        }
+
+        // Only what a renderer backend reads, the path and clip stacks stay behind.
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const ImDrawList& from{*source.CmdLists[static_cast<int>(i)]};
+            ImDrawList& to{*target.lists[i]};
+            CopyBuffer(from.CmdBuffer, to.CmdBuffer);
+            CopyBuffer(from.IdxBuffer, to.IdxBuffer);
+            CopyBuffer(from.VtxBuffer, to.VtxBuffer);
+            to.Flags = from.Flags;
+        }
+
+        ImDrawData& data{target.drawData};
+        data.Valid = source.Valid;
+        data.CmdListsCount = source.CmdListsCount;
+        data.TotalIdxCount = source.TotalIdxCount;
+        data.TotalVtxCount = source.TotalVtxCount;
+        data.DisplayPos = source.DisplayPos;
+        data.DisplaySize = source.DisplaySize;
+        data.FramebufferScale = source.FramebufferScale;
+#if IMGUI_VERSION_NUM >= 18980
+        data.CmdLists.resize(source.CmdListsCount);
+        std::copy_n(target.lists.begin(), count, data.CmdLists.begin());
+#else
+        target.listPointers.assign(target.lists.begin(), target.lists.begin() + static_cast<std::ptrdiff_t>(count));
+        data.CmdLists = target.listPointers.data();
+#endif
+    }
+
+    void RenderThread::RenderLoop()
+    {
+        APP_PROFILE_THREAD("Render thread");
+        SDL_GL_MakeCurrent(m_window.GetNativeWindow(), m_window.GetNativeContext());
+
+        while(true)
+        {
+            Snapshot* snapshot{nullptr};
+            {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                m_frameQueued.wait(lock, [this] {
+                    return m_stopRequested || m_snapshots[m_nextToRender].state == SlotState::Queued;
+                });
+                // Frames submitted before the stop are still presented.
+                if(m_snapshots[m_nextToRender].state != SlotState::Queued)
+                {
+                    break;
+                }
+                snapshot = &m_snapshots[m_nextToRender];
+                snapshot->state = SlotState::Rendering;
+            }
+
+            {
+                APP_PROFILE_SCOPE("RenderThreadFrame");
+
+                m_window.WaitForNextFrame();
+                if(snapshot->inputTime != Clock::time_point{})
+                {
+                    m_window.OnInput(snapshot->inputTime);
+                }
+
+                m_render(snapshot->drawData);
+
+                std::chrono::microseconds inputLatency{};
+                {
+                    APP_PROFILE_SCOPE("SwapWindow");
+                    inputLatency = m_window.Present();
+                }
+                if(m_presented)
+                {
+                    m_presented(snapshot->inputTime != Clock::time_point{} ? inputLatency : std::chrono::microseconds{});
+                }
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                snapshot->state = SlotState::Free;
+                m_nextToRender = (m_nextToRender + 1) % m_snapshots.size();
+            }
+            m_slotFreed.notify_one();
+        }
+
+        SDL_GL_MakeCurrent(m_window.GetNativeWindow(), nullptr);
+    }
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <imgui.h>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace App {
+
+    class Window;
+
+    // Renders and presents on a thread of its own that owns the window's GL
+    // context, so the next ImGui frame is built while the previous one is on
+    // the GPU or blocked in the swap. Each submitted frame is copied into one
+    // of two snapshots: the UI thread fills one while the other is rendered,
+    // and Submit() waits when both are in flight, which paces the UI thread.
+    // Only this thread may touch GL while it runs, including ImGui draw
+    // callbacks, which are called from here.
+    class RenderThread
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Draws the snapshot into the current framebuffer, the swap follows.
+        using RenderCallback = std::function<void(ImDrawData& drawData)>;
+        // Called after every present with the frame's input-to-present
+        // latency, zero when it carried no input.
+        using PresentCallback = std::function<void(std::chrono::microseconds inputLatency)>;
+
+        // The window's context must be current on the calling thread, which
+        // has to be the one owning the ImGui context.
+        RenderThread(Window& window, RenderCallback render, PresentCallback presented);
+        // Presents what was submitted, then makes the context current on the
+        // calling thread again.
+        ~RenderThread();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread(RenderThread&&) = delete;
+        RenderThread& operator=(RenderThread other) = delete;
+        RenderThread& operator=(RenderThread&& other) = delete;
+
+        // UI thread only, before polling events: waits until the next Submit()
+        // would not block, so the input of the frame is not built and then
+        // left waiting behind two frames still in flight.
+        void WaitForFreeSnapshot();
+        // UI thread only, right after ImGui::Render(). inputTime is the
+        // earliest input this frame consumed, time_point{} without any.
+        void Submit(const ImDrawData& drawData, Clock::time_point inputTime);
+
+    private:
+        enum class SlotState
+        {
+            Free,
+            Queued,
+            Rendering
+        };
+
+        struct Snapshot
+        {
+            ImDrawData drawData{};
+            // Reused every frame, the lists only grow.
+            std::vector<ImDrawList*> lists{};
+#if IMGUI_VERSION_NUM < 18980
+            std::vector<ImDrawList*> listPointers{};
+#endif
+            Clock::time_point inputTime{};
+            SlotState state{SlotState::Free};
+        };
+
+        static void Copy(const ImDrawData& source, Snapshot& target);
+        void RenderLoop();
+
+        Window& m_window;
+        RenderCallback m_render;
+        PresentCallback m_presented;
+
+        std::mutex m_mutex;
+        std::condition_variable m_slotFreed;
+        std::condition_variable m_frameQueued;
+        std::array<Snapshot, 2> m_snapshots{};
+        // Both sides alternate between the snapshots, so frames stay in order.
+        std::size_t m_nextToSubmit{0};
+        std::size_t m_nextToRender{0};
+        bool m_stopRequested{false};
+
+        std::thread m_thread;
+    };
+
+}
@@ -0,0 +1,43 @@
+#include "SampleItems.hpp"
+#include <utility>
+
+namespace App {
+
+    void SampleItems::Create(Database& database, const std::int64_t rowCount, Database::Callback onDone)
+    {
+        database.Execute("CREATE TABLE IF NOT EXISTS items("
+                         "id INTEGER PRIMARY KEY, "
+                         "name TEXT NOT NULL, "
+                         "category TEXT NOT NULL, "
+                         "amount REAL NOT NULL, "
+                         "created INTEGER NOT NULL)");
+
+        // Generated inside SQLite, a million rows take about a second. The
+        // multipliers scatter the values so no index is in key order.
+        database.Execute("INSERT INTO items(id, name, category, amount, created) "
+                         "WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < ?) "
+                         "SELECT n, "
+                         "printf('Item %08d', (n * 2654435761) % 100000000), "
+                         "CASE n % 5 WHEN 0 THEN 'Alpha' WHEN 1 THEN 'Bravo' WHEN 2 THEN 'Charlie' WHEN 3 THEN 'Delta' ELSE 'Echo' END, "
+                         "((n * 48271) % 1000000) / 100.0, "
+                         "1600000000 + (n * 69069) % 100000000 "
+                         "FROM seq WHERE NOT EXISTS (SELECT 1 FROM items)",
+                         {rowCount});
+
+        database.Execute("CREATE INDEX IF NOT EXISTS items_name ON items(name)");
+        database.Execute("CREATE INDEX IF NOT EXISTS items_category ON items(category)");
+        database.Execute("CREATE INDEX IF NOT EXISTS items_amount ON items(amount)");
+        database.Execute("CREATE INDEX IF NOT EXISTS items_created ON items(created)", {}, std::move(onDone));
+    }
+
+    TablePager::Settings SampleItems::GetPagerSettings()
+    {
+        TablePager::Settings settings{};
+        settings.table = "items";
+        settings.keyColumn = "id";
+        settings.columns = {"id", "name", "category", "amount", "created"};
+        settings.filterColumns = {"name", "category"};
+        return settings;
+    }
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include "Core/Database.hpp"
+#include "Core/TablePager.hpp"
+
+namespace App {
+
+    // A synthetic "items" table of any size for the data table and table-bench:
+    // an integer key, a unique-looking name, one of five categories, an amount
+    // and a timestamp, all deterministic, with an index on every column so any
+    // of them can be sorted by in a keyset scan.
+    class SampleItems
+    {
+    public:
+        SampleItems() = delete;
+
+        // Queues the table, rowCount rows unless it has rows already, and the
+        // indexes as one write batch. onDone runs once they are committed.
+        static void Create(Database& database, std::int64_t rowCount, Database::Callback onDone = {});
+        // Shows every column, filters by name and category.
+        [[nodiscard]] static TablePager::Settings GetPagerSettings();
+    };
+
+}
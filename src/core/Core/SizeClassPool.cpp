@@ -0,0 +1,147 @@
+#include "SizeClassPool.hpp"
+#include <algorithm>
+#include <new>
+
+namespace App {
+
+    namespace {
+        // In front of every block: which class it came from, so Free() needs
+        // no size. Keeps the payload aligned like operator new's.
+        constexpr std::size_t HeaderSize{alignof(std::max_align_t)};
+        static_assert(HeaderSize >= sizeof(std::uint32_t), "The header holds the class index.");
+
+        constexpr std::uint32_t LargeBlock{0xFFFFFFFFU};
+
+        std::byte* ToBlock(void* pointer)
+        {
+            return static_cast<std::byte*>(pointer) - HeaderSize;
+        }
+
+        std::uint32_t& GetClassTag(std::byte* block)
+        {
+            return *reinterpret_cast<std::uint32_t*>(block);
+        }
+    }
+
+    SizeClassPool::SizeClassPool() : SizeClassPool(Settings{}) {}
+
+    SizeClassPool::SizeClassPool(const Settings& settings)
+            : m_slabSize(std::max(settings.slabSize, HeaderSize + LargestClass))
+    {
+    }
+
+    SizeClassPool::~SizeClassPool()
+    {
+        for(SizeClass& sizeClass: m_classes)
+        {
+            for(std::byte* slab: sizeClass.slabs)
+            {
+                ::operator delete(slab);
+            }
+        }
+    }
+
+    void* SizeClassPool::Allocate(const std::size_t size)
+    {
+        const std::size_t index{GetClassIndex(size)};
+        if(index == ClassCount)
+        {
+            auto* const block{static_cast<std::byte*>(::operator new(HeaderSize + size))};
+            GetClassTag(block) = LargeBlock;
+            m_largeAllocations.fetch_add(1, std::memory_order_relaxed);
+            m_liveBlocks.fetch_add(1, std::memory_order_relaxed);
+            return block + HeaderSize;
+        }
+
+        SizeClass& sizeClass{m_classes[index]};
+        FreeBlock* freeBlock{nullptr};
+        {
+            const std::lock_guard<std::mutex> lock{sizeClass.mutex};
+            if(sizeClass.freeList == nullptr)
+            {
+                Refill(sizeClass, index);
+            }
+            freeBlock = sizeClass.freeList;
+            sizeClass.freeList = freeBlock->next;
+        }
+
+        auto* const block{reinterpret_cast<std::byte*>(freeBlock)};
+        GetClassTag(block) = static_cast<std::uint32_t>(index);
+        m_liveBlocks.fetch_add(1, std::memory_order_relaxed);
+        return block + HeaderSize;
+    }
+
+    void SizeClassPool::Free(void* pointer)
+    {
+        if(pointer == nullptr)
+        {
+            return;
+        }
+
+        std::byte* const block{ToBlock(pointer)};
+        const std::uint32_t index{GetClassTag(block)};
+        m_liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+        if(index == LargeBlock)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        SizeClass& sizeClass{m_classes[index]};
+        auto* const freeBlock{reinterpret_cast<FreeBlock*>(block)};
+        const std::lock_guard<std::mutex> lock{sizeClass.mutex};
+        freeBlock->next = sizeClass.freeList;
+        sizeClass.freeList = freeBlock;
+    }
+
+    void* SizeClassPool::AllocateCallback(const std::size_t size, void* pool)
+    {
+        return static_cast<SizeClassPool*>(pool)->Allocate(size);
+    }
+
+    void SizeClassPool::FreeCallback(void* pointer, void* pool)
+    {
+        static_cast<SizeClassPool*>(pool)->Free(pointer);
+    }
+
+    SizeClassPool::Stats SizeClassPool::GetStats() const
+    {
+        Stats stats{};
+        stats.liveBlocks = m_liveBlocks.load(std::memory_order_relaxed);
+        stats.slabs = m_slabs.load(std::memory_order_relaxed);
+        stats.slabBytes = m_slabBytes.load(std::memory_order_relaxed);
+        stats.largeAllocations = m_largeAllocations.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    std::size_t SizeClassPool::GetClassIndex(const std::size_t size)
+    {
+        std::size_t index{0};
+        for(std::size_t classSize = SmallestClass; classSize < size && index < ClassCount; classSize <<= 1U)
+        {
+            ++index;
+        }
+        return index;
+    }
+
+    void SizeClassPool::Refill(SizeClass& sizeClass, const std::size_t index)
+    {
+        const std::size_t blockSize{HeaderSize + (SmallestClass << index)};
+        const std::size_t blockCount{m_slabSize / blockSize};
+
+        auto* const slab{static_cast<std::byte*>(::operator new(blockCount * blockSize))};
+        sizeClass.slabs.push_back(slab);
+
+        // Threaded back to front, so blocks are handed out in address order.
+        for(std::size_t i = blockCount; i > 0; --i)
+        {
+            auto* const freeBlock{reinterpret_cast<FreeBlock*>(slab + (i - 1) * blockSize)};
+            freeBlock->next = sizeClass.freeList;
+            sizeClass.freeList = freeBlock;
+        }
+
+        m_slabs.fetch_add(1, std::memory_order_relaxed);
+        m_slabBytes.fetch_add(blockCount * blockSize, std::memory_order_relaxed);
+    }
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace App {
+
+    // Fixed-size blocks in power-of-two classes from 16 bytes to 4 KiB, for
+    // objects that outlive a frame but come and go all the time: ImGui's
+    // buffers, container nodes. Freed blocks go onto their class's free list
+    // and are handed out again, the heap is only asked for another slab once
+    // a class ran dry, so a steady state stops allocating. Larger requests go
+    // to the heap directly. Slabs are returned only when the pool is
+    // destroyed. Safe from any thread, each class has its own lock.
+    class SizeClassPool
+    {
+    public:
+        struct Settings
+        {
+            // Per slab, a class carves it into as many blocks as fit.
+            std::size_t slabSize{64 * 1024};
+        };
+
+        struct Stats
+        {
+            // Blocks handed out and not freed yet, large ones included.
+            std::size_t liveBlocks{0};
+            std::size_t slabs{0};
+            std::size_t slabBytes{0};
+            // Requests above the largest class, each one a heap allocation.
+            std::size_t largeAllocations{0};
+        };
+
+        SizeClassPool();
+        explicit SizeClassPool(const Settings& settings);
+        // Everything still allocated from the pool becomes invalid.
+        ~SizeClassPool();
+
+        SizeClassPool(const SizeClassPool&) = delete;
+        SizeClassPool(SizeClassPool&&) = delete;
+        SizeClassPool& operator=(SizeClassPool other) = delete;
+        SizeClassPool& operator=(SizeClassPool&& other) = delete;
+
+        // Aligned like operator new. Never returns null, throws std::bad_alloc.
+        [[nodiscard]] void* Allocate(std::size_t size);
+        // Takes null, like free().
+        void Free(void* pointer);
+
+        // C-style hooks with the pool as user data, e.g. for ImGui::SetAllocatorFunctions().
+        static void* AllocateCallback(std::size_t size, void* pool);
+        static void FreeCallback(void* pointer, void* pool);
+
+        [[nodiscard]] Stats GetStats() const;
+
+        // Never destroyed, so containers in other statics may still free into
+        // it while the process exits. Its slabs go back with the process.
+        static SizeClassPool& Get()
+        {
+            static auto* instance{new SizeClassPool{}};
+            return *instance;
+        }
+
+    private:
+        static constexpr std::size_t ClassCount{9};
+        static constexpr std::size_t SmallestClass{16};
+        static constexpr std::size_t LargestClass{SmallestClass << (ClassCount - 1)};
+
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        struct SizeClass
+        {
+            std::mutex mutex;
+            FreeBlock* freeList{nullptr};
+            std::vector<std::byte*> slabs{};
+        };
+
+        [[nodiscard]] static std::size_t GetClassIndex(std::size_t size);
+        // With the class locked.
+        void Refill(SizeClass& sizeClass, std::size_t index);
+
+        std::size_t m_slabSize{0};
+        std::array<SizeClass, ClassCount> m_classes{};
+        std::atomic<std::size_t> m_liveBlocks{0};
+        std::atomic<std::size_t> m_slabs{0};
+        std::atomic<std::size_t> m_slabBytes{0};
+        std::atomic<std::size_t> m_largeAllocations{0};
+    };
+
+    // For standard containers whose nodes churn, e.g. a deque used as a queue.
+    template<typename T>
+    class PoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        PoolAllocator() noexcept : m_pool(&SizeClassPool::Get()) {}
+        explicit PoolAllocator(SizeClassPool& pool) noexcept : m_pool(&pool) {}
+
+        template<typename U>
+        // Rebinding, as containers do for their nodes, keeps the pool.
+        // NOLINTNEXTLINE(google-explicit-constructor)
+        PoolAllocator(const PoolAllocator<U>& other) noexcept : m_pool(&other.GetPool())
+        {}
+
+        [[nodiscard]] T* allocate(const std::size_t count)
+        {
+            return static_cast<T*>(m_pool->Allocate(count * sizeof(T)));
+        }
+
+        void deallocate(T* pointer, const std::size_t /*count*/) noexcept
+        {
+            m_pool->Free(pointer);
+        }
+
+        [[nodiscard]] SizeClassPool& GetPool() const noexcept
+        {
+            return *m_pool;
+        }
+
+        template<typename U>
+        friend bool operator==(const PoolAllocator& lhs, const PoolAllocator<U>& rhs) noexcept
+        {
+            return &lhs.GetPool() == &rhs.GetPool();
+        }
+
+        template<typename U>
+        friend bool operator!=(const PoolAllocator& lhs, const PoolAllocator<U>& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        SizeClassPool* m_pool;
+    };
+
+}
@@ -0,0 +1,262 @@
+#include "StartupGraph.hpp"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    StartupGraph::StartupGraph() : StartupGraph(Settings{}) {}
+
+    StartupGraph::StartupGraph(const Settings& settings) : m_workerCount(settings.workerCount)
+    {
+        if(m_workerCount == 0)
+        {
+            m_workerCount = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 4);
+        }
+    }
+
+    StartupGraph::~StartupGraph()
+    {
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            m_stopping = true;
+        }
+        m_workerWakeUp.notify_all();
+
+        for(std::thread& worker: m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    StartupGraph::TaskId StartupGraph::Add(std::string name,
+                                           const Affinity affinity,
+                                           std::function<void()> work,
+                                           const std::vector<TaskId>& dependencies)
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        assert(!m_started);
+
+        const TaskId id{m_tasks.size()};
+        for(const TaskId dependency: dependencies)
+        {
+            assert(dependency < id);
+            m_tasks[dependency].dependents.push_back(id);
+        }
+
+        Task task{};
+        task.descriptor = &Debug::Instrumentor::Get().CreateDescriptor(name, Debug::ProfileCategory::Scope);
+        task.affinity = affinity;
+        task.work = std::move(work);
+        task.pendingDependencies = dependencies.size();
+        m_tasks.push_back(std::move(task));
+        return id;
+    }
+
+    StartupGraph::TaskId StartupGraph::AddGate(std::string name)
+    {
+        const TaskId id{Add(std::move(name), Affinity::MainThread, nullptr)};
+
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_tasks[id].gate = true;
+        return id;
+    }
+
+    void StartupGraph::Start()
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        if(m_started)
+        {
+            return;
+        }
+        m_started = true;
+
+        std::size_t workerTasks{0};
+        for(TaskId id = 0; id < m_tasks.size(); ++id)
+        {
+            const Task& task{m_tasks[id]};
+            workerTasks += task.affinity == Affinity::Worker ? 1 : 0;
+            if(task.pendingDependencies == 0 && !task.gate)
+            {
+                MakeReady(id);
+            }
+        }
+
+        const std::size_t workerCount{std::min(m_workerCount, workerTasks)};
+        for(std::size_t i = 0; i < workerCount; ++i)
+        {
+            m_workers.emplace_back(&StartupGraph::WorkerLoop, this);
+        }
+    }
+
+    void StartupGraph::Open(const TaskId gate)
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        assert(m_started);
+
+        if(gate < m_tasks.size() && m_tasks[gate].gate && !m_tasks[gate].finished)
+        {
+            Finish(gate, true);
+        }
+    }
+
+    void StartupGraph::Wait(const TaskId task)
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        assert(m_started && task < m_tasks.size());
+
+        while(true)
+        {
+            RunMainQueue(lock);
+            if(m_tasks[task].finished)
+            {
+                break;
+            }
+            m_mainWakeUp.wait(lock, [this, task] { return !m_mainQueue.empty() || m_tasks[task].finished; });
+        }
+
+        const std::exception_ptr error{std::exchange(m_error, nullptr)};
+        lock.unlock();
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void StartupGraph::Poll()
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        RunMainQueue(lock);
+
+        const std::exception_ptr error{std::exchange(m_error, nullptr)};
+        lock.unlock();
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool StartupGraph::IsFinished() const
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        return m_finishedCount == m_tasks.size();
+    }
+
+    void StartupGraph::SetMainThreadNotifier(std::function<void()> notifier)
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_mainThreadNotifier = std::move(notifier);
+    }
+
+    void StartupGraph::WorkerLoop()
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while(true)
+        {
+            m_workerWakeUp.wait(lock, [this] {
+                return m_stopping || !m_workerQueue.empty() || m_finishedCount == m_tasks.size();
+            });
+            if(m_stopping || m_workerQueue.empty())
+            {
+                return;
+            }
+
+            const TaskId id{m_workerQueue.front()};
+            m_workerQueue.pop_front();
+
+            lock.unlock();
+            const bool succeeded{Execute(id)};
+            lock.lock();
+
+            Finish(id, succeeded);
+        }
+    }
+
+    bool StartupGraph::Execute(const TaskId id)
+    {
+        // Only this thread touches the work of a dequeued task, and m_tasks no
+        // longer grows once started.
+        Task& task{m_tasks[id]};
+        const Debug::InstrumentationTimer timer{*task.descriptor};
+
+        try
+        {
+            task.work();
+            return true;
+        }
+        catch(...)
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            if(!m_error)
+            {
+                m_error = std::current_exception();
+            }
+            return false;
+        }
+    }
+
+    void StartupGraph::Finish(const TaskId id, const bool succeeded)
+    {
+        Task& task{m_tasks[id]};
+        task.finished = true;
+        task.work = nullptr;
+        ++m_finishedCount;
+
+        for(const TaskId dependentId: task.dependents)
+        {
+            Task& dependent{m_tasks[dependentId]};
+            dependent.skipped = dependent.skipped || !succeeded;
+            if(--dependent.pendingDependencies == 0 && !dependent.gate)
+            {
+                MakeReady(dependentId);
+            }
+        }
+
+        m_mainWakeUp.notify_all();
+        if(m_finishedCount == m_tasks.size())
+        {
+            m_workerWakeUp.notify_all();
+        }
+    }
+
+    void StartupGraph::MakeReady(const TaskId id)
+    {
+        Task& task{m_tasks[id]};
+        if(task.skipped)
+        {
+            Finish(id, false);
+            return;
+        }
+
+        if(task.affinity == Affinity::Worker)
+        {
+            m_workerQueue.push_back(id);
+            m_workerWakeUp.notify_one();
+            return;
+        }
+
+        m_mainQueue.push_back(id);
+        m_mainWakeUp.notify_all();
+        if(m_mainThreadNotifier)
+        {
+            m_mainThreadNotifier();
+        }
+    }
+
+    void StartupGraph::RunMainQueue(std::unique_lock<std::mutex>& lock)
+    {
+        while(!m_mainQueue.empty())
+        {
+            const TaskId id{m_mainQueue.front()};
+            m_mainQueue.pop_front();
+
+            lock.unlock();
+            const bool succeeded{Execute(id)};
+            lock.lock();
+
+            Finish(id, succeeded);
+        }
+    }
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace App {
+
+    namespace Debug {
+        struct ScopeDescriptor;
+    }
+
+    // Initialization steps with dependencies and a thread affinity. Worker
+    // tasks run on a few threads of their own as soon as their dependencies
+    // finished, main-thread tasks run inside Wait() or Poll() on the thread
+    // that owns the graph. A gate is a task without work that finishes when
+    // opened, e.g. once the first frame is on screen, so anything depending
+    // on it is deferred until then. Every task is a scope named after it in
+    // the Instrumentor trace, on the thread it ran on.
+    class StartupGraph
+    {
+    public:
+        enum class Affinity
+        {
+            MainThread,
+            Worker
+        };
+
+        using TaskId = std::size_t;
+
+        struct Settings
+        {
+            // Zero picks one per core, at most four.
+            std::size_t workerCount{0};
+        };
+
+        StartupGraph();
+        explicit StartupGraph(const Settings& settings);
+        // Tasks not started yet are dropped, running ones are waited for.
+        ~StartupGraph();
+
+        StartupGraph(const StartupGraph&) = delete;
+        StartupGraph(StartupGraph&&) = delete;
+        StartupGraph& operator=(StartupGraph other) = delete;
+        StartupGraph& operator=(StartupGraph&& other) = delete;
+
+        // Before Start() only, dependencies are added first.
+        TaskId Add(std::string name, Affinity affinity, std::function<void()> work, const std::vector<TaskId>& dependencies = {});
+        TaskId AddGate(std::string name);
+
+        void Start();
+        // Safe from any thread.
+        void Open(TaskId gate);
+
+        // Runs main-thread tasks as they become ready until the task finished.
+        // Rethrows the first exception a task threw, its dependents are skipped.
+        void Wait(TaskId task);
+        // Runs the main-thread tasks that are ready and returns, e.g. once per frame.
+        void Poll();
+        [[nodiscard]] bool IsFinished() const;
+
+        // Called from any thread when a main-thread task became ready, with the
+        // graph locked. Typically wakes up an idle main loop to Poll().
+        void SetMainThreadNotifier(std::function<void()> notifier);
+
+    private:
+        struct Task
+        {
+            Affinity affinity{Affinity::MainThread};
+            std::function<void()> work;
+            std::vector<TaskId> dependents;
+            std::size_t pendingDependencies{0};
+            bool gate{false};
+            bool skipped{false};
+            bool finished{false};
+            const Debug::ScopeDescriptor* descriptor{nullptr};
+        };
+
+        void WorkerLoop();
+        // Without m_mutex held, returns false when the task threw.
+        bool Execute(TaskId id);
+        // Both with m_mutex held.
+        void Finish(TaskId id, bool succeeded);
+        void MakeReady(TaskId id);
+        // Runs the queued main-thread tasks, m_mutex is released around each.
+        void RunMainQueue(std::unique_lock<std::mutex>& lock);
+
+        std::vector<Task> m_tasks{};
+        std::deque<TaskId> m_workerQueue{};
+        std::deque<TaskId> m_mainQueue{};
+        std::size_t m_finishedCount{0};
+        std::size_t m_workerCount{0};
+        std::exception_ptr m_error{};
+        std::function<void()> m_mainThreadNotifier{};
+        bool m_started{false};
+        bool m_stopping{false};
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_workerWakeUp;
+        std::condition_variable m_mainWakeUp;
+        std::vector<std::thread> m_workers{};
+    };
+
+}
@@ -0,0 +1,567 @@
+#include "TablePager.hpp"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include "Core/Instrumentor.hpp"
+#include "Core/Log.hpp"
+
+namespace App {
+
+    namespace {
+        // Beyond it the bounds of pages no longer loaded are forgotten, a few MiB at most.
+        constexpr std::size_t MaxBounds{16384};
+
+        std::string QuoteIdentifier(const std::string& name)
+        {
+            std::string quoted{"\""};
+            for(const char c: name)
+            {
+                quoted += c;
+                if(c == '"')
+                {
+                    quoted += c;
+                }
+            }
+            quoted += '"';
+            return quoted;
+        }
+
+        // Matches text anywhere, with LIKE's wildcards in it taken literally.
+        std::string LikePattern(const std::string& text)
+        {
+            std::string pattern{"%"};
+            for(const char c: text)
+            {
+                if(c == '%' || c == '_' || c == '\\')
+                {
+                    pattern += '\\';
+                }
+                pattern += c;
+            }
+            pattern += '%';
+            return pattern;
+        }
+    }
+
+    TablePager::TablePager(Database& database, const Settings& settings)
+            : m_database(database), m_settings(settings), m_self(std::make_shared<TablePager*>(this))
+    {
+        m_settings.pageSize = std::max<std::size_t>(m_settings.pageSize, 1);
+        m_settings.maxPendingQueries = std::max<std::size_t>(m_settings.maxPendingQueries, 1);
+        BuildQueries();
+    }
+
+    void TablePager::SetOrder(const std::size_t column, const bool descending)
+    {
+        // The key column itself sorts like KeyOrder, which compares the key alone.
+        const std::size_t orderColumn{column < m_settings.columns.size() && m_settings.columns[column] != m_settings.keyColumn ? column : KeyOrder};
+        if(orderColumn == m_orderColumn && descending == m_descending)
+        {
+            return;
+        }
+
+        m_orderColumn = orderColumn;
+        m_descending = descending;
+        BuildQueries();
+        StartOver();
+    }
+
+    void TablePager::SetFilter(const std::string& text)
+    {
+        if(text == m_filter)
+        {
+            return;
+        }
+
+        m_filter = text;
+        m_pattern = LikePattern(text);
+        BuildQueries();
+        StartOver();
+    }
+
+    void TablePager::Refresh()
+    {
+        StartOver();
+    }
+
+    void TablePager::Request(std::int64_t first, std::int64_t end)
+    {
+        APP_PROFILE_FUNCTION();
+
+        ++m_useCounter;
+        if(!m_error.empty())
+        {
+            return;
+        }
+        if(m_rowCount < 0 && !m_counting)
+        {
+            FetchCount();
+        }
+
+        // Nothing shown yet still loads the first page, it may be all there is.
+        first = std::max<std::int64_t>(first, 0);
+        end = std::max(end, first + 1);
+
+        const std::int64_t pageSize{GetPageSize()};
+        std::int64_t firstPage{first / pageSize};
+        std::int64_t lastPage{(end - 1) / pageSize};
+        std::int64_t lastRowPage{std::numeric_limits<std::int64_t>::max()};
+        if(m_rowCount >= 0)
+        {
+            lastRowPage = std::max<std::int64_t>(m_rowCount - 1, 0) / pageSize;
+            lastPage = std::min(lastPage, lastRowPage);
+            firstPage = std::min(firstPage, lastPage);
+        }
+
+        const auto prefetch{static_cast<std::int64_t>(m_settings.prefetchPages)};
+        const std::int64_t windowFirst{std::max<std::int64_t>(firstPage - prefetch, 0)};
+        const std::int64_t windowLast{std::min(lastPage + prefetch, lastRowPage)};
+        for(std::int64_t page = windowFirst; page <= windowLast; ++page)
+        {
+            if(const auto it{m_pages.find(page)}; it != m_pages.end())
+            {
+                it->second.lastUse = m_useCounter;
+            }
+        }
+
+        // What is shown first, then outwards, below before above as that is
+        // where scrolling usually goes.
+        for(std::int64_t page = firstPage; page <= lastPage; ++page)
+        {
+            FetchPage(page, true);
+        }
+        for(std::int64_t distance = 1; distance <= prefetch; ++distance)
+        {
+            if(lastPage + distance <= windowLast)
+            {
+                FetchPage(lastPage + distance, false);
+            }
+            if(firstPage - distance >= windowFirst)
+            {
+                FetchPage(firstPage - distance, false);
+            }
+        }
+
+        Evict(windowFirst, windowLast);
+    }
+
+    std::int64_t TablePager::GetRowCount() const
+    {
+        return m_rowCount >= 0 ? m_rowCount : m_rowsSeen;
+    }
+
+    bool TablePager::IsRowCountKnown() const
+    {
+        return m_rowCount >= 0;
+    }
+
+    const Database::Row* TablePager::GetRow(const std::int64_t index) const
+    {
+        if(index < 0)
+        {
+            return nullptr;
+        }
+
+        const std::int64_t pageSize{GetPageSize()};
+        const auto it{m_pages.find(index / pageSize)};
+        if(it == m_pages.end())
+        {
+            return nullptr;
+        }
+
+        const auto offset{static_cast<std::size_t>(index % pageSize)};
+        return offset < it->second.rows.size() ? &it->second.rows[offset] : nullptr;
+    }
+
+    bool TablePager::IsLoaded(const std::int64_t first, const std::int64_t end) const
+    {
+        if(end <= first)
+        {
+            return true;
+        }
+
+        const std::int64_t pageSize{GetPageSize()};
+        for(std::int64_t page = std::max<std::int64_t>(first, 0) / pageSize; page <= (end - 1) / pageSize; ++page)
+        {
+            if(m_pages.count(page) == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool TablePager::IsBusy() const
+    {
+        return !m_pendingPages.empty() || m_counting;
+    }
+
+    const std::string& TablePager::GetError() const
+    {
+        return m_error;
+    }
+
+    std::size_t TablePager::GetCachedPageCount() const
+    {
+        return m_pages.size();
+    }
+
+    const TablePager::Stats& TablePager::GetStats() const
+    {
+        return m_stats;
+    }
+
+    void TablePager::StartOver()
+    {
+        ++m_generation;
+        m_pages.clear();
+        m_bounds.clear();
+        m_pendingPages.clear();
+        m_rowCount = -1;
+        m_rowsSeen = 0;
+        m_counting = false;
+        m_error.clear();
+    }
+
+    void TablePager::BuildQueries()
+    {
+        m_keyExpr = QuoteIdentifier(m_settings.keyColumn);
+        m_sortExpr = m_orderColumn == KeyOrder ? m_keyExpr : QuoteIdentifier(m_settings.columns[m_orderColumn]);
+
+        // The shown columns, then what the next page's bound is taken from.
+        m_select.clear();
+        for(const std::string& column: m_settings.columns)
+        {
+            m_select += QuoteIdentifier(column) + ", ";
+        }
+        m_select += m_sortExpr + ", " + m_keyExpr;
+
+        m_where.clear();
+        if(m_orderColumn != KeyOrder)
+        {
+            // NULL is neither before nor after a bound, such rows could only
+            // ever show up on the first page. Left out of the count as well.
+            m_where = m_sortExpr + " IS NOT NULL";
+        }
+        if(!m_filter.empty() && !m_settings.filterColumns.empty())
+        {
+            std::string matches{};
+            for(const std::string& column: m_settings.filterColumns)
+            {
+                matches += matches.empty() ? "(" : " OR ";
+                matches += QuoteIdentifier(column) + " LIKE ? ESCAPE '\\'";
+            }
+            m_where += (m_where.empty() ? "" : " AND ") + matches + ")";
+        }
+    }
+
+    void TablePager::FetchPage(const std::int64_t page, const bool allowSeek)
+    {
+        if(m_pages.count(page) != 0 || m_pendingPages.count(page) != 0
+           || m_pendingQueries >= m_settings.maxPendingQueries)
+        {
+            return;
+        }
+
+        std::vector<Database::Value> params{};
+        AddFilterParams(params);
+        std::string condition{};
+        Fetch fetch{Fetch::Forward};
+
+        // The first page needs no bound, the others start where a neighbour
+        // ends, or are counted to when none is loaded.
+        if(page != 0)
+        {
+            if(const auto it{m_bounds.find(page)}; it != m_bounds.end())
+            {
+                condition = CompareToBound(it->second, false);
+                AddBoundParams(params, it->second);
+            }
+            else if(const auto next{m_bounds.find(page + 1)}; next != m_bounds.end())
+            {
+                // Read back from the next page's first row, the rows come in reverse.
+                fetch = Fetch::Backward;
+                condition = CompareToBound(next->second, true);
+                AddBoundParams(params, next->second);
+            }
+            else if(!allowSeek || m_pendingPages.count(page - 1) != 0 || m_pendingPages.count(page + 1) != 0)
+            {
+                // A neighbour on its way brings the bound, cheaper than counting there.
+                return;
+            }
+            else
+            {
+                fetch = Fetch::Seek;
+                condition = Compare(m_descending ? "<=" : ">=", SeekAnchor(page, params));
+            }
+        }
+
+        std::string sql{"SELECT " + m_select + " FROM " + QuoteIdentifier(m_settings.table)};
+        if(!m_where.empty() || !condition.empty())
+        {
+            sql += " WHERE " + m_where + (!m_where.empty() && !condition.empty() ? " AND " : "") + condition;
+        }
+        sql += OrderBy(fetch == Fetch::Backward);
+        sql += " LIMIT " + std::to_string(GetPageSize());
+
+        ++m_pendingQueries;
+        m_pendingPages.insert(page);
+        ++m_stats.pageQueries;
+        if(fetch == Fetch::Seek)
+        {
+            ++m_stats.seekQueries;
+        }
+
+        m_database.Query(std::move(sql),
+                         std::move(params),
+                         [self = std::weak_ptr<TablePager*>{m_self}, generation = m_generation, page, fetch](
+                                 const Database::Result& result) {
+                             if(const auto pager{self.lock()})
+                             {
+                                 (*pager)->OnPage(generation, page, fetch, result);
+                             }
+                         });
+    }
+
+    void TablePager::FetchCount()
+    {
+        std::string sql{"SELECT count(*) FROM " + QuoteIdentifier(m_settings.table)};
+        if(!m_where.empty())
+        {
+            sql += " WHERE " + m_where;
+        }
+        std::vector<Database::Value> params{};
+        AddFilterParams(params);
+
+        ++m_pendingQueries;
+        m_counting = true;
+        ++m_stats.countQueries;
+
+        m_database.Query(std::move(sql),
+                         std::move(params),
+                         [self = std::weak_ptr<TablePager*>{m_self}, generation = m_generation](
+                                 const Database::Result& result) {
+                             if(const auto pager{self.lock()})
+                             {
+                                 (*pager)->OnCount(generation, result);
+                             }
+                         });
+    }
+
+    void TablePager::OnPage(const std::uint64_t generation,
+                            const std::int64_t page,
+                            const Fetch fetch,
+                            const Database::Result& result)
+    {
+        APP_PROFILE_FUNCTION();
+
+        --m_pendingQueries;
+        if(generation != m_generation)
+        {
+            ++m_stats.staleResults;
+            return;
+        }
+        m_pendingPages.erase(page);
+
+        if(!result.Succeeded())
+        {
+            APP_WARN("Loading rows of {} failed: {}", m_settings.table, result.error);
+            m_error = result.error;
+            return;
+        }
+
+        Page& loaded{m_pages[page]};
+        loaded.rows = result.rows;
+        loaded.lastUse = m_useCounter;
+        if(fetch == Fetch::Backward)
+        {
+            std::reverse(loaded.rows.begin(), loaded.rows.end());
+        }
+
+        const std::size_t columnCount{m_settings.columns.size()};
+        if(!loaded.rows.empty())
+        {
+            const Database::Row& firstRow{loaded.rows.front()};
+            m_bounds[page] = {firstRow[columnCount], firstRow[columnCount + 1], true};
+            if(loaded.rows.size() == m_settings.pageSize)
+            {
+                const Database::Row& lastRow{loaded.rows.back()};
+                m_bounds.try_emplace(page + 1, Bound{lastRow[columnCount], lastRow[columnCount + 1], false});
+            }
+        }
+        for(Database::Row& row: loaded.rows)
+        {
+            row.resize(columnCount);
+        }
+
+        const std::int64_t end{page * GetPageSize() + static_cast<std::int64_t>(loaded.rows.size())};
+        m_rowsSeen = std::max(m_rowsSeen, end);
+        // A short page going forward is the last one, a count still out will agree.
+        // An empty one after a seek only says the offset was past the end.
+        if(loaded.rows.size() < m_settings.pageSize
+           && (fetch == Fetch::Forward || (fetch == Fetch::Seek && !loaded.rows.empty())))
+        {
+            m_rowCount = end;
+        }
+
+        if(m_bounds.size() > MaxBounds)
+        {
+            for(auto it{m_bounds.begin()}; it != m_bounds.end();)
+            {
+                it = m_pages.count(it->first) == 0 && m_pages.count(it->first - 1) == 0 ? m_bounds.erase(it) : std::next(it);
+            }
+        }
+    }
+
+    void TablePager::OnCount(const std::uint64_t generation, const Database::Result& result)
+    {
+        --m_pendingQueries;
+        if(generation != m_generation)
+        {
+            ++m_stats.staleResults;
+            return;
+        }
+        m_counting = false;
+
+        if(!result.Succeeded() || result.rows.empty() || result.rows.front().empty())
+        {
+            APP_WARN("Counting rows of {} failed: {}", m_settings.table, result.error);
+            m_error = result.error.empty() ? "no row count" : result.error;
+            return;
+        }
+
+        const Database::Value& count{result.rows.front().front()};
+        m_rowCount = std::holds_alternative<std::int64_t>(count) ? std::get<std::int64_t>(count) : 0;
+    }
+
+    void TablePager::Evict(const std::int64_t firstKept, const std::int64_t lastKept)
+    {
+        while(m_pages.size() > m_settings.cachedPages)
+        {
+            auto oldest{m_pages.end()};
+            for(auto it{m_pages.begin()}; it != m_pages.end(); ++it)
+            {
+                const bool kept{it->first >= firstKept && it->first <= lastKept};
+                if(!kept && (oldest == m_pages.end() || it->second.lastUse < oldest->second.lastUse))
+                {
+                    oldest = it;
+                }
+            }
+            if(oldest == m_pages.end())
+            {
+                // The requested window alone is more than the cache holds.
+                return;
+            }
+
+            m_pages.erase(oldest);
+            ++m_stats.evictedPages;
+        }
+    }
+
+    std::string TablePager::SeekAnchor(const std::int64_t page, std::vector<Database::Value>& params) const
+    {
+        // OFFSET walks the index one entry at a time, so it counts from the
+        // nearest spot known: the start, the end, or a page loaded before.
+        const std::int64_t pageSize{GetPageSize()};
+        const std::int64_t position{page * pageSize};
+        std::int64_t offset{position};
+        bool backward{false};
+        const Bound* from{nullptr};
+
+        if(m_rowCount > position && m_rowCount - 1 - position < offset)
+        {
+            offset = m_rowCount - 1 - position;
+            backward = true;
+        }
+        for(const auto& [boundPage, bound]: m_bounds)
+        {
+            // A bound starts its page, rows before it end at the page before.
+            const std::int64_t distance{boundPage > page ? boundPage * pageSize - 1 - position : position - boundPage * pageSize};
+            if(distance < offset)
+            {
+                offset = distance;
+                backward = boundPage > page;
+                from = &bound;
+            }
+        }
+
+        std::string where{m_where};
+        AddFilterParams(params);
+        if(from != nullptr)
+        {
+            where += (where.empty() ? "" : " AND ") + CompareToBound(*from, backward);
+            AddBoundParams(params, *from);
+        }
+        params.emplace_back(offset);
+
+        std::string anchor{"(SELECT " + m_sortExpr};
+        if(m_orderColumn != KeyOrder)
+        {
+            anchor += ", " + m_keyExpr;
+        }
+        anchor += " FROM " + QuoteIdentifier(m_settings.table);
+        if(!where.empty())
+        {
+            anchor += " WHERE " + where;
+        }
+        return anchor + OrderBy(backward) + " LIMIT 1 OFFSET ?)";
+    }
+
+    std::string TablePager::CompareToBound(const Bound& bound, const bool backward) const
+    {
+        // Descending only swaps the comparisons.
+        if(backward)
+        {
+            return Compare(bound.inclusive ? (m_descending ? ">" : "<") : (m_descending ? ">=" : "<="));
+        }
+        return Compare(bound.inclusive ? (m_descending ? "<=" : ">=") : (m_descending ? "<" : ">"));
+    }
+
+    std::string TablePager::OrderBy(const bool backward) const
+    {
+        const char* const direction{backward != m_descending ? " DESC" : " ASC"};
+        std::string order{" ORDER BY " + m_sortExpr + direction};
+        if(m_orderColumn != KeyOrder)
+        {
+            order += ", " + m_keyExpr + direction;
+        }
+        return order;
+    }
+
+    std::string TablePager::Compare(const char* op, const std::string& value) const
+    {
+        // The key alone when sorting by it, a row value of it twice would hide the index.
+        if(m_orderColumn == KeyOrder)
+        {
+            return m_keyExpr + " " + op + " " + (value.empty() ? "?" : value);
+        }
+        return "(" + m_sortExpr + ", " + m_keyExpr + ") " + op + " " + (value.empty() ? "(?, ?)" : value);
+    }
+
+    void TablePager::AddFilterParams(std::vector<Database::Value>& params) const
+    {
+        if(m_filter.empty())
+        {
+            return;
+        }
+        for(std::size_t i = 0; i < m_settings.filterColumns.size(); ++i)
+        {
+            params.emplace_back(m_pattern);
+        }
+    }
+
+    void TablePager::AddBoundParams(std::vector<Database::Value>& params, const Bound& bound) const
+    {
+        if(m_orderColumn != KeyOrder)
+        {
+            params.push_back(bound.sort);
+        }
+        params.push_back(bound.key);
+    }
+
+    std::int64_t TablePager::GetPageSize() const
+    {
+        return static_cast<std::int64_t>(m_settings.pageSize);
+    }
+
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Core/Database.hpp"
+
+namespace App {
+
+    // Pages through a table on the Database's read pool, sorted and filtered
+    // in SQL, for views that show a window of rows at a time. A page is found
+    // by keyset: rows after the last one of the page before it or before the
+    // first one of the page after it, which walks the sort column's index from
+    // that spot and costs the same on row 100 as on row 10 million. Only a
+    // jump to where no neighbour is loaded has to count its way there with
+    // OFFSET, once, on the index alone, and the pages around it follow by
+    // keyset again. Loaded pages are kept up to a limit, least recently shown
+    // go first. Results arrive through Database::DispatchCompleted().
+    class TablePager
+    {
+    public:
+        // SetOrder() by the key column.
+        static constexpr std::size_t KeyOrder{std::numeric_limits<std::size_t>::max()};
+
+        struct Settings
+        {
+            std::string table;
+            // Unique and never NULL, breaks ties so every row has one place in the order.
+            std::string keyColumn{"rowid"};
+            // Shown, in this order. Sorting by one is only fast with an index on
+            // it, and rows where it is NULL are left out of the pages and the
+            // row count while sorted by it.
+            std::vector<std::string> columns;
+            // Searched by SetFilter(), usually the text columns.
+            std::vector<std::string> filterColumns;
+            std::size_t pageSize{128};
+            // Loaded ahead of the requested rows, in both directions.
+            std::size_t prefetchPages{2};
+            std::size_t cachedPages{64};
+            // Queries out on the read pool at a time, stale ones included, so
+            // fast scrolling can not bury the readers.
+            std::size_t maxPendingQueries{4};
+        };
+
+        struct Stats
+        {
+            std::size_t pageQueries{0};
+            // Pages without a loaded neighbour, found by OFFSET.
+            std::size_t seekQueries{0};
+            std::size_t countQueries{0};
+            // Results of queries sent before the order or filter changed, dropped.
+            std::size_t staleResults{0};
+            std::size_t evictedPages{0};
+        };
+
+        TablePager(Database& database, const Settings& settings);
+        // Results still queued for it are dropped.
+        ~TablePager() = default;
+
+        TablePager(const TablePager&) = delete;
+        TablePager(TablePager&&) = delete;
+        TablePager& operator=(TablePager other) = delete;
+        TablePager& operator=(TablePager&& other) = delete;
+
+        // Index into Settings::columns, or KeyOrder. Starts over when it changed.
+        void SetOrder(std::size_t column, bool descending);
+        // Rows containing text in one of the filter columns, case-insensitive
+        // for ASCII, empty for all. Starts over when it changed.
+        void SetFilter(const std::string& text);
+        // Drops everything loaded and counts again, e.g. after the table changed.
+        void Refresh();
+
+        // Rows [first, end) are about to be shown. Loads them first, then the
+        // prefetch window around them. Call once per frame with what is visible.
+        void Request(std::int64_t first, std::int64_t end);
+
+        // The filtered row count once known, until then the rows seen so far.
+        [[nodiscard]] std::int64_t GetRowCount() const;
+        [[nodiscard]] bool IsRowCountKnown() const;
+        // The Settings::columns of the row, nullptr until its page arrived.
+        [[nodiscard]] const Database::Row* GetRow(std::int64_t index) const;
+        [[nodiscard]] bool IsLoaded(std::int64_t first, std::int64_t end) const;
+        // Queries of the current order and filter are still out.
+        [[nodiscard]] bool IsBusy() const;
+        // Of the last failed query, empty otherwise. Nothing more is loaded
+        // until the order, the filter or a Refresh() starts over.
+        [[nodiscard]] const std::string& GetError() const;
+        [[nodiscard]] std::size_t GetCachedPageCount() const;
+        [[nodiscard]] const Stats& GetStats() const;
+
+    private:
+        struct Page
+        {
+            std::vector<Database::Row> rows;
+            std::uint64_t lastUse{0};
+        };
+
+        // Where a page starts in the order: at the row with this sort value
+        // and key, or right after it.
+        struct Bound
+        {
+            Database::Value sort;
+            Database::Value key;
+            bool inclusive{true};
+        };
+
+        enum class Fetch
+        {
+            Forward,
+            Backward,
+            Seek
+        };
+
+        void StartOver();
+        void BuildQueries();
+        // Sends the query for the page unless it is loaded, on its way or has
+        // to wait for a neighbour. Without allowSeek only by keyset.
+        void FetchPage(std::int64_t page, bool allowSeek);
+        void FetchCount();
+        void OnPage(std::uint64_t generation, std::int64_t page, Fetch fetch, const Database::Result& result);
+        void OnCount(std::uint64_t generation, const Database::Result& result);
+        void Evict(std::int64_t firstKept, std::int64_t lastKept);
+
+        // The sort position of the page's first row as a subquery, with its
+        // parameters appended to params.
+        [[nodiscard]] std::string SeekAnchor(std::int64_t page, std::vector<Database::Value>& params) const;
+        // Rows from the bound on, or the rows before it when backward.
+        [[nodiscard]] std::string CompareToBound(const Bound& bound, bool backward) const;
+        [[nodiscard]] std::string OrderBy(bool backward) const;
+        // The sort position compared to value, the bound's placeholders when empty.
+        [[nodiscard]] std::string Compare(const char* op, const std::string& value = {}) const;
+        void AddFilterParams(std::vector<Database::Value>& params) const;
+        void AddBoundParams(std::vector<Database::Value>& params, const Bound& bound) const;
+        [[nodiscard]] std::int64_t GetPageSize() const;
+
+        Database& m_database;
+        Settings m_settings;
+        // Callbacks hold it weakly, the pager may be gone when they run.
+        std::shared_ptr<TablePager*> m_self;
+
+        std::size_t m_orderColumn{KeyOrder};
+        bool m_descending{false};
+        std::string m_filter{};
+        std::string m_pattern{};
+
+        // Built from the above: select list, filter condition, sort and key expressions.
+        std::string m_select{};
+        std::string m_where{};
+        std::string m_sortExpr{};
+        std::string m_keyExpr{};
+
+        // Bumped by StartOver(), results of an older one are stale.
+        std::uint64_t m_generation{0};
+        std::uint64_t m_useCounter{0};
+        std::unordered_map<std::int64_t, Page> m_pages{};
+        // Outlive evicted pages, a page that was loaded once never needs OFFSET again.
+        std::unordered_map<std::int64_t, Bound> m_bounds{};
+        std::unordered_set<std::int64_t> m_pendingPages{};
+        // All generations, the read pool is busy with stale queries as well.
+        std::size_t m_pendingQueries{0};
+
+        std::int64_t m_rowCount{-1};
+        std::int64_t m_rowsSeen{0};
+        bool m_counting{false};
+        std::string m_error{};
+        Stats m_stats{};
+    };
+
+}
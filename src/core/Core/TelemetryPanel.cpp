@@ -0,0 +1,98 @@
+#include "TelemetryPanel.hpp"
+#include <imgui.h>
+#include <implot.h>
+#include <algorithm>
+#include <cmath>
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    namespace {
+        constexpr double TwoPi{6.283185307179586};
+        // Longer frames, e.g. the window being dragged, do not make up for it all at once.
+        constexpr float MaxFrameSeconds{0.1F};
+    }
+
+    TelemetryPanel::TelemetryPanel(const Settings& settings) : m_settings(settings) {}
+
+    void TelemetryPanel::Render(bool* open)
+    {
+        if(!*open)
+        {
+            return;
+        }
+
+        APP_PROFILE_FUNCTION();
+
+        if(!m_paused)
+        {
+            Generate(static_cast<double>(std::min(ImGui::GetIO().DeltaTime, MaxFrameSeconds)));
+        }
+
+        if(ImGui::Begin("Telemetry", open))
+        {
+            DrawToolbar();
+
+            if(ImPlot::BeginPlot("##Signal", ImVec2(-1.0F, -1.0F), ImPlotFlags_NoMenus))
+            {
+                ImPlot::SetupAxes("s", nullptr);
+                ImPlot::SetupAxisLimits(ImAxis_Y1, -2.0, 2.0, ImGuiCond_Once);
+                if(m_following)
+                {
+                    const double last{m_series.GetLastX()};
+                    ImPlot::SetupAxisLimits(ImAxis_X1, last - m_settings.windowSeconds, last, ImGuiCond_Always);
+                }
+                m_series.Plot("Signal");
+                ImPlot::EndPlot();
+            }
+        }
+        ImGui::End();
+    }
+
+    void TelemetryPanel::Generate(const double seconds)
+    {
+        const std::size_t room{m_settings.maxSamples - std::min(m_series.GetSize(), m_settings.maxSamples)};
+        const auto count{std::min(static_cast<std::size_t>(seconds * m_settings.sampleRate), room)};
+        if(count == 0)
+        {
+            return;
+        }
+
+        m_xs.resize(count);
+        m_ys.resize(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const double t{static_cast<double>(m_generated + i) / m_settings.sampleRate};
+            // Numerical Recipes LCG, uniform in [-0.5, 0.5).
+            m_noise = m_noise * 1664525U + 1013904223U;
+            const double noise{static_cast<double>(m_noise >> 8) / 16777216.0 - 0.5};
+            m_xs[i] = t;
+            m_ys[i] = static_cast<float>(std::sin(TwoPi * 0.2 * t) + 0.3 * std::sin(TwoPi * 50.0 * t) + 0.2 * noise);
+        }
+        m_generated += count;
+        m_series.Append(m_xs.data(), m_ys.data(), count);
+    }
+
+    void TelemetryPanel::DrawToolbar()
+    {
+        ImGui::Checkbox("Follow", &m_following);
+        ImGui::SameLine();
+        ImGui::Checkbox("Pause", &m_paused);
+        ImGui::SameLine();
+        if(ImGui::Button("Clear"))
+        {
+            m_series.Clear();
+            m_generated = 0;
+        }
+
+        ImGui::SameLine();
+        const TimeSeries::Decimated& plotted{m_series.GetPlotted()};
+        ImGui::Text("%zu samples, %zu levels, %.1f MB, drawn %zu points from level %zu",
+                    m_series.GetSize(),
+                    m_series.GetLevelCount(),
+                    static_cast<double>(m_series.GetMemoryBytes()) / (1024.0 * 1024.0),
+                    plotted.xs.size(),
+                    plotted.level);
+    }
+
+}
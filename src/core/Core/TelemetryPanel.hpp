@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Core/TimeSeries.hpp"
+
+namespace App {
+
+    // "Telemetry" window streaming a synthetic signal into a TimeSeries at
+    // a high sample rate while it is open, to watch decimated plotting keep
+    // up with millions of points. Scroll or drag the plot to zoom and pan,
+    // Follow keeps the latest seconds in view.
+    class TelemetryPanel
+    {
+    public:
+        struct Settings
+        {
+            double sampleRate{100000.0};
+            // Appending stops here, about 12 bytes each.
+            std::size_t maxSamples{50'000'000};
+            // Shown while following.
+            double windowSeconds{10.0};
+        };
+
+        TelemetryPanel() : TelemetryPanel(Settings{}) {}
+        explicit TelemetryPanel(const Settings& settings);
+
+        TelemetryPanel(const TelemetryPanel&) = delete;
+        TelemetryPanel(TelemetryPanel&&) = delete;
+        TelemetryPanel& operator=(TelemetryPanel other) = delete;
+        TelemetryPanel& operator=(TelemetryPanel&& other) = delete;
+
+        // Call once per frame on the UI thread, returns right away while *open is false.
+        void Render(bool* open);
+
+    private:
+        // Appends the samples of the next seconds of the signal.
+        void Generate(double seconds);
+        void DrawToolbar();
+
+        Settings m_settings;
+        TimeSeries m_series{};
+        bool m_following{true};
+        bool m_paused{false};
+        // Sample index the signal continues from.
+        std::uint64_t m_generated{0};
+        std::uint32_t m_noise{1};
+        std::vector<double> m_xs{};
+        std::vector<float> m_ys{};
+    };
+
+}
@@ -0,0 +1,222 @@
+#include "TextureUploader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <glad/glad.h>
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    namespace {
+        constexpr std::size_t BytesPerPixel{4};
+
+        std::size_t Area(const DirtyRect& rect)
+        {
+            return static_cast<std::size_t>(rect.width) * static_cast<std::size_t>(rect.height);
+        }
+    }
+
+    TextureUploader::TextureUploader() : TextureUploader(Settings{})
+    {
+    }
+
+    TextureUploader::TextureUploader(const Settings& settings) : m_settings(settings)
+    {
+        APP_PROFILE_FUNCTION();
+
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        for(Buffer& buffer: m_ring)
+        {
+            glGenBuffers(1, &buffer.pbo);
+        }
+    }
+
+    TextureUploader::~TextureUploader()
+    {
+        APP_PROFILE_FUNCTION();
+
+        for(Buffer& buffer: m_ring)
+        {
+            if(buffer.fence != nullptr)
+            {
+                glDeleteSync(static_cast<GLsync>(buffer.fence));
+            }
+            glDeleteBuffers(1, &buffer.pbo);
+        }
+        glDeleteTextures(1, &m_texture);
+    }
+
+    void TextureUploader::Upload(const std::uint8_t* pixels,
+                                 const int width,
+                                 const int height,
+                                 const DirtyRect* rects,
+                                 const std::size_t rectCount)
+    {
+        APP_PROFILE_FUNCTION();
+
+        if(pixels == nullptr || width <= 0 || height <= 0)
+        {
+            return;
+        }
+
+        const DirtyRect surface{0, 0, width, height};
+        m_rects.clear();
+        if(width != m_width || height != m_height)
+        {
+            Resize(width, height);
+            m_rects.push_back(surface);
+        }
+        else
+        {
+            std::size_t dirtyArea{0};
+            for(std::size_t i = 0; i < rectCount; ++i)
+            {
+                // CEF reports view coordinates, clip them to the buffer to be safe.
+                const int x0{std::clamp(rects[i].x, 0, width)};
+                const int y0{std::clamp(rects[i].y, 0, height)};
+                const int x1{std::clamp(rects[i].x + rects[i].width, 0, width)};
+                const int y1{std::clamp(rects[i].y + rects[i].height, 0, height)};
+                if(x1 > x0 && y1 > y0)
+                {
+                    m_rects.push_back({x0, y0, x1 - x0, y1 - y0});
+                    dirtyArea += Area(m_rects.back());
+                }
+            }
+
+            if(m_rects.empty())
+            {
+                return;
+            }
+            // Overlapping rects are counted twice here, which only errs towards the full upload.
+            if(m_rects.size() > m_settings.maxRects
+               || static_cast<float>(dirtyArea) > m_settings.fullUploadThreshold * static_cast<float>(Area(surface)))
+            {
+                m_rects.assign(1, surface);
+            }
+        }
+
+        const bool full{m_rects.size() == 1 && Area(m_rects[0]) == Area(surface)};
+        std::size_t size{0};
+        for(const DirtyRect& rect: m_rects)
+        {
+            size += Area(rect) * BytesPerPixel;
+        }
+
+        Buffer& buffer{AcquireBuffer(size)};
+        auto* mapped{static_cast<std::uint8_t*>(glMapBufferRange(
+                GL_PIXEL_UNPACK_BUFFER,
+                0,
+                static_cast<GLsizeiptr>(size),
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT))};
+        if(mapped == nullptr)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return;
+        }
+
+        // Rects are packed one after another, each with its own row length.
+        const auto sourceStride{static_cast<std::size_t>(width) * BytesPerPixel};
+        std::size_t offset{0};
+        for(const DirtyRect& rect: m_rects)
+        {
+            const auto rowBytes{static_cast<std::size_t>(rect.width) * BytesPerPixel};
+            const std::uint8_t* source{pixels + static_cast<std::size_t>(rect.y) * sourceStride
+                                       + static_cast<std::size_t>(rect.x) * BytesPerPixel};
+            if(rowBytes == sourceStride)
+            {
+                std::memcpy(mapped + offset, source, rowBytes * static_cast<std::size_t>(rect.height));
+                offset += rowBytes * static_cast<std::size_t>(rect.height);
+                continue;
+            }
+            for(int row = 0; row < rect.height; ++row)
+            {
+                std::memcpy(mapped + offset, source, rowBytes);
+                source += sourceStride;
+                offset += rowBytes;
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        offset = 0;
+        for(const DirtyRect& rect: m_rects)
+        {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, rect.width);
+            glTexSubImage2D(GL_TEXTURE_2D,
+                            0,
+                            rect.x,
+                            rect.y,
+                            rect.width,
+                            rect.height,
+                            GL_BGRA,
+                            GL_UNSIGNED_INT_8_8_8_8_REV,
+                            reinterpret_cast<const void*>(offset));
+            offset += Area(rect) * BytesPerPixel;
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        ++m_stats.uploads;
+        m_stats.fullUploads += full ? 1 : 0;
+        m_stats.bytesUploaded += size;
+    }
+
+    unsigned int TextureUploader::GetTexture() const
+    {
+        return m_texture;
+    }
+
+    const TextureUploader::Stats& TextureUploader::GetStats() const
+    {
+        return m_stats;
+    }
+
+    void TextureUploader::Resize(const int width, const int height)
+    {
+        APP_PROFILE_FUNCTION();
+
+        m_width = width;
+        m_height = height;
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+    }
+
+    TextureUploader::Buffer& TextureUploader::AcquireBuffer(const std::size_t size)
+    {
+        m_ringIndex = (m_ringIndex + 1) % RingSize;
+        Buffer& buffer{m_ring[m_ringIndex]};
+
+        // Written unsynchronized below, so the GPU must be done with its previous upload.
+        if(buffer.fence != nullptr)
+        {
+            const auto fence{static_cast<GLsync>(buffer.fence)};
+            if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            {
+                APP_PROFILE_SCOPE("TextureUploader::Stall");
+                ++m_stats.stalls;
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            }
+            glDeleteSync(fence);
+            buffer.fence = nullptr;
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.pbo);
+        if(buffer.capacity < size)
+        {
+            // Sized for a full surface right away, rect uploads then never reallocate.
+            buffer.capacity = std::max(size, static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height)
+                                                     * BytesPerPixel);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(buffer.capacity), nullptr, GL_STREAM_DRAW);
+        }
+        return buffer;
+    }
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace App {
+
+    // Rectangle of a paint buffer in pixels, origin at the top left like CEF's CefRect.
+    struct DirtyRect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    // Streams an off-screen paint buffer (CEF OnPaint, BGRA, tightly packed)
+    // into a GL texture. Only the dirty rectangles are copied, into the next
+    // pixel buffer object of a small ring, and glTexSubImage2D then sources
+    // them from that PBO so the driver can transfer asynchronously. When the
+    // rectangles cover most of the surface one full upload replaces them.
+    //
+    // All calls need the GL context current.
+    class TextureUploader
+    {
+    public:
+        struct Settings
+        {
+            // Beyond this share of the surface a single full upload is cheaper than many rects.
+            float fullUploadThreshold{0.6F};
+            // More rects than this are merged into one full upload as well.
+            std::size_t maxRects{32};
+        };
+
+        struct Stats
+        {
+            std::uint64_t uploads{0};
+            std::uint64_t fullUploads{0};
+            std::uint64_t bytesUploaded{0};
+            // Times the next buffer of the ring was still being read by the GPU.
+            std::uint64_t stalls{0};
+        };
+
+        static constexpr std::size_t RingSize{3};
+
+        TextureUploader();
+        explicit TextureUploader(const Settings& settings);
+        ~TextureUploader();
+
+        TextureUploader(const TextureUploader&) = delete;
+        TextureUploader(TextureUploader&&) = delete;
+        TextureUploader& operator=(TextureUploader other) = delete;
+        TextureUploader& operator=(TextureUploader&& other) = delete;
+
+        // pixels holds width * height BGRA pixels. A size change reallocates
+        // the texture and uploads everything regardless of the rects.
+        void Upload(const std::uint8_t* pixels, int width, int height, const DirtyRect* rects, std::size_t rectCount);
+
+        [[nodiscard]] unsigned int GetTexture() const;
+        [[nodiscard]] const Stats& GetStats() const;
+
+    private:
+        struct Buffer
+        {
+            unsigned int pbo{0};
+            std::size_t capacity{0};
+            void* fence{nullptr};
+        };
+
+        void Resize(int width, int height);
+        Buffer& AcquireBuffer(std::size_t size);
+
+        Settings m_settings;
+        unsigned int m_texture{0};
+        int m_width{0};
+        int m_height{0};
+
+        std::array<Buffer, RingSize> m_ring{};
+        std::size_t m_ringIndex{0};
+        std::vector<DirtyRect> m_rects;
+        Stats m_stats{};
+    };
+
+}
@@ -0,0 +1,322 @@
+#include "TimeSeries.hpp"
+#include <implot.h>
+#include <algorithm>
+#include <limits>
+#include "Core/Instrumentor.hpp"
+#include "Core/MinMaxKernels.hpp"
+
+namespace App {
+
+    namespace {
+        constexpr std::size_t GroupSize{MinMaxKernels::GroupSize};
+    }
+
+    template<typename T>
+    std::size_t TimeSeries::Chunks<T>::GetSize() const
+    {
+        return m_size;
+    }
+
+    template<typename T>
+    std::size_t TimeSeries::Chunks<T>::GetCapacity() const
+    {
+        return m_chunks.size() * ChunkSize;
+    }
+
+    template<typename T>
+    const T& TimeSeries::Chunks<T>::operator[](const std::size_t index) const
+    {
+        return m_chunks[index >> ChunkShift][index & (ChunkSize - 1)];
+    }
+
+    template<typename T>
+    T* TimeSeries::Chunks<T>::GetWritable(std::size_t& length)
+    {
+        if(m_size == GetCapacity())
+        {
+            // Left uninitialized, only what Grow() covers is ever read.
+            m_chunks.emplace_back(new T[ChunkSize]);
+        }
+        const std::size_t offset{m_size & (ChunkSize - 1)};
+        length = ChunkSize - offset;
+        return m_chunks[m_size >> ChunkShift].get() + offset;
+    }
+
+    template<typename T>
+    void TimeSeries::Chunks<T>::Grow(const std::size_t count)
+    {
+        m_size += count;
+    }
+
+    template<typename T>
+    const T* TimeSeries::Chunks<T>::GetRun(const std::size_t index, std::size_t& length) const
+    {
+        const std::size_t offset{index & (ChunkSize - 1)};
+        length = std::min(ChunkSize - offset, m_size - index);
+        return m_chunks[index >> ChunkShift].get() + offset;
+    }
+
+    template<typename T>
+    void TimeSeries::Chunks<T>::Clear()
+    {
+        m_chunks.clear();
+        m_size = 0;
+    }
+
+    void TimeSeries::Append(const double x, const float y)
+    {
+        Append(&x, &y, 1);
+    }
+
+    void TimeSeries::Append(const double* xs, const float* ys, std::size_t count)
+    {
+        APP_PROFILE_FUNCTION();
+
+        // Both have the same chunk layout, the room left is the same.
+        while(count > 0)
+        {
+            std::size_t length{0};
+            double* const x{m_xs.GetWritable(length)};
+            float* const y{m_ys.GetWritable(length)};
+            const std::size_t copied{std::min(count, length)};
+            std::copy_n(xs, copied, x);
+            std::copy_n(ys, copied, y);
+            m_xs.Grow(copied);
+            m_ys.Grow(copied);
+
+            xs += copied;
+            ys += copied;
+            count -= copied;
+        }
+
+        ExtendLevels();
+    }
+
+    void TimeSeries::Clear()
+    {
+        m_xs.Clear();
+        m_ys.Clear();
+        m_levels.clear();
+    }
+
+    std::size_t TimeSeries::GetSize() const
+    {
+        return m_ys.GetSize();
+    }
+
+    std::size_t TimeSeries::GetLevelCount() const
+    {
+        return m_levels.size();
+    }
+
+    double TimeSeries::GetFirstX() const
+    {
+        return GetSize() > 0 ? m_xs[0] : 0.0;
+    }
+
+    double TimeSeries::GetLastX() const
+    {
+        return GetSize() > 0 ? m_xs[GetSize() - 1] : 0.0;
+    }
+
+    std::size_t TimeSeries::GetMemoryBytes() const
+    {
+        std::size_t bytes{m_xs.GetCapacity() * sizeof(double) + m_ys.GetCapacity() * sizeof(float)};
+        for(const Level& level: m_levels)
+        {
+            bytes += (level.mins.GetCapacity() + level.maxs.GetCapacity()) * sizeof(float);
+        }
+        return bytes;
+    }
+
+    void TimeSeries::Decimate(const double xMin, const double xMax, std::size_t maxBuckets, Decimated& out) const
+    {
+        APP_PROFILE_FUNCTION();
+
+        out.xs.clear();
+        out.ys.clear();
+        out.level = 0;
+
+        const std::size_t size{GetSize()};
+        if(size == 0 || xMax < xMin)
+        {
+            return;
+        }
+        maxBuckets = std::max<std::size_t>(maxBuckets, 1);
+
+        const std::size_t first{LowerBound(xMin)};
+        const std::size_t begin{first > 0 ? first - 1 : 0};
+        const std::size_t end{std::min(LowerBound(xMax) + 1, size)};
+        const std::size_t count{end - begin};
+
+        // Coarsest level that still has a group per bucket.
+        std::size_t level{0};
+        std::size_t groupSize{1};
+        if(count > 2 * maxBuckets)
+        {
+            while(level < m_levels.size() && count / (groupSize * GroupSize) >= maxBuckets)
+            {
+                ++level;
+                groupSize *= GroupSize;
+            }
+        }
+        out.level = level;
+
+        if(level == 0)
+        {
+            out.xs.reserve(count);
+            out.ys.reserve(count);
+            for(std::size_t i = begin; i < end; ++i)
+            {
+                out.xs.push_back(m_xs[i]);
+                out.ys.push_back(static_cast<double>(m_ys[i]));
+            }
+            return;
+        }
+
+        const Level& groups{m_levels[level - 1]};
+        const std::size_t firstGroup{begin / groupSize};
+        const std::size_t lastGroup{(end - 1) / groupSize};
+        out.xs.reserve(2 * (lastGroup - firstGroup + 1));
+        out.ys.reserve(2 * (lastGroup - firstGroup + 1));
+        for(std::size_t group = firstGroup; group <= lastGroup; ++group)
+        {
+            float low{0.0F};
+            float high{0.0F};
+            if(group < groups.mins.GetSize())
+            {
+                low = groups.mins[group];
+                high = groups.maxs[group];
+            }
+            else
+            {
+                // The samples after the last complete group.
+                Extremes(group * groupSize, size, low, high);
+            }
+
+            // Both at the group's start, a vertical stroke per bucket.
+            const double x{m_xs[group * groupSize]};
+            out.xs.push_back(x);
+            out.ys.push_back(static_cast<double>(low));
+            out.xs.push_back(x);
+            out.ys.push_back(static_cast<double>(high));
+        }
+    }
+
+    void TimeSeries::Plot(const char* label)
+    {
+        APP_PROFILE_FUNCTION();
+
+        const ImPlotRect limits{ImPlot::GetPlotLimits()};
+        const float width{std::max(ImPlot::GetPlotSize().x, 1.0F)};
+        Decimate(limits.X.Min, limits.X.Max, static_cast<std::size_t>(width), m_plotBuffer);
+        ImPlot::PlotLine(label, m_plotBuffer.xs.data(), m_plotBuffer.ys.data(), static_cast<int>(m_plotBuffer.xs.size()));
+    }
+
+    const TimeSeries::Decimated& TimeSeries::GetPlotted() const
+    {
+        return m_plotBuffer;
+    }
+
+    void TimeSeries::ExtendLevels()
+    {
+        for(std::size_t level = 0;; ++level)
+        {
+            const std::size_t sourceSize{level == 0 ? m_ys.GetSize() : m_levels[level - 1].mins.GetSize()};
+            const std::size_t groups{sourceSize / GroupSize};
+            if(groups == 0)
+            {
+                return;
+            }
+            if(level == m_levels.size())
+            {
+                m_levels.emplace_back();
+            }
+
+            // Taken after emplace_back(), which may move the levels.
+            const Chunks<float>& sourceMins{level == 0 ? m_ys : m_levels[level - 1].mins};
+            const Chunks<float>& sourceMaxs{level == 0 ? m_ys : m_levels[level - 1].maxs};
+            Level& target{m_levels[level]};
+            if(target.mins.GetSize() == groups)
+            {
+                // Nothing completed here, nothing can have above either.
+                return;
+            }
+
+            while(target.mins.GetSize() < groups)
+            {
+                // Chunks hold whole groups, a run never splits one.
+                const std::size_t group{target.mins.GetSize()};
+                std::size_t sourceLength{0};
+                const float* const mins{sourceMins.GetRun(group * GroupSize, sourceLength)};
+                const float* const maxs{sourceMaxs.GetRun(group * GroupSize, sourceLength)};
+                std::size_t targetLength{0};
+                float* const outMins{target.mins.GetWritable(targetLength)};
+                float* const outMaxs{target.maxs.GetWritable(targetLength)};
+
+                const std::size_t reduced{std::min({groups - group, sourceLength / GroupSize, targetLength})};
+                MinMaxKernels::Reduce(mins, maxs, reduced, outMins, outMaxs);
+                target.mins.Grow(reduced);
+                target.maxs.Grow(reduced);
+            }
+        }
+    }
+
+    std::size_t TimeSeries::LowerBound(const double x) const
+    {
+        std::size_t low{0};
+        std::size_t high{GetSize()};
+        while(low < high)
+        {
+            const std::size_t middle{low + (high - low) / 2};
+            if(m_xs[middle] < x)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    void TimeSeries::Extremes(const std::size_t begin, const std::size_t end, float& low, float& high) const
+    {
+        low = std::numeric_limits<float>::infinity();
+        high = -std::numeric_limits<float>::infinity();
+
+        // Greedily the largest complete group starting at each position, at
+        // most seven steps per level.
+        std::size_t position{begin};
+        while(position < end)
+        {
+            std::size_t level{0};
+            std::size_t groupSize{1};
+            while(level < m_levels.size())
+            {
+                const std::size_t next{groupSize * GroupSize};
+                if(position % next != 0 || position + next > end || position / next >= m_levels[level].mins.GetSize())
+                {
+                    break;
+                }
+                ++level;
+                groupSize = next;
+            }
+
+            if(level == 0)
+            {
+                low = std::min(low, m_ys[position]);
+                high = std::max(high, m_ys[position]);
+            }
+            else
+            {
+                const Level& groups{m_levels[level - 1]};
+                low = std::min(low, groups.mins[position / groupSize]);
+                high = std::max(high, groups.maxs[position / groupSize]);
+            }
+            position += groupSize;
+        }
+    }
+
+}
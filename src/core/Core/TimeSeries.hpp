@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace App {
+
+    // An append-only series of samples with a min/max pyramid over it, for
+    // plotting millions of points at the cost of a few thousand. Level one
+    // holds the minimum and maximum of every group of eight samples, each
+    // level above of eight groups of the one below. Appending extends the
+    // levels by the groups it completed, built with MinMaxKernels. Decimate()
+    // picks the coarsest level that still has a group per pixel of the
+    // visible range, one to eight groups of two points each, so a frame
+    // draws at most sixteen points per pixel whether the series holds a
+    // thousand samples or a hundred million. Samples are stored in
+    // fixed-size chunks, appending never moves what is there.
+    class TimeSeries
+    {
+    public:
+        // What Decimate() fills, in doubles as ImPlot wants both axes of one type.
+        struct Decimated
+        {
+            std::vector<double> xs{};
+            std::vector<double> ys{};
+            // Zero for raw samples.
+            std::size_t level{0};
+        };
+
+        TimeSeries() = default;
+
+        TimeSeries(const TimeSeries&) = delete;
+        TimeSeries(TimeSeries&&) = delete;
+        TimeSeries& operator=(TimeSeries other) = delete;
+        TimeSeries& operator=(TimeSeries&& other) = delete;
+
+        // x must not decrease, e.g. seconds since start.
+        void Append(double x, float y);
+        void Append(const double* xs, const float* ys, std::size_t count);
+        void Clear();
+
+        [[nodiscard]] std::size_t GetSize() const;
+        [[nodiscard]] std::size_t GetLevelCount() const;
+        // Of the first and last sample, zero while empty.
+        [[nodiscard]] double GetFirstX() const;
+        [[nodiscard]] double GetLastX() const;
+        // Samples, levels and chunk slack.
+        [[nodiscard]] std::size_t GetMemoryBytes() const;
+
+        // The samples covering [xMin, xMax] and one beyond each end, so a
+        // line reaches the edges. Raw while there are at most two per bucket,
+        // or fewer than one group of the first level per bucket, which leaves
+        // up to eight. Otherwise per group of the chosen level its minimum and
+        // maximum at the group's first x, two to sixteen points per bucket.
+        // maxBuckets is usually the plot's width in pixels.
+        void Decimate(double xMin, double xMax, std::size_t maxBuckets, Decimated& out) const;
+
+        // Draws the series with ImPlot::PlotLine, decimated for the current
+        // plot's X limits and width. Call between ImPlot::BeginPlot() and
+        // EndPlot(), after the axes were set up.
+        void Plot(const char* label);
+        // What the last Plot() drew.
+        [[nodiscard]] const Decimated& GetPlotted() const;
+
+    private:
+        static constexpr std::size_t ChunkShift{16};
+        static constexpr std::size_t ChunkSize{std::size_t{1} << ChunkShift};
+
+        // Fixed-size blocks, so growing copies nothing and never needs twice the memory.
+        template<typename T>
+        class Chunks
+        {
+        public:
+            [[nodiscard]] std::size_t GetSize() const;
+            [[nodiscard]] std::size_t GetCapacity() const;
+            [[nodiscard]] const T& operator[](std::size_t index) const;
+            // Room after the last element up to the end of its chunk, a new
+            // chunk when that one is full. Grow() by what was written.
+            [[nodiscard]] T* GetWritable(std::size_t& length);
+            void Grow(std::size_t count);
+            // The elements from index up to the end of its chunk or the last one.
+            [[nodiscard]] const T* GetRun(std::size_t index, std::size_t& length) const;
+            void Clear();
+
+        private:
+            std::vector<std::unique_ptr<T[]>> m_chunks{};
+            std::size_t m_size{0};
+        };
+
+        struct Level
+        {
+            Chunks<float> mins{};
+            Chunks<float> maxs{};
+        };
+
+        // Adds the groups completed since the last call to every level.
+        void ExtendLevels();
+        // First sample with x not below the given one.
+        [[nodiscard]] std::size_t LowerBound(double x) const;
+        // Extremes of samples [begin, end), from the coarsest levels that fit.
+        void Extremes(std::size_t begin, std::size_t end, float& low, float& high) const;
+
+        Chunks<double> m_xs{};
+        Chunks<float> m_ys{};
+        // m_levels[0] is level one.
+        std::vector<Level> m_levels{};
+        Decimated m_plotBuffer{};
+    };
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <fmt/format.h>
+
+// Shared by the Instrumentor and the trace-convert tool, so this header must
+// not pull in anything else from Core.
+namespace App::Debug::TraceFormat {
+
+    // Binary session layout, all integers are LEB128 varints:
+    //   header   "APPTRACE", version
+    //   chunks   one type byte followed by its payload
+    //     Name     id, length, bytes, then its category's length and bytes
+    //              (version 2 on, version 1 has no categories)
+    //     Thread   index, length, bytes (the Chrome "tid" of that thread)
+    //     Events   thread index, count, base start (ns), then count times
+    //              { name id, zig-zag start delta to the previous event (ns), duration (us) }
+    //     Counter  timestamp (ns), dropped events so far
+    constexpr std::string_view Magic{"APPTRACE"};
+    constexpr std::uint64_t Version{2};
+    // The category of every event in a version 1 trace.
+    constexpr std::string_view DefaultCategory{"function"};
+    // Longer strings are taken for corruption, names and thread ids are far shorter.
+    constexpr std::uint64_t MaxStringLength{1U << 20U};
+
+    enum class ChunkType : std::uint8_t
+    {
+        Name = 1,
+        Thread = 2,
+        Events = 3,
+        Counter = 4
+    };
+
+    constexpr std::string_view ChromeHeader{R"({"otherData": {},"traceEvents":[{})"};
+    constexpr std::string_view ChromeFooter{"]}"};
+
+    inline void AppendVarint(std::string& out, std::uint64_t value)
+    {
+        while(value >= 0x80U)
+        {
+            out.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+            value >>= 7U;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    inline void AppendZigZag(std::string& out, const std::int64_t value)
+    {
+        AppendVarint(out, (static_cast<std::uint64_t>(value) << 1U) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    inline void AppendString(std::string& out, const std::string_view value)
+    {
+        AppendVarint(out, value.size());
+        out.append(value);
+    }
+
+    inline bool ReadVarint(std::streambuf& in, std::uint64_t& value)
+    {
+        value = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7)
+        {
+            const auto byte{in.sbumpc()};
+            if(byte == std::streambuf::traits_type::eof())
+            {
+                return false;
+            }
+            value |= (static_cast<std::uint64_t>(byte) & 0x7FU) << shift;
+            if((static_cast<unsigned>(byte) & 0x80U) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool ReadZigZag(std::streambuf& in, std::int64_t& value)
+    {
+        std::uint64_t raw{0};
+        if(!ReadVarint(in, raw))
+        {
+            return false;
+        }
+        value = static_cast<std::int64_t>(raw >> 1U) ^ -static_cast<std::int64_t>(raw & 1U);
+        return true;
+    }
+
+    // Fails on lengths above MaxStringLength. Reads in pieces, so a length
+    // beyond the end of a truncated file allocates no more than is there.
+    inline bool ReadString(std::streambuf& in, std::string& value)
+    {
+        std::uint64_t length{0};
+        if(!ReadVarint(in, length) || length > MaxStringLength)
+        {
+            return false;
+        }
+
+        constexpr std::size_t PieceSize{4096};
+        value.clear();
+        while(value.size() < length)
+        {
+            const std::size_t offset{value.size()};
+            const std::size_t piece{std::min<std::size_t>(PieceSize, static_cast<std::size_t>(length) - offset)};
+            value.resize(offset + piece);
+            if(in.sgetn(value.data() + offset, static_cast<std::streamsize>(piece)) != static_cast<std::streamsize>(piece))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Double quotes become single quotes, names are not escaped otherwise.
+    inline void AppendChromeString(std::string& out, const std::string_view text)
+    {
+        for(const char c: text)
+        {
+            out.push_back(c == '"' ? '\'' : c);
+        }
+    }
+
+    // Same layout the Instrumentor always produced, the category is what chrome://tracing filters by.
+    inline void AppendChromeEvent(std::string& out,
+                                  const std::string_view name,
+                                  const std::string_view category,
+                                  const std::int64_t durationUs,
+                                  const std::string_view threadId,
+                                  const double startUs)
+    {
+        out.append(R"(,{"cat":")");
+        AppendChromeString(out, category);
+        fmt::format_to(std::back_inserter(out), R"(","dur":{},"name":")", durationUs);
+        AppendChromeString(out, name);
+        fmt::format_to(std::back_inserter(out), R"(","ph":"X","pid":0,"tid":"{}","ts":{:.3f}}})", threadId, startUs);
+    }
+
+    inline void AppendChromeDroppedCounter(std::string& out, const double timestampUs, const std::uint64_t dropped)
+    {
+        fmt::format_to(std::back_inserter(out),
+                       R"(,{{"cat":"instrumentor","name":"Dropped events","ph":"C","pid":0,"ts":{:.3f},)"
+                       R"("args":{{"dropped":{}}}}})",
+                       timestampUs,
+                       dropped);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "ViewportRenderer.hpp"
+#include <SDL.h>
+#include <algorithm>
+#include <cstring>
+#include "Core/Instrumentor.hpp"
+
+namespace App {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr std::uint64_t HashSeed{0xcbf29ce484222325ULL};
+        constexpr std::uint64_t HashMultiplier{0x9e3779b97f4a7c15ULL};
+
+        // Word at a time, only has to tell frames apart, not resist anyone.
+        std::uint64_t HashBytes(const void* data, std::size_t size, std::uint64_t hash)
+        {
+            const auto* bytes{static_cast<const unsigned char*>(data)};
+            for(; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t), bytes += sizeof(std::uint64_t))
+            {
+                std::uint64_t word{0};
+                std::memcpy(&word, bytes, sizeof(word));
+                hash = (hash ^ word) * HashMultiplier;
+                hash ^= hash >> 29U;
+            }
+            for(; size > 0; --size, ++bytes)
+            {
+                hash = (hash ^ *bytes) * HashMultiplier;
+            }
+            return hash;
+        }
+
+        template<typename T>
+        std::uint64_t HashBuffer(const ImVector<T>& buffer, const std::uint64_t hash)
+        {
+            // ImDrawCmd zeroes its padding, the bytes are the value.
+            const auto size{static_cast<std::size_t>(buffer.Size)};
+            return HashBytes(buffer.Data, size * sizeof(T), HashBytes(&size, sizeof(size), hash));
+        }
+
+        std::uint64_t HashDrawData(const ImDrawData& drawData)
+        {
+            std::uint64_t hash{HashSeed};
+            hash = HashBytes(&drawData.DisplayPos, sizeof(drawData.DisplayPos), hash);
+            hash = HashBytes(&drawData.DisplaySize, sizeof(drawData.DisplaySize), hash);
+            hash = HashBytes(&drawData.FramebufferScale, sizeof(drawData.FramebufferScale), hash);
+            for(int i = 0; i < drawData.CmdListsCount; ++i)
+            {
+                const ImDrawList& list{*drawData.CmdLists[i]};
+                hash = HashBuffer(list.CmdBuffer, hash);
+                hash = HashBuffer(list.IdxBuffer, hash);
+                hash = HashBuffer(list.VtxBuffer, hash);
+            }
+            return hash;
+        }
+
+        // Draw callbacks may draw anything, their output is not in the draw data.
+        bool HasUserCallbacks(const ImDrawData& drawData)
+        {
+            for(int i = 0; i < drawData.CmdListsCount; ++i)
+            {
+                for(const ImDrawCmd& command: drawData.CmdLists[i]->CmdBuffer)
+                {
+                    if(command.UserCallback != nullptr && command.UserCallback != ImDrawCallback_ResetRenderState)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+    }
+
+    void ViewportRenderer::Render()
+    {
+        APP_PROFILE_FUNCTION();
+
+        SDL_Window* const currentWindow{SDL_GL_GetCurrentWindow()};
+        const SDL_GLContext currentContext{SDL_GL_GetCurrentContext()};
+
+        const ImGuiPlatformIO& platformIO{ImGui::GetPlatformIO()};
+        m_timings.clear();
+        for(ViewportState& state: m_viewports)
+        {
+            state.alive = false;
+        }
+
+        // The first viewport is the main window, Application presents it.
+        for(int i = 1; i < platformIO.Viewports.Size; ++i)
+        {
+            ImGuiViewport* const viewport{platformIO.Viewports[i]};
+            if((viewport->Flags & ImGuiViewportFlags_IsMinimized) != 0 || viewport->DrawData == nullptr)
+            {
+                continue;
+            }
+
+            ViewportState& state{GetState(viewport->ID)};
+            state.alive = true;
+
+            Timing timing{};
+            timing.id = viewport->ID;
+
+            const std::uint64_t hash{HashDrawData(*viewport->DrawData)};
+            if(!m_invalidated && state.presented && hash == state.hash && !HasUserCallbacks(*viewport->DrawData))
+            {
+                timing.skipped = true;
+                m_timings.push_back(timing);
+                continue;
+            }
+
+            const Clock::time_point renderStart{Clock::now()};
+            {
+                APP_PROFILE_SCOPE("RenderViewport");
+                if(platformIO.Platform_RenderWindow != nullptr)
+                {
+                    // Makes the viewport's window and context current.
+                    platformIO.Platform_RenderWindow(viewport, nullptr);
+                }
+                if(!state.swapIntervalSet)
+                {
+                    // Per context, the backend may have left it at the driver default.
+                    SDL_GL_SetSwapInterval(0);
+                    state.swapIntervalSet = true;
+                }
+                if(platformIO.Renderer_RenderWindow != nullptr)
+                {
+                    platformIO.Renderer_RenderWindow(viewport, nullptr);
+                }
+            }
+
+            const Clock::time_point swapStart{Clock::now()};
+            {
+                APP_PROFILE_SCOPE("SwapViewport");
+                if(platformIO.Platform_SwapBuffers != nullptr)
+                {
+                    platformIO.Platform_SwapBuffers(viewport, nullptr);
+                }
+                if(platformIO.Renderer_SwapBuffers != nullptr)
+                {
+                    platformIO.Renderer_SwapBuffers(viewport, nullptr);
+                }
+            }
+            const Clock::time_point swapEnd{Clock::now()};
+
+            state.hash = hash;
+            state.presented = true;
+
+            timing.render = std::chrono::duration_cast<std::chrono::microseconds>(swapStart - renderStart);
+            timing.swap = std::chrono::duration_cast<std::chrono::microseconds>(swapEnd - swapStart);
+            m_timings.push_back(timing);
+        }
+
+        // Closed viewports, a new one with the same ID starts over.
+        m_viewports.erase(std::remove_if(m_viewports.begin(), m_viewports.end(),
+                                         [](const ViewportState& state) { return !state.alive; }),
+                          m_viewports.end());
+        m_invalidated = false;
+
+        SDL_GL_MakeCurrent(currentWindow, currentContext);
+    }
+
+    void ViewportRenderer::Invalidate()
+    {
+        m_invalidated = true;
+    }
+
+    const std::vector<ViewportRenderer::Timing>& ViewportRenderer::GetTimings() const
+    {
+        return m_timings;
+    }
+
+    ViewportRenderer::ViewportState& ViewportRenderer::GetState(const ImGuiID id)
+    {
+        // A handful of viewports at most, a linear search beats a map.
+        const auto found{std::find_if(m_viewports.begin(), m_viewports.end(),
+                                      [id](const ViewportState& state) { return state.id == id; })};
+        if(found != m_viewports.end())
+        {
+            return *found;
+        }
+
+        ViewportState& state{m_viewports.emplace_back()};
+        state.id = id;
+        return state;
+    }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <imgui.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace App {
+
+    // Replaces ImGui::RenderPlatformWindowsDefault() for the secondary
+    // viewports. Only the main window waits for vsync, the others swap with
+    // an interval of zero, so torn-off panels no longer add a refresh each.
+    // A viewport whose draw data hashes the same as what it presented last
+    // keeps its window contents: neither drawn nor swapped.
+    class ViewportRenderer
+    {
+    public:
+        struct Timing
+        {
+            ImGuiID id{0};
+            std::chrono::microseconds render{};
+            std::chrono::microseconds swap{};
+            bool skipped{false};
+        };
+
+        // After ImGui::UpdatePlatformWindows(), restores the current context.
+        void Render();
+        // Draws every viewport on the next Render(), for content that changes
+        // without its draw data, e.g. a texture updated in place.
+        void Invalidate();
+
+        // One per secondary viewport that was not minimized, from the last Render().
+        [[nodiscard]] const std::vector<Timing>& GetTimings() const;
+
+    private:
+        struct ViewportState
+        {
+            ImGuiID id{0};
+            std::uint64_t hash{0};
+            bool presented{false};
+            bool swapIntervalSet{false};
+            bool alive{false};
+        };
+
+        ViewportState& GetState(ImGuiID id);
+
+        std::vector<ViewportState> m_viewports{};
+        std::vector<Timing> m_timings{};
+        bool m_invalidated{false};
+    };
+
+}
@@ -1,9 +1,34 @@
 #include "Window.hpp"
 #include "Core/Instrumentor.hpp"
+#include <algorithm>
 #include <glad/glad.h>
+#include <thread>
 
 namespace App {
 
+    namespace {
+        // sleep_until overshoots by up to a scheduler tick, the rest is spun.
+        constexpr std::chrono::microseconds SpinThreshold{1500};
+        // Head room kept in low-latency mode on top of the measured frame time.
+        constexpr std::chrono::microseconds LowLatencyMargin{1000};
+
+        constexpr Debug::ScopeDescriptor InputLatencyDescriptor{
+                "InputToPresent", __FILE__, __LINE__, Debug::ProfileCategory::Scope
+        };
+
+        void PreciseSleepUntil(const std::chrono::steady_clock::time_point deadline)
+        {
+            if(const auto now{std::chrono::steady_clock::now()}; deadline - now > SpinThreshold)
+            {
+                std::this_thread::sleep_until(deadline - SpinThreshold);
+            }
+            while(std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
     Window::Window(const Settings& settings)
     {
         APP_PROFILE_FUNCTION();
@@ -13,8 +38,9 @@ namespace App {
         SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
         SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
 
-        constexpr auto windowFlags{static_cast<SDL_WindowFlags>(
+        const auto windowFlags{static_cast<SDL_WindowFlags>(
                 SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI
+                | (settings.hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
         )};
         constexpr int windowCenterFlag{SDL_WINDOWPOS_CENTERED};
 
@@ -25,6 +51,7 @@ namespace App {
                 settings.width,
                 settings.height,
                 windowFlags);
+        m_id = SDL_GetWindowID(m_window);
 
         // NOLINTNEXTLINE
         m_glContext = SDL_GL_CreateContext(m_window);
@@ -36,7 +63,13 @@ namespace App {
 
         gladLoadGLLoader(SDL_GL_GetProcAddress);
         SDL_GL_MakeCurrent(m_window, m_glContext);
-        SDL_GL_SetSwapInterval(1);  // Enable vsync
+        SetVSync(settings.vsync);
+        SetMaxFramesPerSecond(settings.maxFramesPerSecond);
+        SetLowLatency(settings.lowLatency);
+
+        m_latencyTrack = &Debug::Instrumentor::Get().CreateTrack("Input latency");
+        m_frameStart = Clock::now();
+        m_lastPresent = m_frameStart;
     }
 
     Window::~Window()
@@ -47,6 +80,138 @@ namespace App {
         SDL_DestroyWindow(m_window);
     }
 
+    void Window::SetVSync(const VSync vsync)
+    {
+        m_vsync = vsync;
+        switch(vsync)
+        {
+        case VSync::Off:
+            SDL_GL_SetSwapInterval(0);
+            break;
+        case VSync::On:
+            SDL_GL_SetSwapInterval(1);
+            break;
+        case VSync::Adaptive:
+            if(SDL_GL_SetSwapInterval(-1) != 0)
+            {
+                APP_WARN("Adaptive vsync is not supported, using regular vsync.");
+                m_vsync = VSync::On;
+                SDL_GL_SetSwapInterval(1);
+            }
+            break;
+        }
+    }
+
+    void Window::SetMaxFramesPerSecond(const int maxFramesPerSecond)
+    {
+        m_maxFramesPerSecond = maxFramesPerSecond > 0 ? maxFramesPerSecond : 0;
+    }
+
+    void Window::SetLowLatency(const bool lowLatency)
+    {
+        m_lowLatency = lowLatency;
+    }
+
+    Window::Clock::duration Window::GetFramePeriod() const
+    {
+        if(m_maxFramesPerSecond > 0)
+        {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{
+                    1.0 / static_cast<double>(m_maxFramesPerSecond)
+            });
+        }
+
+        if(m_vsync != VSync::Off)
+        {
+            SDL_DisplayMode mode{};
+            if(SDL_GetWindowDisplayMode(m_window, &mode) == 0 && mode.refresh_rate > 0)
+            {
+                return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{
+                        1.0 / static_cast<double>(mode.refresh_rate)
+                });
+            }
+        }
+
+        return Clock::duration::zero();
+    }
+
+    void Window::WaitForNextFrame()
+    {
+        APP_PROFILE_FUNCTION();
+
+        const Clock::duration period{GetFramePeriod()};
+        if(period > Clock::duration::zero())
+        {
+            // With vsync the swap itself paces the loop, only low-latency mode
+            // has something left to wait for.
+            Clock::time_point deadline{};
+            if(m_maxFramesPerSecond > 0)
+            {
+                deadline = m_frameStart + period;
+            }
+            if(m_lowLatency)
+            {
+                deadline = std::max(deadline, m_lastPresent + period - m_frameWorkEstimate - LowLatencyMargin);
+            }
+
+            if(deadline > Clock::now())
+            {
+                PreciseSleepUntil(deadline);
+            }
+        }
+
+        m_frameStart = Clock::now();
+    }
+
+    void Window::OnInput(const SDL_Event& event)
+    {
+        // SDL stamps events in milliseconds since SDL_Init, move that onto our clock.
+        const auto age{std::chrono::milliseconds{SDL_GetTicks() - event.common.timestamp}};
+        OnInput(Clock::now() - age);
+    }
+
+    void Window::OnInput(const Clock::time_point inputTime)
+    {
+        if(m_pendingInput == Clock::time_point{} || inputTime < m_pendingInput)
+        {
+            m_pendingInput = inputTime;
+        }
+    }
+
+    std::chrono::microseconds Window::Present()
+    {
+        const Clock::time_point swapStart{Clock::now()};
+        // The swap may block on vsync, that part is not work the frame can shrink.
+        constexpr int smoothing{8};
+        m_frameWorkEstimate += ((swapStart - m_frameStart) - m_frameWorkEstimate) / smoothing;
+
+        SDL_GL_SwapWindow(m_window);
+        m_lastPresent = Clock::now();
+
+        if(m_pendingInput == Clock::time_point{})
+        {
+            return std::chrono::microseconds::zero();
+        }
+
+        m_inputLatency = std::chrono::duration_cast<std::chrono::microseconds>(m_lastPresent - m_pendingInput);
+        if(Debug::Instrumentor& instrumentor{Debug::Instrumentor::Get()};
+           instrumentor.IsCategoryActive(InputLatencyDescriptor.category))
+        {
+            instrumentor.WriteProfile(
+                    *m_latencyTrack,
+                    {&InputLatencyDescriptor,
+                     Debug::FloatingPointMicroseconds{m_pendingInput.time_since_epoch()},
+                     m_inputLatency});
+        }
+        m_pendingInput = Clock::time_point{};
+        return m_inputLatency;
+    }
+
+    std::chrono::microseconds Window::GetInputLatency() const
+    {
+        return m_inputLatency;
+    }
+
     float Window::GetScale() const
     {
         APP_PROFILE_FUNCTION();
@@ -64,6 +229,11 @@ namespace App {
         return scaleX;
     }
 
+    Uint32 Window::GetId() const
+    {
+        return m_id;
+    }
+
     SDL_Window* Window::GetNativeWindow() const
     {
         return m_window;
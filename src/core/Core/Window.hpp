@@ -1,22 +1,61 @@
 #pragma once
 #include <SDL.h>
+#include <chrono>
 #include <string>
 
 namespace App {
 
+    namespace Debug {
+        class ThreadEventBuffer;
+    }
+
     class Window
     {
     public:
+        enum class VSync
+        {
+            Off,
+            On,
+            // Late frames tear instead of waiting a whole refresh, falls back to On.
+            Adaptive
+        };
+
         struct Settings
         {
             std::string title;
             const int width{1280};
             const int height{720};
+            VSync vsync{VSync::On};
+            // Caps the frame rate when non-zero, e.g. with vsync off or under software GL.
+            int maxFramesPerSecond{0};
+            // Starts each frame as late as the measured frame time allows, so input is
+            // sampled right before the deadline. Needs a frame limit or vsync.
+            bool lowLatency{false};
+            // Never shown, e.g. for headless runs on an offscreen video driver.
+            bool hidden{false};
         };
 
     private:
+        using Clock = std::chrono::steady_clock;
+
         SDL_Window* m_window;
         SDL_GLContext m_glContext;
+        Uint32 m_id{0};
+
+        VSync m_vsync{VSync::On};
+        int m_maxFramesPerSecond{0};
+        bool m_lowLatency{false};
+
+        Clock::time_point m_frameStart{};
+        Clock::time_point m_lastPresent{};
+        // Moving average of the CPU time from frame start until the swap is issued.
+        Clock::duration m_frameWorkEstimate{};
+        // Earliest input not yet presented, time_point{} when there is none.
+        Clock::time_point m_pendingInput{};
+        std::chrono::microseconds m_inputLatency{};
+        Debug::ThreadEventBuffer* m_latencyTrack{nullptr};
+
+        [[nodiscard]] Clock::duration GetFramePeriod() const;
 
     public:
         explicit Window(const Settings& settings);
@@ -27,10 +66,33 @@ namespace App {
         Window& operator=(Window other) = delete;
         Window& operator=(Window&& other) = delete;
 
+        void SetVSync(VSync vsync);
+        void SetMaxFramesPerSecond(int maxFramesPerSecond);
+        void SetLowLatency(bool lowLatency);
+
+        // The timing calls below belong to the thread that presents, which is
+        // the main thread unless a RenderThread took over the context.
+
+        // Call before polling events, sleeps until the next frame should start.
+        void WaitForNextFrame();
+        // Records an input event for the input-to-present latency.
+        void OnInput(const SDL_Event& event);
+        // inputTime on the steady clock, e.g. from an InputQueue::Entry.
+        void OnInput(std::chrono::steady_clock::time_point inputTime);
+        // Swaps and measures the frame, replaces SDL_GL_SwapWindow for this window.
+        // Returns the input-to-present latency of this frame, zero without input.
+        std::chrono::microseconds Present();
+
+        // Latency of the newest presented input, written to an "Input latency"
+        // Instrumentor track as well.
+        [[nodiscard]] std::chrono::microseconds GetInputLatency() const;
+
         [[nodiscard]] float GetScale() const;
 
+        // Cached, compares against SDL_WindowEvent::windowID without a call into SDL.
+        [[nodiscard]] Uint32 GetId() const;
         [[nodiscard]] SDL_Window* GetNativeWindow() const;
         [[nodiscard]] SDL_GLContext GetNativeContext() const;
     };
 
-}
\ No newline at end of file
+}
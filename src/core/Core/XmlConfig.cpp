@@ -0,0 +1,203 @@
+#include "XmlConfig.hpp"
+#include <chrono>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include "Core/Instrumentor.hpp"
+#include "Core/Log.hpp"
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace App {
+
+    namespace {
+        // How often the watcher checks for a stop request, and polls the file where inotify is missing.
+        constexpr std::chrono::milliseconds WatchInterval{250};
+
+        void CollectPath(const pugi::xml_node parent,
+                         const std::string_view path,
+                         std::vector<pugi::xml_node>& nodes)
+        {
+            const std::size_t separator{path.find('/')};
+            const std::string name{path.substr(0, separator)};
+            for(const pugi::xml_node child: parent.children(name.c_str()))
+            {
+                if(separator == std::string_view::npos)
+                {
+                    nodes.push_back(child);
+                }
+                else
+                {
+                    CollectPath(child, path.substr(separator + 1), nodes);
+                }
+            }
+        }
+    }
+
+    const pugi::xml_document& XmlConfig::Snapshot::GetDocument() const
+    {
+        return m_document;
+    }
+
+    const std::vector<pugi::xml_node>& XmlConfig::Snapshot::Select(const std::string& path) const
+    {
+        static const std::vector<pugi::xml_node> empty;
+        const auto it{m_index.find(path)};
+        return it != m_index.end() ? it->second : empty;
+    }
+
+    std::uint64_t XmlConfig::Snapshot::GetVersion() const
+    {
+        return m_version;
+    }
+
+    XmlConfig::XmlConfig(std::filesystem::path path, std::vector<std::string> indexedPaths)
+            : m_path(std::move(path)),
+              m_indexedPaths(std::move(indexedPaths))
+    {
+        APP_PROFILE_FUNCTION();
+
+        Reload();
+        m_watcher = std::thread{&XmlConfig::WatchLoop, this};
+    }
+
+    XmlConfig::~XmlConfig()
+    {
+        m_stopRequested.store(true);
+        m_watcher.join();
+    }
+
+    std::shared_ptr<const XmlConfig::Snapshot> XmlConfig::GetSnapshot() const
+    {
+        return std::atomic_load(&m_snapshot);
+    }
+
+    bool XmlConfig::Reload()
+    {
+        APP_PROFILE_FUNCTION();
+
+        const std::lock_guard<std::mutex> lock{m_reloadMutex};
+
+        std::error_code error;
+        const auto writeTime{std::filesystem::last_write_time(m_path, error)};
+        const auto size{std::filesystem::file_size(m_path, error)};
+        if(error)
+        {
+            return false;
+        }
+        if(std::atomic_load(&m_snapshot) != nullptr && writeTime == m_loadedWriteTime && size == m_loadedSize)
+        {
+            return false;
+        }
+
+        std::unique_ptr<Snapshot> snapshot{Load()};
+        if(snapshot == nullptr)
+        {
+            return false;
+        }
+
+        snapshot->m_version = ++m_version;
+        m_loadedWriteTime = writeTime;
+        m_loadedSize = size;
+        std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>{std::move(snapshot)});
+        return true;
+    }
+
+    std::unique_ptr<XmlConfig::Snapshot> XmlConfig::Load() const
+    {
+        APP_PROFILE_FUNCTION();
+
+        std::error_code error;
+        const auto size{static_cast<std::size_t>(std::filesystem::file_size(m_path, error))};
+        if(error || size == 0)
+        {
+            APP_ERROR("Can't load config {}: empty or missing.", m_path.string());
+            return nullptr;
+        }
+
+        // A mapping would be written to on every page by the in-place parse,
+        // one read into a buffer the document owns is cheaper.
+        auto* buffer{static_cast<char*>(pugi::get_memory_allocation_function()(size))};
+        std::ifstream file{m_path, std::ios::binary};
+        if(buffer == nullptr || !file.read(buffer, static_cast<std::streamsize>(size)))
+        {
+            pugi::get_memory_deallocation_function()(buffer);
+            APP_ERROR("Can't read config {}.", m_path.string());
+            return nullptr;
+        }
+
+        std::unique_ptr<Snapshot> snapshot{new Snapshot{}};
+        const pugi::xml_parse_result result{snapshot->m_document.load_buffer_inplace_own(buffer, size)};
+        if(!result)
+        {
+            APP_ERROR("Can't parse config {}: {} at offset {}.",
+                      m_path.string(),
+                      result.description(),
+                      result.offset);
+            return nullptr;
+        }
+
+        for(const std::string& path: m_indexedPaths)
+        {
+            CollectPath(snapshot->m_document, path, snapshot->m_index[path]);
+        }
+        return snapshot;
+    }
+
+    void XmlConfig::WatchLoop()
+    {
+        #ifdef __linux__
+        // Editors often replace the file by renaming over it, so watch the directory.
+        const int notify{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)};
+        const std::filesystem::path directory{m_path.has_parent_path() ? m_path.parent_path() : "."};
+        if(notify >= 0
+           && inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) >= 0)
+        {
+            const std::string fileName{m_path.filename().string()};
+            alignas(inotify_event) char buffer[4096];
+            while(!m_stopRequested.load())
+            {
+                pollfd pollFd{notify, POLLIN, 0};
+                if(poll(&pollFd, 1, static_cast<int>(WatchInterval.count())) <= 0)
+                {
+                    continue;
+                }
+
+                bool changed{false};
+                ssize_t length{0};
+                while((length = read(notify, buffer, sizeof(buffer))) > 0)
+                {
+                    for(ssize_t offset = 0; offset < length;)
+                    {
+                        const auto* event{reinterpret_cast<const inotify_event*>(buffer + offset)};
+                        changed = changed || (event->len > 0 && fileName == event->name);
+                        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                    }
+                }
+                if(changed)
+                {
+                    Reload();
+                }
+            }
+            close(notify);
+            return;
+        }
+        if(notify >= 0)
+        {
+            close(notify);
+        }
+        APP_WARN("inotify unavailable for {}, polling it instead.", m_path.string());
+        #endif
+
+        while(!m_stopRequested.load())
+        {
+            std::this_thread::sleep_for(WatchInterval);
+            Reload();
+        }
+    }
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <pugixml.hpp>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace App {
+
+    // Read-only XML configuration file. The file is read once into a buffer the
+    // document takes over and parsed in place, pugixml makes no second copy.
+    // Nodes under the indexed paths are collected once per parse. A watcher
+    // thread re-parses when the file changes and swaps in the new Snapshot,
+    // readers holding the previous one keep it alive until they let go.
+    class XmlConfig
+    {
+    public:
+        class Snapshot
+        {
+        public:
+            ~Snapshot() = default;
+
+            Snapshot(const Snapshot&) = delete;
+            Snapshot(Snapshot&&) = delete;
+            Snapshot& operator=(Snapshot other) = delete;
+            Snapshot& operator=(Snapshot&& other) = delete;
+
+            [[nodiscard]] const pugi::xml_document& GetDocument() const;
+            // Element nodes at an indexed path like "Profile/Tools/Tool", empty for any other path.
+            [[nodiscard]] const std::vector<pugi::xml_node>& Select(const std::string& path) const;
+            // Starts at 1 and grows with every successful reload.
+            [[nodiscard]] std::uint64_t GetVersion() const;
+
+        private:
+            friend class XmlConfig;
+
+            Snapshot() = default;
+
+            pugi::xml_document m_document;
+            std::unordered_map<std::string, std::vector<pugi::xml_node>> m_index;
+            std::uint64_t m_version{0};
+        };
+
+        XmlConfig(std::filesystem::path path, std::vector<std::string> indexedPaths);
+        ~XmlConfig();
+
+        XmlConfig(const XmlConfig&) = delete;
+        XmlConfig(XmlConfig&&) = delete;
+        XmlConfig& operator=(XmlConfig other) = delete;
+        XmlConfig& operator=(XmlConfig&& other) = delete;
+
+        // Thread-safe, nullptr until the file could be parsed once.
+        [[nodiscard]] std::shared_ptr<const Snapshot> GetSnapshot() const;
+
+        // Parses the file again if its size or modification time changed.
+        bool Reload();
+
+    private:
+        std::unique_ptr<Snapshot> Load() const;
+        void WatchLoop();
+
+        const std::filesystem::path m_path;
+        const std::vector<std::string> m_indexedPaths;
+
+        std::mutex m_reloadMutex;
+        // Accessed with std::atomic_load/atomic_store only.
+        std::shared_ptr<const Snapshot> m_snapshot;
+        std::uint64_t m_version{0};
+        std::filesystem::file_time_type m_loadedWriteTime{};
+        std::uintmax_t m_loadedSize{0};
+
+        std::thread m_watcher;
+        std::atomic<bool> m_stopRequested{false};
+    };
+
+}
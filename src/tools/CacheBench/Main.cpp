@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Core/Database.hpp"
+#include "Core/HttpCache.hpp"
+#include "Core/HttpClient.hpp"
+#include "Core/JobSystem.hpp"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+using Socket = SOCKET;
+using IoLength = int;
+constexpr Socket InvalidSocket{INVALID_SOCKET};
+inline void CloseSocket(const Socket socket)
+{
+    closesocket(socket);
+}
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+using Socket = int;
+using IoLength = std::size_t;
+constexpr Socket InvalidSocket{-1};
+inline void CloseSocket(const Socket socket)
+{
+    close(socket);
+}
+#endif
+
+// Runs App::HttpCache against a stand-in server on localhost that counts
+// the requests it gets, and reports the time from Send() to the callback:
+//   cold         nothing stored, every request goes to the server
+//   memory       the same URLs again, fresh and in memory
+//   disk         after reopening the cache, fresh and read from disk
+//   revalidate   no-cache responses after reopening, answered with 304
+//   stale        max-age=0 with stale-while-revalidate, served at once
+//                while the revalidation goes to the server behind it,
+//                its server counts are those revalidations
+// Then checks that requests for one URL with different Authorization
+// headers each get the response to their own, and exits with 1 when not.
+// The database and the bodies go to directory, which is wiped first.
+//
+//   cache-bench [urls] [bodyBytes] [directory]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // For what runs behind the callbacks: revalidations and writes.
+    constexpr auto SettleTime{std::chrono::milliseconds{200}};
+
+    // One thread per connection, curl keeps a few of them alive. Paths are
+    // /fresh/N, /no-cache/N and /stale/N, each with an ETag that never
+    // changes, so If-None-Match always gets a 304. /private/N answers with
+    // the Authorization header it got.
+    class StandInServer
+    {
+    public:
+        explicit StandInServer(const std::size_t bodyBytes) : m_body(bodyBytes, 'x')
+        {
+            m_listener = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            bind(m_listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+            listen(m_listener, 16);
+
+            socklen_t length{sizeof(address)};
+            getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &length);
+            m_port = ntohs(address.sin_port);
+            m_acceptor = std::thread{[this] { Accept(); }};
+        }
+
+        ~StandInServer()
+        {
+            m_stopping = true;
+            // Unblocks accept() with a connection of our own.
+            const Socket wakeUp{socket(AF_INET, SOCK_STREAM, 0)};
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(m_port);
+            connect(wakeUp, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+            CloseSocket(wakeUp);
+            m_acceptor.join();
+            CloseSocket(m_listener);
+            // Connections end when curl closes them, with the HttpClient.
+            for(std::thread& connection: m_connections)
+            {
+                connection.join();
+            }
+        }
+
+        StandInServer(const StandInServer&) = delete;
+        StandInServer(StandInServer&&) = delete;
+        StandInServer& operator=(StandInServer other) = delete;
+        StandInServer& operator=(StandInServer&& other) = delete;
+
+        [[nodiscard]] std::string GetUrl(const char* kind, const std::size_t index) const
+        {
+            return "http://127.0.0.1:" + std::to_string(m_port) + "/" + kind + "/" + std::to_string(index);
+        }
+
+        [[nodiscard]] std::size_t GetFullResponses() const
+        {
+            return m_fullResponses.load();
+        }
+
+        [[nodiscard]] std::size_t GetNotModified() const
+        {
+            return m_notModified.load();
+        }
+
+    private:
+        void Accept()
+        {
+            while(true)
+            {
+                const Socket connection{accept(m_listener, nullptr, nullptr)};
+                if(m_stopping || connection == InvalidSocket)
+                {
+                    if(connection != InvalidSocket)
+                    {
+                        CloseSocket(connection);
+                    }
+                    return;
+                }
+                m_connections.emplace_back([this, connection] { Serve(connection); });
+            }
+        }
+
+        void Serve(const Socket connection)
+        {
+            std::string buffer{};
+            char chunk[4096];
+            while(true)
+            {
+                const std::size_t headerEnd{buffer.find("\r\n\r\n")};
+                if(headerEnd == std::string::npos)
+                {
+                    const auto received{recv(connection, chunk, static_cast<IoLength>(sizeof(chunk)), 0)};
+                    if(received <= 0)
+                    {
+                        break;
+                    }
+                    buffer.append(chunk, static_cast<std::size_t>(received));
+                    continue;
+                }
+
+                const std::string request{buffer.substr(0, headerEnd)};
+                buffer.erase(0, headerEnd + 4);
+                const std::string response{Respond(request)};
+                send(connection, response.data(), static_cast<IoLength>(response.size()), 0);
+            }
+            CloseSocket(connection);
+        }
+
+        std::string Respond(const std::string& request)
+        {
+            const std::size_t pathBegin{request.find(' ') + 1};
+            const std::string path{request.substr(pathBegin, request.find(' ', pathBegin) - pathBegin)};
+            const std::string etag{"\"v1-" + path + "\""};
+
+            std::string cacheControl{"no-cache"};
+            if(path.rfind("/private/", 0) == 0)
+            {
+                ++m_fullResponses;
+                const std::string body{"for " + FindHeader(request, "Authorization")};
+                return "HTTP/1.1 200 OK\r\nCache-Control: max-age=3600\r\nContent-Type: text/plain\r\nContent-Length: "
+                       + std::to_string(body.size()) + "\r\n\r\n" + body;
+            }
+            if(path.rfind("/fresh/", 0) == 0)
+            {
+                cacheControl = "max-age=3600";
+            }
+            else if(path.rfind("/stale/", 0) == 0)
+            {
+                cacheControl = "max-age=0, stale-while-revalidate=3600";
+            }
+
+            std::string headers{"Cache-Control: " + cacheControl + "\r\nETag: " + etag + "\r\n"};
+            if(request.find("If-None-Match: " + etag) != std::string::npos)
+            {
+                ++m_notModified;
+                return "HTTP/1.1 304 Not Modified\r\n" + headers + "\r\n";
+            }
+
+            ++m_fullResponses;
+            return "HTTP/1.1 200 OK\r\n" + headers + "Content-Type: text/plain\r\nContent-Length: " + std::to_string(m_body.size())
+                   + "\r\n\r\n" + m_body;
+        }
+
+        static std::string FindHeader(const std::string& request, const std::string& name)
+        {
+            const std::size_t begin{request.find("\r\n" + name + ": ")};
+            if(begin == std::string::npos)
+            {
+                return {};
+            }
+            const std::size_t valueBegin{begin + name.size() + 4};
+            return request.substr(valueBegin, request.find("\r\n", valueBegin) - valueBegin);
+        }
+
+        std::string m_body;
+        Socket m_listener{InvalidSocket};
+        unsigned short m_port{0};
+        std::atomic<bool> m_stopping{false};
+        std::thread m_acceptor;
+        // Acceptor thread only, joined after it.
+        std::vector<std::thread> m_connections;
+        std::atomic<std::size_t> m_fullResponses{0};
+        std::atomic<std::size_t> m_notModified{0};
+    };
+
+    // What the UI thread does once per frame, without the frame.
+    struct Services
+    {
+        App::HttpClient client{};
+        App::JobSystem jobs{};
+        std::unique_ptr<App::Database> database{};
+        std::unique_ptr<App::HttpCache> cache{};
+
+        void Open(const std::filesystem::path& directory)
+        {
+            database = std::make_unique<App::Database>(App::Database::Settings{(directory / "cache.db").string()});
+            App::HttpCache::Settings settings{};
+            settings.directory = directory / "bodies";
+            cache = std::make_unique<App::HttpCache>(client, *database, jobs, settings);
+            Pump([this] { return cache->IsLoaded(); });
+        }
+
+        void Close()
+        {
+            // Lets the writes behind the last responses reach the database.
+            const Clock::time_point settle{Clock::now() + SettleTime};
+            Pump([settle] { return Clock::now() >= settle; });
+            database->Flush();
+            cache.reset();
+            database.reset();
+        }
+
+        void Pump(const std::function<bool()>& done)
+        {
+            while(!done())
+            {
+                client.DispatchCompleted();
+                database->DispatchCompleted();
+                jobs.DispatchMainThread();
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    struct Phase
+    {
+        std::vector<double> firstUs{};
+        std::size_t fromMemory{0};
+        std::size_t fromDisk{0};
+        std::size_t stale{0};
+        // Callbacks after the first, with a changed body.
+        std::size_t updates{0};
+    };
+
+    double Percentile(std::vector<double> values, const double fraction)
+    {
+        if(values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const auto index{static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5)};
+        return values[std::min(index, values.size() - 1)];
+    }
+
+    // One request at a time, so each measures its own latency. Updates after
+    // a stale copy arrive behind the next requests, the phase waits for the
+    // last ones before it ends.
+    Phase Run(Services& services, const StandInServer& server, const char* kind, const std::size_t urls)
+    {
+        auto phase{std::make_shared<Phase>()};
+        for(std::size_t i = 0; i < urls; ++i)
+        {
+            auto answered{std::make_shared<bool>(false)};
+            App::HttpClient::Request request{};
+            request.url = server.GetUrl(kind, i);
+            services.cache->Send(std::move(request), [phase, answered](const App::HttpCache::Response& response) {
+                if(*answered)
+                {
+                    ++phase->updates;
+                    return;
+                }
+                *answered = true;
+                if(!response.Succeeded())
+                {
+                    std::fprintf(stderr, "request failed: %ld %s\n", response.status, response.error.c_str());
+                }
+                phase->firstUs.push_back(static_cast<double>(response.elapsed.count()));
+                phase->fromMemory += response.source == App::HttpCache::Source::Memory ? 1 : 0;
+                phase->fromDisk += response.source == App::HttpCache::Source::Disk ? 1 : 0;
+                phase->stale += response.stale ? 1 : 0;
+            });
+            services.Pump([&answered] { return *answered; });
+        }
+
+        const Clock::time_point settle{Clock::now() + SettleTime};
+        services.Pump([settle] { return Clock::now() >= settle; });
+        return *phase;
+    }
+
+    // Alice and Bob one after the other, the same again from memory, then
+    // both at once for a second URL while neither is stored yet.
+    bool CheckAuthorization(Services& services, const StandInServer& server)
+    {
+        std::size_t answered{0};
+        std::size_t own{0};
+        const auto send{[&services, &answered, &own](const std::string& url, const std::string& user) {
+            App::HttpClient::Request request{};
+            request.url = url;
+            request.headers.push_back("Authorization: Bearer " + user);
+            services.cache->Send(std::move(request), [&answered, &own, expected = "for Bearer " + user](const App::HttpCache::Response& response) {
+                ++answered;
+                if(response.Succeeded() && *response.body == expected)
+                {
+                    ++own;
+                }
+            });
+        }};
+
+        const std::string first{server.GetUrl("private", 0)};
+        send(first, "alice");
+        services.Pump([&answered] { return answered == 1; });
+        send(first, "bob");
+        services.Pump([&answered] { return answered == 2; });
+        send(first, "alice");
+        send(first, "bob");
+        services.Pump([&answered] { return answered == 4; });
+
+        const std::string second{server.GetUrl("private", 1)};
+        send(second, "alice");
+        send(second, "bob");
+        services.Pump([&answered] { return answered == 6; });
+
+        std::printf("authorization: %zu of %zu responses for their own credentials\n", own, answered);
+        return own == answered;
+    }
+
+    void Print(const char* label, const Phase& phase, const std::size_t fullResponses, const std::size_t notModified)
+    {
+        std::printf("%-11s %9.1f %9.1f %9.1f %7zu %7zu %7zu %7zu %9zu %9zu\n",
+                    label,
+                    Percentile(phase.firstUs, 0.5),
+                    Percentile(phase.firstUs, 0.99),
+                    Percentile(phase.firstUs, 1.0),
+                    phase.fromMemory,
+                    phase.fromDisk,
+                    phase.stale,
+                    phase.updates,
+                    fullResponses,
+                    notModified);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t urls{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200};
+    const std::size_t bodyBytes{argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16 * 1024};
+    const std::filesystem::path directory{argc > 3 ? argv[3] : "cache-bench"};
+    if(urls == 0)
+    {
+        std::fprintf(stderr, "usage: cache-bench [urls > 0] [bodyBytes] [directory]\n");
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData{};
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    std::error_code error{};
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::create_directories(directory, error);
+
+    bool ok{true};
+    {
+        StandInServer server{bodyBytes};
+        Services services{};
+        std::size_t full{0};
+        std::size_t notModified{0};
+        const auto printPhase{[&](const char* label, const Phase& phase) {
+            Print(label, phase, server.GetFullResponses() - full, server.GetNotModified() - notModified);
+            full = server.GetFullResponses();
+            notModified = server.GetNotModified();
+        }};
+
+        std::printf("%zu urls, %zu byte bodies, times in us from Send() to the first callback\n", urls, bodyBytes);
+        std::printf("%-11s %9s %9s %9s %7s %7s %7s %7s %9s %9s\n",
+                    "phase", "p50", "p99", "max", "memory", "disk", "stale", "updates", "server200", "server304");
+
+        services.Open(directory);
+        printPhase("cold", Run(services, server, "fresh", urls));
+        printPhase("memory", Run(services, server, "fresh", urls));
+        Run(services, server, "no-cache", urls);
+        Run(services, server, "stale", urls);
+        services.Close();
+        full = server.GetFullResponses();
+        notModified = server.GetNotModified();
+
+        services.Open(directory);
+        printPhase("disk", Run(services, server, "fresh", urls));
+        printPhase("revalidate", Run(services, server, "no-cache", urls));
+        printPhase("stale", Run(services, server, "stale", urls));
+        ok = CheckAuthorization(services, server);
+        services.Close();
+        // Closes curl's connections so the server's threads end.
+        services.cache.reset();
+    }
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return ok ? 0 : 1;
+}
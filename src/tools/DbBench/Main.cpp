@@ -0,0 +1,148 @@
+#include <sqlite3.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include "Core/Database.hpp"
+
+// Inserts rows and looks them up by key one statement at a time, first
+// opening the file for every statement as Application::InitDatabase used
+// to, then through App::Database, and reports statements per second. The
+// inserts of the service are counted once Flush() returns, the queries once
+// their callbacks ran. Both databases go to directory, which is wiped first.
+//
+//   db-bench [statements] [directory]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr const char* CreateSql{"CREATE TABLE IF NOT EXISTS items(id INTEGER PRIMARY KEY, name TEXT, value REAL)"};
+    constexpr const char* InsertSql{"INSERT INTO items(name, value) VALUES(?, ?)"};
+    constexpr const char* SelectSql{"SELECT name, value FROM items WHERE id = ?"};
+
+    double Seconds(const Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    struct Run
+    {
+        double insertSeconds{0.0};
+        double querySeconds{0.0};
+        // Time the calling thread spent in Execute() per statement.
+        double queueUs{0.0};
+        std::size_t rows{0};
+    };
+
+    Run OpenPerCall(const std::string& path, const std::size_t statements)
+    {
+        sqlite3* db{nullptr};
+        sqlite3_open(path.c_str(), &db);
+        sqlite3_exec(db, CreateSql, nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+
+        Run run{};
+        Clock::time_point start{Clock::now()};
+        for(std::size_t i = 0; i < statements; ++i)
+        {
+            sqlite3_open(path.c_str(), &db);
+            sqlite3_stmt* statement{nullptr};
+            sqlite3_prepare_v2(db, InsertSql, -1, &statement, nullptr);
+            sqlite3_bind_text(statement, 1, "row", -1, SQLITE_STATIC);
+            sqlite3_bind_double(statement, 2, static_cast<double>(i) * 0.5);
+            sqlite3_step(statement);
+            sqlite3_finalize(statement);
+            sqlite3_close(db);
+        }
+        run.insertSeconds = Seconds(start);
+
+        start = Clock::now();
+        for(std::size_t i = 0; i < statements; ++i)
+        {
+            sqlite3_open(path.c_str(), &db);
+            sqlite3_stmt* statement{nullptr};
+            sqlite3_prepare_v2(db, SelectSql, -1, &statement, nullptr);
+            sqlite3_bind_int64(statement, 1, static_cast<sqlite3_int64>(i + 1));
+            while(sqlite3_step(statement) == SQLITE_ROW)
+            {
+                ++run.rows;
+            }
+            sqlite3_finalize(statement);
+            sqlite3_close(db);
+        }
+        run.querySeconds = Seconds(start);
+        return run;
+    }
+
+    Run Service(const std::string& path, const std::size_t statements)
+    {
+        App::Database database{App::Database::Settings{path}};
+        database.Execute(CreateSql);
+        database.Flush();
+
+        Run run{};
+        Clock::time_point start{Clock::now()};
+        for(std::size_t i = 0; i < statements; ++i)
+        {
+            database.Execute(InsertSql, {std::string{"row"}, static_cast<double>(i) * 0.5});
+        }
+        run.queueUs = Seconds(start) * 1e6 / static_cast<double>(statements);
+        database.Flush();
+        run.insertSeconds = Seconds(start);
+
+        std::size_t answered{0};
+        start = Clock::now();
+        for(std::size_t i = 0; i < statements; ++i)
+        {
+            database.Query(SelectSql, {static_cast<std::int64_t>(i + 1)}, [&run, &answered](const App::Database::Result& result) {
+                run.rows += result.rows.size();
+                ++answered;
+            });
+        }
+        while(answered < statements)
+        {
+            database.DispatchCompleted();
+            std::this_thread::yield();
+        }
+        run.querySeconds = Seconds(start);
+        return run;
+    }
+
+    void Print(const char* label, const Run& run, const std::size_t statements)
+    {
+        const auto count{static_cast<double>(statements)};
+        std::printf("%-14s %10.0f inserts/s %10.0f queries/s %8zu rows", label, count / run.insertSeconds, count / run.querySeconds, run.rows);
+        if(run.queueUs > 0.0)
+        {
+            std::printf(", Execute() %.2f us", run.queueUs);
+        }
+        std::printf("\n");
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t statements{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000};
+    const std::filesystem::path directory{argc > 2 ? argv[2] : "db-bench"};
+    if(statements == 0)
+    {
+        std::fprintf(stderr, "usage: db-bench [statements > 0] [directory]\n");
+        return 1;
+    }
+
+    std::error_code error{};
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::create_directories(directory, error);
+
+    std::printf("%zu inserts, then %zu lookups by key\n", statements, statements);
+    const Run openPerCall{OpenPerCall((directory / "open-per-call.db").string(), statements)};
+    Print("open-per-call", openPerCall, statements);
+    const Run service{Service((directory / "service.db").string(), statements)};
+    Print("Database", service, statements);
+    return openPerCall.rows == statements && service.rows == statements ? 0 : 1;
+}
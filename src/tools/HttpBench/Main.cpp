@@ -0,0 +1,406 @@
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Core/HttpClient.hpp"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+using Socket = SOCKET;
+using IoLength = int;
+constexpr Socket InvalidSocket{INVALID_SOCKET};
+inline void CloseSocket(const Socket socket)
+{
+    closesocket(socket);
+}
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+using Socket = int;
+using IoLength = std::size_t;
+constexpr Socket InvalidSocket{-1};
+inline void CloseSocket(const Socket socket)
+{
+    close(socket);
+}
+#endif
+
+// Checks App::HttpClient against a stand-in server on localhost: a GET, a
+// POST echoed back, request and response headers, a timeout, a cancelled
+// request and a refused connection. Exits with 1 when one of them is off.
+// Then sends the same GETs one blocking curl_easy_perform at a time, as
+// Application::TestCurl used to, and all at once through the client, and
+// reports requests per second for both.
+//
+//   http-bench [requests] [bodyBytes] [maxConnectionsPerHost]
+//   http-bench --check
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Far beyond the timeout the check gives it, so it only ends by timeout or cancellation.
+    constexpr auto SlowResponseTime{std::chrono::seconds{1}};
+
+    // One thread per connection. /slow answers after SlowResponseTime,
+    // /echo returns the request body with a 201, /header returns the value
+    // of X-Echo and anything else returns the body.
+    class StandInServer
+    {
+    public:
+        explicit StandInServer(const std::size_t bodyBytes) : m_body(bodyBytes, 'x')
+        {
+            m_listener = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            bind(m_listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+            listen(m_listener, 128);
+
+            socklen_t length{sizeof(address)};
+            getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &length);
+            m_port = ntohs(address.sin_port);
+            m_acceptor = std::thread{[this] { Accept(); }};
+        }
+
+        ~StandInServer()
+        {
+            m_stopping = true;
+            // Unblocks accept() with a connection of our own.
+            const Socket wakeUp{socket(AF_INET, SOCK_STREAM, 0)};
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(m_port);
+            connect(wakeUp, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+            CloseSocket(wakeUp);
+            m_acceptor.join();
+            CloseSocket(m_listener);
+            // Connections end when curl closes them, with the HttpClient.
+            for(std::thread& connection: m_connections)
+            {
+                connection.join();
+            }
+        }
+
+        StandInServer(const StandInServer&) = delete;
+        StandInServer(StandInServer&&) = delete;
+        StandInServer& operator=(StandInServer other) = delete;
+        StandInServer& operator=(StandInServer&& other) = delete;
+
+        [[nodiscard]] std::string GetUrl(const char* path) const
+        {
+            return "http://127.0.0.1:" + std::to_string(m_port) + path;
+        }
+
+        [[nodiscard]] std::size_t GetConnectionCount() const
+        {
+            return m_connectionCount.load();
+        }
+
+    private:
+        void Accept()
+        {
+            while(true)
+            {
+                const Socket connection{accept(m_listener, nullptr, nullptr)};
+                if(m_stopping || connection == InvalidSocket)
+                {
+                    if(connection != InvalidSocket)
+                    {
+                        CloseSocket(connection);
+                    }
+                    return;
+                }
+                ++m_connectionCount;
+                m_connections.emplace_back([this, connection] { Serve(connection); });
+            }
+        }
+
+        void Serve(const Socket connection)
+        {
+            std::string buffer{};
+            char chunk[4096];
+            const auto receive{[&]() {
+                const auto received{recv(connection, chunk, static_cast<IoLength>(sizeof(chunk)), 0)};
+                if(received <= 0)
+                {
+                    return false;
+                }
+                buffer.append(chunk, static_cast<std::size_t>(received));
+                return true;
+            }};
+
+            while(true)
+            {
+                const std::size_t headerEnd{buffer.find("\r\n\r\n")};
+                if(headerEnd == std::string::npos)
+                {
+                    if(!receive())
+                    {
+                        break;
+                    }
+                    continue;
+                }
+
+                const std::string request{buffer.substr(0, headerEnd)};
+                const std::size_t bodyLength{std::strtoull(FindHeader(request, "Content-Length").c_str(), nullptr, 10)};
+                bool connected{true};
+                while(connected && buffer.size() < headerEnd + 4 + bodyLength)
+                {
+                    connected = receive();
+                }
+                if(!connected)
+                {
+                    break;
+                }
+
+                const std::string body{buffer.substr(headerEnd + 4, bodyLength)};
+                buffer.erase(0, headerEnd + 4 + bodyLength);
+                const std::string response{Respond(request, body)};
+                send(connection, response.data(), static_cast<IoLength>(response.size()), 0);
+            }
+            CloseSocket(connection);
+        }
+
+        // Empty when missing, the name as curl sends it.
+        static std::string FindHeader(const std::string& request, const std::string& name)
+        {
+            const std::size_t begin{request.find("\r\n" + name + ": ")};
+            if(begin == std::string::npos)
+            {
+                return {};
+            }
+            const std::size_t valueBegin{begin + name.size() + 4};
+            return request.substr(valueBegin, request.find("\r\n", valueBegin) - valueBegin);
+        }
+
+        std::string Respond(const std::string& request, const std::string& body)
+        {
+            const std::size_t pathBegin{request.find(' ') + 1};
+            const std::string path{request.substr(pathBegin, request.find(' ', pathBegin) - pathBegin)};
+
+            std::string status{"200 OK"};
+            std::string content{m_body};
+            if(path == "/slow")
+            {
+                std::this_thread::sleep_for(SlowResponseTime);
+            }
+            else if(path == "/echo")
+            {
+                status = "201 Created";
+                content = body;
+            }
+            else if(path == "/header")
+            {
+                content = FindHeader(request, "X-Echo");
+            }
+
+            return "HTTP/1.1 " + status + "\r\nX-Server: stand-in\r\nContent-Type: text/plain\r\nContent-Length: "
+                   + std::to_string(content.size()) + "\r\n\r\n" + content;
+        }
+
+        std::string m_body;
+        Socket m_listener{InvalidSocket};
+        unsigned short m_port{0};
+        std::atomic<bool> m_stopping{false};
+        std::thread m_acceptor;
+        // Acceptor thread only, joined after it.
+        std::vector<std::thread> m_connections;
+        std::atomic<std::size_t> m_connectionCount{0};
+    };
+
+    // What the UI thread does once per frame, without the frame.
+    void Pump(App::HttpClient& client)
+    {
+        while(client.GetPendingCount() > 0)
+        {
+            client.DispatchCompleted();
+            std::this_thread::yield();
+        }
+        client.DispatchCompleted();
+    }
+
+    App::HttpClient::Request MakeRequest(const char* method, std::string url, const char* header = nullptr)
+    {
+        App::HttpClient::Request request{};
+        request.method = method;
+        request.url = std::move(url);
+        if(header != nullptr)
+        {
+            request.headers.emplace_back(header);
+        }
+        return request;
+    }
+
+    bool Expect(const bool condition, const char* what)
+    {
+        std::printf("%-44s %s\n", what, condition ? "ok" : "FAILED");
+        return condition;
+    }
+
+    bool Check(const StandInServer& server, const std::size_t bodyBytes)
+    {
+        App::HttpClient client{};
+        std::atomic<std::size_t> notified{0};
+        client.SetCompletionNotifier([&notified] { ++notified; });
+
+        App::HttpClient::Response get{};
+        App::HttpClient::Response echoed{};
+        App::HttpClient::Response header{};
+        App::HttpClient::Response timedOut{};
+        App::HttpClient::Response cancelled{};
+        App::HttpClient::Response refused{};
+        std::string streamed{};
+
+        client.Send(MakeRequest("GET", server.GetUrl("/data")), [&get](const auto& response) { get = response; });
+        App::HttpClient::Request post{MakeRequest("POST", server.GetUrl("/echo"), "Content-Type: text/plain")};
+        post.body = "hello";
+        client.Send(std::move(post), [&echoed](const auto& response) { echoed = response; });
+        client.Send(MakeRequest("GET", server.GetUrl("/header"), "X-Echo: 42"), [&header](const auto& response) { header = response; });
+        App::HttpClient::Request timeout{MakeRequest("GET", server.GetUrl("/slow"))};
+        timeout.timeout = std::chrono::milliseconds{100};
+        client.Send(std::move(timeout), [&timedOut](const auto& response) { timedOut = response; });
+        const App::HttpClient::RequestId slow{
+                client.Send(MakeRequest("GET", server.GetUrl("/slow")), [&cancelled](const auto& response) { cancelled = response; })};
+        // Port 1 is reserved and nothing listens on it.
+        client.Send(MakeRequest("GET", "http://127.0.0.1:1/"), [&refused](const auto& response) { refused = response; });
+        App::HttpClient::Request streaming{MakeRequest("GET", server.GetUrl("/data"))};
+        streaming.onData = [&streamed](const std::string_view chunk) {
+            streamed.append(chunk);
+            return true;
+        };
+        client.Send(std::move(streaming), {});
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        client.Cancel(slow);
+        Pump(client);
+
+        const std::string* serverHeader{get.FindHeader("x-server")};
+        bool passed{true};
+        passed &= Expect(get.Succeeded() && get.status == 200 && get.body.size() == bodyBytes, "GET returns the body");
+        passed &= Expect(serverHeader != nullptr && *serverHeader == "stand-in", "response headers, names in lower case");
+        passed &= Expect(echoed.status == 201 && echoed.body == "hello", "POST sends its body");
+        passed &= Expect(header.Succeeded() && header.body == "42", "request headers");
+        passed &= Expect(!timedOut.Succeeded() && !timedOut.error.empty() && !timedOut.cancelled, "timeout fails the request");
+        passed &= Expect(cancelled.cancelled && !cancelled.Succeeded(), "Cancel() completes the request as cancelled");
+        passed &= Expect(!refused.Succeeded() && !refused.error.empty(), "refused connection fails the request");
+        passed &= Expect(streamed.size() == bodyBytes, "onData receives the body");
+        passed &= Expect(notified.load() == 7, "notifier runs once per response");
+        return passed;
+    }
+
+    std::size_t IgnoreBody(char* /*data*/, const std::size_t size, const std::size_t count, void* /*userData*/)
+    {
+        return size * count;
+    }
+
+    double Sequential(const StandInServer& server, const std::size_t requests)
+    {
+        const std::string url{server.GetUrl("/data")};
+        const Clock::time_point start{Clock::now()};
+        for(std::size_t i = 0; i < requests; ++i)
+        {
+            CURL* curl{curl_easy_init()};
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, IgnoreBody);
+            curl_easy_perform(curl);
+            curl_easy_cleanup(curl);
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    struct Concurrent
+    {
+        double seconds{0.0};
+        double sendUs{0.0};
+        std::size_t succeeded{0};
+    };
+
+    Concurrent SendAll(const StandInServer& server, const std::size_t requests, const long maxConnectionsPerHost)
+    {
+        App::HttpClient::Settings settings{};
+        settings.maxConnectionsPerHost = maxConnectionsPerHost;
+        App::HttpClient client{settings};
+
+        Concurrent result{};
+        const Clock::time_point start{Clock::now()};
+        for(std::size_t i = 0; i < requests; ++i)
+        {
+            client.Send(MakeRequest("GET", server.GetUrl("/data")), [&result](const App::HttpClient::Response& response) {
+                if(response.Succeeded())
+                {
+                    ++result.succeeded;
+                }
+            });
+        }
+        result.sendUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / static_cast<double>(requests);
+        Pump(client);
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const bool checkOnly{argc > 1 && std::string{argv[1]} == "--check"};
+    const int first{checkOnly ? 2 : 1};
+    const std::size_t requests{argc > first ? std::strtoull(argv[first], nullptr, 10) : 2000};
+    const std::size_t bodyBytes{argc > first + 1 ? std::strtoull(argv[first + 1], nullptr, 10) : 1024};
+    const long maxConnectionsPerHost{argc > first + 2 ? std::strtol(argv[first + 2], nullptr, 10) : 6};
+    if(requests == 0 || maxConnectionsPerHost <= 0)
+    {
+        std::fprintf(stderr, "usage: http-bench [requests > 0] [bodyBytes] [maxConnectionsPerHost > 0]\n");
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData{};
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    int exitCode{0};
+    {
+        StandInServer server{bodyBytes};
+        if(!Check(server, bodyBytes))
+        {
+            exitCode = 1;
+        }
+        else if(!checkOnly)
+        {
+            const std::size_t connectionsBefore{server.GetConnectionCount()};
+            const double sequential{Sequential(server, requests)};
+            const std::size_t sequentialConnections{server.GetConnectionCount() - connectionsBefore};
+            const Concurrent concurrent{SendAll(server, requests, maxConnectionsPerHost)};
+            const std::size_t concurrentConnections{server.GetConnectionCount() - connectionsBefore - sequentialConnections};
+
+            std::printf("\n%zu GETs, %zu byte bodies\n", requests, bodyBytes);
+            std::printf("%-22s %10.0f requests/s %6zu connections\n",
+                        "curl_easy_perform",
+                        static_cast<double>(requests) / sequential,
+                        sequentialConnections);
+            std::printf("%-22s %10.0f requests/s %6zu connections, Send() %.2f us, %zu succeeded\n",
+                        "HttpClient",
+                        static_cast<double>(requests) / concurrent.seconds,
+                        concurrentConnections,
+                        concurrent.sendUs,
+                        concurrent.succeeded);
+            exitCode = concurrent.succeeded == requests ? 0 : 1;
+        }
+    }
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return exitCode;
+}
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Core/Instrumentor.hpp"
+
+// Times one profiled scope on 1 to N threads at once, each entering scopes
+// in bursts and sleeping in between so the Instrumentor writer keeps up:
+//   locked     the scope as the Instrumentor wrote it before the per-thread
+//              buffers: a stringstream per event, one mutex, a flush each
+//   buffered   APP_PROFILE_SCOPE with a Chrome JSON session
+//   binary     APP_PROFILE_SCOPE with a binary session
+//   filtered   APP_PROFILE_SCOPE with its category masked off
+// Then runs waves of short-lived threads that each record a scope, which
+// must not leave a thread buffer behind per thread, and exits with 1 when
+// they do. Traces go to directory.
+//
+//   instrument-bench [maxThreads] [bursts] [directory]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Below the buffer capacity, with the pause above the writer interval nothing is dropped.
+    constexpr int ScopesPerBurst{2000};
+    constexpr auto BurstPause{std::chrono::milliseconds{15}};
+
+    // What Instrumentor::WriteProfile did for every event before.
+    class LockedWriter
+    {
+    public:
+        explicit LockedWriter(const std::filesystem::path& path) : m_stream(path, std::ios::out | std::ios::trunc)
+        {
+            m_stream << R"({"otherData": {},"traceEvents":[{})";
+        }
+
+        ~LockedWriter()
+        {
+            m_stream << "]}";
+        }
+
+        LockedWriter(const LockedWriter&) = delete;
+        LockedWriter(LockedWriter&&) = delete;
+        LockedWriter& operator=(LockedWriter other) = delete;
+        LockedWriter& operator=(LockedWriter&& other) = delete;
+
+        void Write(const char* name, const Clock::time_point start, const Clock::time_point end)
+        {
+            std::stringstream json;
+            json << std::setprecision(3) << std::fixed;
+            json << R"(,{"cat":"function",)";
+            json << "\"dur\":" << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << ',';
+            json << R"("name":")" << name << "\",";
+            json << R"("ph":"X","pid":0,)";
+            json << R"("tid":")" << std::this_thread::get_id() << "\",";
+            json << "\"ts\":" << std::chrono::duration<double, std::micro>(start.time_since_epoch()).count();
+            json << "}";
+
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            m_stream << json.str();
+            m_stream.flush();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::ofstream m_stream;
+    };
+
+    enum class Mode
+    {
+        Locked,
+        Buffered,
+        Filtered
+    };
+
+    // Out of line, so the scope is not folded into the loop around it.
+#if defined(_MSC_VER)
+    __declspec(noinline)
+#else
+    __attribute__((noinline))
+#endif
+    void ProfiledScope(std::atomic<int>& sink)
+    {
+        APP_PROFILE_SCOPE("Bench scope");
+        sink.fetch_add(1, std::memory_order_relaxed);
+    }
+
+#if defined(_MSC_VER)
+    __declspec(noinline)
+#else
+    __attribute__((noinline))
+#endif
+    void LockedScope(LockedWriter& writer, std::atomic<int>& sink)
+    {
+        const Clock::time_point start{Clock::now()};
+        sink.fetch_add(1, std::memory_order_relaxed);
+        writer.Write("Bench scope", start, Clock::now());
+    }
+
+    // Nanoseconds per scope on the profiled threads, averaged over all of them.
+    double Measure(const Mode mode, const std::size_t threads, const int bursts, LockedWriter* writer)
+    {
+        std::atomic<int> sink{0};
+        std::atomic<double> totalNs{0.0};
+        std::vector<std::thread> workers{};
+        for(std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([mode, bursts, writer, &sink, &totalNs] {
+                double ns{0.0};
+                for(int burst = 0; burst < bursts; ++burst)
+                {
+                    const Clock::time_point start{Clock::now()};
+                    for(int i = 0; i < ScopesPerBurst; ++i)
+                    {
+                        if(mode == Mode::Locked)
+                        {
+                            LockedScope(*writer, sink);
+                        }
+                        else
+                        {
+                            ProfiledScope(sink);
+                        }
+                    }
+                    ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+                    std::this_thread::sleep_for(BurstPause);
+                }
+                double expected{totalNs.load()};
+                while(!totalNs.compare_exchange_weak(expected, expected + ns))
+                {
+                }
+            });
+        }
+        for(std::thread& worker: workers)
+        {
+            worker.join();
+        }
+        return totalNs.load() / static_cast<double>(threads * static_cast<std::size_t>(bursts) * ScopesPerBurst);
+    }
+
+    std::uintmax_t FileSize(const std::filesystem::path& path)
+    {
+        std::error_code error{};
+        const std::uintmax_t size{std::filesystem::file_size(path, error)};
+        return error ? 0 : size;
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t hardware{std::max<std::size_t>(std::thread::hardware_concurrency(), 1)};
+    const std::size_t maxThreads{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::min<std::size_t>(hardware, 8)};
+    const int bursts{argc > 2 ? std::atoi(argv[2]) : 20};
+    const std::filesystem::path directory{argc > 3 ? argv[3] : "instrument-bench"};
+    if(maxThreads == 0 || bursts <= 0)
+    {
+        std::fprintf(stderr, "usage: instrument-bench [maxThreads > 0] [bursts > 0] [directory]\n");
+        return 1;
+    }
+
+    std::error_code error{};
+    std::filesystem::create_directories(directory, error);
+
+    auto& instrumentor{App::Debug::Instrumentor::Get()};
+    std::printf("%d scopes per burst, %d bursts per thread, ns per scope on the profiled threads\n", ScopesPerBurst, bursts);
+    std::printf("%7s %10s %10s %10s %10s\n", "threads", "locked", "buffered", "binary", "filtered");
+    for(std::size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double locked{0.0};
+        {
+            LockedWriter writer{directory / "locked.json"};
+            locked = Measure(Mode::Locked, threads, bursts, &writer);
+        }
+
+        instrumentor.BeginSession("instrument-bench", (directory / "buffered.json").string());
+        const double buffered{Measure(Mode::Buffered, threads, bursts, nullptr)};
+        instrumentor.EndSession();
+
+        instrumentor.BeginSession("instrument-bench", (directory / "binary.bin").string(), App::Debug::SessionFormat::Binary);
+        const double binary{Measure(Mode::Buffered, threads, bursts, nullptr)};
+        instrumentor.EndSession();
+
+        instrumentor.BeginSession("instrument-bench", (directory / "filtered.json").string());
+        instrumentor.SetCategoryMask(App::Debug::AllProfileCategories & ~App::Debug::ToMask(App::Debug::ProfileCategory::Scope));
+        const double filtered{Measure(Mode::Filtered, threads, bursts, nullptr)};
+        instrumentor.SetCategoryMask(App::Debug::AllProfileCategories);
+        instrumentor.EndSession();
+
+        std::printf("%7zu %10.1f %10.1f %10.1f %10.1f\n", threads, locked, buffered, binary, filtered);
+    }
+
+    std::printf("trace sizes of the last row: locked %ju, buffered %ju, binary %ju bytes\n",
+                FileSize(directory / "locked.json"),
+                FileSize(directory / "buffered.json"),
+                FileSize(directory / "binary.bin"));
+
+    // Waves of threads that record a scope and exit. The writer frees their
+    // buffers within its interval, later waves take them over.
+    constexpr int Waves{100};
+    constexpr std::size_t ThreadsPerWave{8};
+    instrumentor.BeginSession("instrument-bench", (directory / "short-lived.json").string());
+    const std::size_t buffersBefore{instrumentor.GetBufferCount()};
+    std::atomic<int> sink{0};
+    for(int wave = 0; wave < Waves; ++wave)
+    {
+        std::vector<std::thread> threads{};
+        for(std::size_t i = 0; i < ThreadsPerWave; ++i)
+        {
+            threads.emplace_back([&sink] { ProfiledScope(sink); });
+        }
+        for(std::thread& thread: threads)
+        {
+            thread.join();
+        }
+        std::this_thread::sleep_for(BurstPause);
+    }
+    const std::size_t buffersAdded{instrumentor.GetBufferCount() - buffersBefore};
+    instrumentor.EndSession();
+    std::printf("%zu short-lived threads in %d waves: %zu thread buffers added\n",
+                Waves * ThreadsPerWave,
+                Waves,
+                buffersAdded);
+    return buffersAdded <= 2 * ThreadsPerWave ? 0 : 1;
+}
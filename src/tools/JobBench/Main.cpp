@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Core/JobSystem.hpp"
+
+// Runs a parallel-for and a layered job graph on App::JobSystem with one
+// to N threads, the calling thread included, against the same work done
+// serially.
+//
+//   job-bench [maxThreads] [elements] [layers] [jobsPerLayer]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Enough arithmetic per element that memory bandwidth is not what is measured.
+    std::uint64_t Work(std::uint64_t value)
+    {
+        for(int i = 0; i < 64; ++i)
+        {
+            value ^= value << 13U;
+            value ^= value >> 7U;
+            value ^= value << 17U;
+        }
+        return value;
+    }
+
+    // Out of line, so every caller runs the same code rather than one the
+    // compiler vectorized for a constant range.
+#if defined(_MSC_VER)
+    __declspec(noinline)
+#else
+    __attribute__((noinline))
+#endif
+    std::uint64_t SumRange(const std::size_t begin, const std::size_t end)
+    {
+        std::uint64_t sum{0};
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            sum += Work(i + 1);
+        }
+        return sum;
+    }
+
+    template<typename Run>
+    double Measure(Run&& run)
+    {
+        // Best of three, the first run also pays for page faults and wake-ups.
+        double best{0.0};
+        for(int attempt = 0; attempt < 3; ++attempt)
+        {
+            const Clock::time_point start{Clock::now()};
+            run();
+            const double ms{std::chrono::duration<double, std::milli>(Clock::now() - start).count()};
+            best = attempt == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    void Report(const char* name, const std::size_t threads, const double ms, const double serialMs)
+    {
+        const double speedup{serialMs / ms};
+        std::printf("%-12s %2zu threads %9.1f ms  speedup %5.2fx  efficiency %5.1f%%\n",
+                    name,
+                    threads,
+                    ms,
+                    speedup,
+                    100.0 * speedup / static_cast<double>(threads));
+    }
+
+    // Each layer fans out into jobsPerLayer jobs that all wait for the previous layer's join.
+    void RunGraph(App::JobSystem& jobs, const std::size_t layers, const std::size_t jobsPerLayer, std::atomic<std::uint64_t>& total)
+    {
+        std::vector<App::JobSystem::Handle> layer{};
+        App::JobSystem::Handle join{};
+        for(std::size_t l = 0; l < layers; ++l)
+        {
+            layer.clear();
+            for(std::size_t j = 0; j < jobsPerLayer; ++j)
+            {
+                const std::size_t begin{(l * jobsPerLayer + j) * 1024};
+                layer.push_back(jobs.Schedule([begin, &total] { total += SumRange(begin, begin + 1024); }, {join}));
+            }
+            join = jobs.Schedule([] {}, layer);
+        }
+        jobs.Wait(join);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const long maxThreads{argc > 1 ? std::atol(argv[1]) : static_cast<long>(std::thread::hardware_concurrency())};
+    const long elements{argc > 2 ? std::atol(argv[2]) : 1L << 22};
+    const long layers{argc > 3 ? std::atol(argv[3]) : 64};
+    const long jobsPerLayer{argc > 4 ? std::atol(argv[4]) : 64};
+    if(maxThreads <= 0 || elements <= 0 || layers <= 0 || jobsPerLayer <= 0)
+    {
+        std::fprintf(stderr, "usage: job-bench [maxThreads] [elements] [layers] [jobsPerLayer]\n");
+        return 1;
+    }
+
+    const auto count{static_cast<std::size_t>(elements)};
+    const auto layerCount{static_cast<std::size_t>(layers)};
+    const auto layerJobs{static_cast<std::size_t>(jobsPerLayer)};
+    std::printf("%zu elements, %zu layers of %zu jobs, %u cores\n",
+                count,
+                layerCount,
+                layerJobs,
+                std::thread::hardware_concurrency());
+
+    // Atomics like the threaded runs, otherwise the pure sum may move past the clock reads.
+    std::atomic<std::uint64_t> expected{0};
+    const double serialForMs{Measure([&] { expected = SumRange(0, count); })};
+    Report("parallel-for", 1, serialForMs, serialForMs);
+
+    std::atomic<std::uint64_t> expectedGraph{0};
+    const double serialGraphMs{Measure([&] { expectedGraph = SumRange(0, layerCount * layerJobs * 1024); })};
+    Report("graph", 1, serialGraphMs, serialGraphMs);
+
+    for(std::size_t threads = 2; threads <= static_cast<std::size_t>(maxThreads); ++threads)
+    {
+        App::JobSystem::Settings settings{};
+        settings.workerCount = threads - 1;
+        App::JobSystem jobs{settings};
+
+        std::atomic<std::uint64_t> total{0};
+        const double forMs{Measure([&] {
+            total = 0;
+            jobs.ParallelFor(count, 0, [&total](const std::size_t begin, const std::size_t end) {
+                total += SumRange(begin, end);
+            });
+        })};
+        if(total != expected)
+        {
+            std::fprintf(stderr, "parallel-for: wrong sum\n");
+            return 1;
+        }
+        Report("parallel-for", threads, forMs, serialForMs);
+
+        const double graphMs{Measure([&] {
+            total = 0;
+            RunGraph(jobs, layerCount, layerJobs, total);
+        })};
+        if(total != expectedGraph)
+        {
+            std::fprintf(stderr, "graph: wrong sum\n");
+            return 1;
+        }
+        Report("graph", threads, graphMs, serialGraphMs);
+    }
+
+    return 0;
+}
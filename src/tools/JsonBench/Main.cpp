@@ -0,0 +1,329 @@
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+#include "Core/JsonStreamParser.hpp"
+
+// Decodes a generated array of records into std::vector<Record>, reading
+// the file in chunks the size of a curl write callback:
+//   dom      collects the chunks into one string like Response::body, then
+//            json::parse and get<> per field
+//   stream   feeds every chunk to a JsonStreamParser with a typed reader
+// Reports the time and the peak of live heap bytes of each, counted by
+// replacing the global operator new and delete of this tool. The fixture is
+// written to path and reused while it is at least megabytes large.
+//
+//   json-bench [megabytes] [path]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t ChunkSize{16 * 1024};
+    // Keeps the block behind the size prefix aligned for any type.
+    constexpr std::size_t HeaderSize{alignof(std::max_align_t)};
+
+    std::atomic<std::size_t> g_liveBytes{0};
+    std::atomic<std::size_t> g_peakBytes{0};
+
+    void ResetPeak()
+    {
+        g_peakBytes.store(g_liveBytes.load());
+    }
+
+    struct Record
+    {
+        std::int64_t id{0};
+        std::string name;
+        double score{0.0};
+        std::vector<std::string> tags;
+        bool active{false};
+    };
+
+    // Fills Records from the parser events, "meta" and anything else unknown is skipped.
+    class RecordReader : public App::JsonSaxDefaults
+    {
+    public:
+        std::vector<Record> records;
+
+        bool start_object(std::size_t /*size*/)
+        {
+            if(++m_depth == 2)
+            {
+                records.emplace_back();
+            }
+            return true;
+        }
+
+        bool end_object()
+        {
+            --m_depth;
+            return true;
+        }
+
+        bool start_array(std::size_t /*size*/)
+        {
+            ++m_depth;
+            return true;
+        }
+
+        bool end_array()
+        {
+            --m_depth;
+            return true;
+        }
+
+        bool key(std::string& key)
+        {
+            m_field = Field::None;
+            if(m_depth != 2)
+            {
+                return true;
+            }
+            if(key == "id")
+            {
+                m_field = Field::Id;
+            }
+            else if(key == "name")
+            {
+                m_field = Field::Name;
+            }
+            else if(key == "score")
+            {
+                m_field = Field::Score;
+            }
+            else if(key == "tags")
+            {
+                m_field = Field::Tags;
+            }
+            else if(key == "active")
+            {
+                m_field = Field::Active;
+            }
+            return true;
+        }
+
+        bool number_unsigned(std::uint64_t value)
+        {
+            if(m_field == Field::Id)
+            {
+                records.back().id = static_cast<std::int64_t>(value);
+            }
+            return true;
+        }
+
+        bool number_float(double value, const std::string& /*text*/)
+        {
+            if(m_field == Field::Score)
+            {
+                records.back().score = value;
+            }
+            return true;
+        }
+
+        bool string(std::string& value)
+        {
+            if(m_field == Field::Name)
+            {
+                records.back().name = std::move(value);
+            }
+            else if(m_field == Field::Tags && m_depth == 3)
+            {
+                records.back().tags.push_back(std::move(value));
+            }
+            return true;
+        }
+
+        bool boolean(bool value)
+        {
+            if(m_field == Field::Active)
+            {
+                records.back().active = value;
+            }
+            return true;
+        }
+
+    private:
+        enum class Field
+        {
+            None,
+            Id,
+            Name,
+            Score,
+            Tags,
+            Active
+        };
+
+        int m_depth{0};
+        Field m_field{Field::None};
+    };
+
+    void WriteFixture(const std::filesystem::path& path, const std::uintmax_t bytes)
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out << '[';
+        for(std::int64_t i = 0; static_cast<std::uintmax_t>(out.tellp()) < bytes; ++i)
+        {
+            if(i > 0)
+            {
+                out << ',';
+            }
+            out << R"({"id":)" << i << R"(,"name":"record number )" << i << R"( with some text \u00e9")"
+                << R"(,"score":)" << static_cast<double>(i) * 0.37 << R"(,"tags":["alpha","beta","gamma"])"
+                << R"(,"active":)" << (i % 2 == 0 ? "false" : "true") << R"(,"meta":{"a":null,"b":[1,2,3]}})";
+        }
+        out << ']';
+    }
+
+    template<typename OnChunk>
+    void ReadChunks(const std::filesystem::path& path, OnChunk&& onChunk)
+    {
+        std::ifstream in{path, std::ios::binary};
+        std::vector<char> chunk(ChunkSize);
+        while(in.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || in.gcount() > 0)
+        {
+            if(!onChunk(std::string_view{chunk.data(), static_cast<std::size_t>(in.gcount())}))
+            {
+                return;
+            }
+        }
+    }
+
+    bool DecodeDom(const std::filesystem::path& path, std::vector<Record>& records)
+    {
+        std::string body{};
+        ReadChunks(path, [&body](const std::string_view chunk) {
+            body.append(chunk);
+            return true;
+        });
+
+        // Not brace-initialized, that would wrap the document in an array.
+        const nlohmann::json document = nlohmann::json::parse(body, nullptr, false);
+        if(document.is_discarded())
+        {
+            return false;
+        }
+        for(const nlohmann::json& item: document)
+        {
+            Record record{};
+            record.id = item.at("id").get<std::int64_t>();
+            record.name = item.at("name").get<std::string>();
+            record.score = item.at("score").get<double>();
+            record.tags = item.at("tags").get<std::vector<std::string>>();
+            record.active = item.at("active").get<bool>();
+            records.push_back(std::move(record));
+        }
+        return true;
+    }
+
+    bool DecodeStream(const std::filesystem::path& path, std::vector<Record>& records)
+    {
+        RecordReader reader{};
+        App::JsonStreamParser<RecordReader> parser{reader};
+        bool fed{true};
+        ReadChunks(path, [&parser, &fed](const std::string_view chunk) {
+            fed = parser.Feed(chunk);
+            return fed;
+        });
+        if(!fed || !parser.Finish())
+        {
+            std::fprintf(stderr, "stream: %s at byte %zu\n", parser.GetError().c_str(), parser.GetPosition());
+            return false;
+        }
+        records = std::move(reader.records);
+        return true;
+    }
+
+    struct Run
+    {
+        double ms{0.0};
+        std::size_t peakBytes{0};
+        std::size_t records{0};
+        bool ok{false};
+    };
+
+    template<typename Decode>
+    Run Measure(const std::filesystem::path& path, Decode&& decode)
+    {
+        Run run{};
+        const std::size_t before{g_liveBytes.load()};
+        ResetPeak();
+        const Clock::time_point start{Clock::now()};
+        {
+            std::vector<Record> records{};
+            run.ok = decode(path, records);
+            run.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            run.records = records.size();
+        }
+        run.peakBytes = g_peakBytes.load() - before;
+        return run;
+    }
+
+}
+
+void* operator new(const std::size_t size)
+{
+    auto* block{static_cast<unsigned char*>(std::malloc(size + HeaderSize))};
+    if(block == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+    *reinterpret_cast<std::size_t*>(block) = size;
+    const std::size_t live{g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size};
+    std::size_t peak{g_peakBytes.load(std::memory_order_relaxed)};
+    while(live > peak && !g_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+    return block + HeaderSize;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if(pointer == nullptr)
+    {
+        return;
+    }
+    auto* block{static_cast<unsigned char*>(pointer) - HeaderSize};
+    g_liveBytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept
+{
+    operator delete(pointer);
+}
+
+int main(int argc, char* argv[])
+{
+    const std::uintmax_t megabytes{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50};
+    const std::filesystem::path path{argc > 2 ? argv[2] : "json-bench.json"};
+    if(megabytes == 0)
+    {
+        std::fprintf(stderr, "usage: json-bench [megabytes > 0] [path]\n");
+        return 1;
+    }
+
+    std::error_code error{};
+    if(std::filesystem::file_size(path, error) < megabytes * 1000 * 1000 || error)
+    {
+        WriteFixture(path, megabytes * 1000 * 1000);
+    }
+    const double fixtureMb{static_cast<double>(std::filesystem::file_size(path)) / 1e6};
+
+    const Run dom{Measure(path, DecodeDom)};
+    const Run stream{Measure(path, DecodeStream)};
+    std::printf("%.1f MB fixture, %zu KB chunks\n", fixtureMb, ChunkSize / 1024);
+    std::printf("%-8s %9s %12s %10s\n", "", "ms", "peak heap MB", "records");
+    std::printf("%-8s %9.0f %12.1f %10zu\n", "dom", dom.ms, static_cast<double>(dom.peakBytes) / 1e6, dom.records);
+    std::printf("%-8s %9.0f %12.1f %10zu\n", "stream", stream.ms, static_cast<double>(stream.peakBytes) / 1e6, stream.records);
+    return dom.ok && stream.ok && dom.records == stream.records ? 0 : 1;
+}
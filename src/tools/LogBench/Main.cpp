@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Core/Log.hpp"
+
+// Logs messages back to back from the calling thread, standing in for the
+// UI thread, and times every call:
+//   sync+flush   the synchronous logger flushing each message, as Log was
+//   sync         the synchronous logger with the periodic flush
+//   block        the asynchronous logger for each overflow policy
+//   drop-oldest
+//   drop-newest
+// Throughput counts until the log thread wrote the last message. The log
+// lines go to stdout and app.log, the results to stderr, so run it as
+//
+//   log-bench [messages] [queueSize] > /dev/null
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Run
+    {
+        const char* label;
+        App::Log::Settings settings;
+        bool flushEachMessage;
+    };
+
+    App::Log::Settings MakeSettings(const App::Log::Mode mode, const std::size_t queueSize, const App::Log::OverflowPolicy policy)
+    {
+        App::Log::Settings settings{};
+        settings.mode = mode;
+        settings.queueSize = queueSize;
+        settings.overflowPolicy = policy;
+        return settings;
+    }
+
+    double Percentile(const std::vector<double>& sorted, const double fraction)
+    {
+        const auto index{static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1))};
+        return sorted[index];
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t messages{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000};
+    const std::size_t queueSize{argc > 2 ? std::strtoull(argv[2], nullptr, 10) : App::Log::Settings{}.queueSize};
+    if(messages == 0 || queueSize == 0)
+    {
+        std::fprintf(stderr, "usage: log-bench [messages > 0] [queueSize > 0] > /dev/null\n");
+        return 1;
+    }
+
+    using Mode = App::Log::Mode;
+    using Policy = App::Log::OverflowPolicy;
+    const std::vector<Run> runs{
+            {"sync+flush", MakeSettings(Mode::Synchronous, queueSize, Policy::Block), true},
+            {"sync", MakeSettings(Mode::Synchronous, queueSize, Policy::Block), false},
+            {"block", MakeSettings(Mode::Asynchronous, queueSize, Policy::Block), false},
+            {"drop-oldest", MakeSettings(Mode::Asynchronous, queueSize, Policy::DropOldest), false},
+            {"drop-newest", MakeSettings(Mode::Asynchronous, queueSize, Policy::DropNewest), false},
+    };
+
+    std::fprintf(stderr, "%zu messages, queue of %zu, ns per call on the logging thread\n", messages, queueSize);
+    std::fprintf(stderr, "%-12s %8s %8s %8s %10s %12s %10s\n", "", "mean", "p50", "p99", "max", "messages/s", "dropped");
+
+    std::vector<double> calls(messages);
+    for(const Run& run: runs)
+    {
+        App::Log::Configure(run.settings);
+        if(run.flushEachMessage)
+        {
+            App::Log::Logger()->flush_on(spdlog::level::trace);
+        }
+
+        const Clock::time_point start{Clock::now()};
+        for(std::size_t i = 0; i < messages; ++i)
+        {
+            const Clock::time_point before{Clock::now()};
+            APP_INFO("Frame {} took {:.3f} ms, {} draw calls", i, 16.6, 42);
+            calls[i] = std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+        }
+        const double callSeconds{std::chrono::duration<double>(Clock::now() - start).count()};
+
+        // Swapping in a synchronous logger joins the log thread once its queue is written.
+        const std::size_t dropped{App::Log::GetDroppedMessageCount()};
+        App::Log::Configure(MakeSettings(Mode::Synchronous, queueSize, Policy::Block));
+        const double totalSeconds{std::chrono::duration<double>(Clock::now() - start).count()};
+
+        std::sort(calls.begin(), calls.end());
+        const double mean{callSeconds * 1e9 / static_cast<double>(messages)};
+        std::fprintf(stderr,
+                     "%-12s %8.0f %8.0f %8.0f %10.0f %12.0f %10zu\n",
+                     run.label,
+                     mean,
+                     Percentile(calls, 0.5),
+                     Percentile(calls, 0.99),
+                     calls.back(),
+                     static_cast<double>(messages) / totalSeconds,
+                     dropped);
+    }
+    return 0;
+}
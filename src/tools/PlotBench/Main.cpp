@@ -0,0 +1,236 @@
+#include <imgui.h>
+#include <implot.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Core/MinMaxKernels.hpp"
+#include "Core/TimeSeries.hpp"
+
+// Fills App::TimeSeries with a million, ten million and a hundred million
+// samples of a noisy signal and reports append throughput, then draws it
+// in headless ImGui/ImPlot frames: the whole series, a 0.1% zoom and a
+// 10% window panning across it. Up to ten million samples it also draws
+// the raw points with ImPlot::PlotLine for comparison. Last the
+// MinMaxKernels against their plain loop.
+//
+//   plot-bench [maxPoints] [frames]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t AppendBatch{4096};
+    constexpr std::size_t MaxRawPoints{10'000'000};
+    constexpr std::size_t KernelSamples{std::size_t{1} << 24};
+
+    enum class View
+    {
+        Full,
+        Zoomed,
+        Panning
+    };
+
+    double Percentile(std::vector<double> values, const double fraction)
+    {
+        if(values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const auto index{static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5)};
+        return values[std::min(index, values.size() - 1)];
+    }
+
+    double Seconds(const Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Sample i at i microseconds, returns the seconds spent in Append().
+    double Fill(App::TimeSeries& series, const std::size_t points, std::vector<double>& rawXs, std::vector<double>& rawYs)
+    {
+        std::vector<double> xs(AppendBatch);
+        std::vector<float> ys(AppendBatch);
+        std::uint32_t noise{1};
+        double seconds{0.0};
+        for(std::size_t first = 0; first < points; first += AppendBatch)
+        {
+            const std::size_t count{std::min(AppendBatch, points - first)};
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                noise = noise * 1664525U + 1013904223U;
+                const double x{static_cast<double>(first + i) * 1e-6};
+                xs[i] = x;
+                ys[i] = static_cast<float>(std::sin(x) + 0.2 * (static_cast<double>(noise >> 8) / 16777216.0 - 0.5));
+            }
+            if(!rawXs.empty())
+            {
+                std::copy_n(xs.begin(), count, rawXs.begin() + static_cast<std::ptrdiff_t>(first));
+                std::copy_n(ys.begin(), count, rawYs.begin() + static_cast<std::ptrdiff_t>(first));
+            }
+
+            const Clock::time_point start{Clock::now()};
+            series.Append(xs.data(), ys.data(), count);
+            seconds += Seconds(start);
+        }
+        return seconds;
+    }
+
+    // Frame times in microseconds. With raw points PlotLine draws them instead of the series.
+    std::vector<double> Draw(App::TimeSeries& series, const View view, const int frames, const std::vector<double>& rawXs, const std::vector<double>& rawYs)
+    {
+        const double first{series.GetFirstX()};
+        const double span{series.GetLastX() - first};
+        ImGuiIO& io{ImGui::GetIO()};
+
+        std::vector<double> frameUs{};
+        for(int frame = 0; frame < frames; ++frame)
+        {
+            double xMin{first};
+            double xMax{first + span};
+            if(view == View::Zoomed)
+            {
+                xMin = first + span * 0.5;
+                xMax = xMin + span * 0.001;
+            }
+            else if(view == View::Panning)
+            {
+                xMin = first + span * 0.9 * static_cast<double>(frame) / static_cast<double>(frames);
+                xMax = xMin + span * 0.1;
+            }
+
+            const Clock::time_point start{Clock::now()};
+            io.DeltaTime = 1.0F / 60.0F;
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2{0.0F, 0.0F});
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("Plot", nullptr, ImGuiWindowFlags_NoDecoration);
+            if(ImPlot::BeginPlot("##Series", ImVec2(-1.0F, -1.0F)))
+            {
+                ImPlot::SetupAxisLimits(ImAxis_X1, xMin, xMax, ImGuiCond_Always);
+                ImPlot::SetupAxisLimits(ImAxis_Y1, -1.5, 1.5, ImGuiCond_Always);
+                if(rawXs.empty())
+                {
+                    series.Plot("Signal");
+                }
+                else
+                {
+                    ImPlot::PlotLine("Signal", rawXs.data(), rawYs.data(), static_cast<int>(rawXs.size()));
+                }
+                ImPlot::EndPlot();
+            }
+            ImGui::End();
+            ImGui::Render();
+            frameUs.push_back(Seconds(start) * 1e6);
+        }
+        return frameUs;
+    }
+
+    void PrintFrames(const char* label, const std::vector<double>& frameUs, const App::TimeSeries& series)
+    {
+        const App::TimeSeries::Decimated& plotted{series.GetPlotted()};
+        std::printf("  %-10s frame p50 %9.1f us  p99 %9.1f us  max %9.1f us  %6zu points from level %zu\n",
+                    label,
+                    Percentile(frameUs, 0.5),
+                    Percentile(frameUs, 0.99),
+                    Percentile(frameUs, 1.0),
+                    plotted.xs.size(),
+                    plotted.level);
+    }
+
+    void BenchKernels()
+    {
+        std::vector<float> samples(KernelSamples);
+        std::uint32_t noise{1};
+        for(float& sample: samples)
+        {
+            noise = noise * 1664525U + 1013904223U;
+            sample = static_cast<float>(noise >> 8) / 16777216.0F;
+        }
+        const std::size_t groups{KernelSamples / App::MinMaxKernels::GroupSize};
+        std::vector<float> mins(groups);
+        std::vector<float> maxs(groups);
+
+        constexpr int Repeats{20};
+        Clock::time_point start{Clock::now()};
+        for(int i = 0; i < Repeats; ++i)
+        {
+            App::MinMaxKernels::Reduce(samples.data(), samples.data(), groups, mins.data(), maxs.data());
+        }
+        const double vectorSeconds{Seconds(start)};
+
+        start = Clock::now();
+        for(int i = 0; i < Repeats; ++i)
+        {
+            App::MinMaxKernels::ReduceScalar(samples.data(), samples.data(), groups, mins.data(), maxs.data());
+        }
+        const double scalarSeconds{Seconds(start)};
+
+        const double total{static_cast<double>(KernelSamples) * Repeats};
+        std::printf("kernels: %s %.2f Gsamples/s, scalar %.2f Gsamples/s\n",
+                    App::MinMaxKernels::GetInstructionSet(),
+                    total / vectorSeconds * 1e-9,
+                    total / scalarSeconds * 1e-9);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t maxPoints{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000ULL};
+    const int frames{argc > 2 ? std::atoi(argv[2]) : 300};
+    if(maxPoints < 1'000'000 || frames <= 0)
+    {
+        std::fprintf(stderr, "usage: plot-bench [maxPoints >= 1000000] [frames > 0]\n");
+        return 1;
+    }
+
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+    ImGuiIO& io{ImGui::GetIO()};
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2{1920.0F, 1080.0F};
+    unsigned char* pixels{nullptr};
+    int width{0};
+    int height{0};
+    io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+    for(std::size_t points = 1'000'000; points <= maxPoints; points *= 10)
+    {
+        App::TimeSeries series{};
+        std::vector<double> rawXs(points <= MaxRawPoints ? points : 0);
+        std::vector<double> rawYs(rawXs.size());
+        const double appendSeconds{Fill(series, points, rawXs, rawYs)};
+        std::printf("%zu points: append %.1f Mpoints/s, %zu levels, %.1f MB\n",
+                    points,
+                    static_cast<double>(points) / appendSeconds * 1e-6,
+                    series.GetLevelCount(),
+                    static_cast<double>(series.GetMemoryBytes()) / (1024.0 * 1024.0));
+
+        const std::vector<double> none{};
+        PrintFrames("full", Draw(series, View::Full, frames, none, none), series);
+        PrintFrames("zoomed", Draw(series, View::Zoomed, frames, none, none), series);
+        PrintFrames("panning", Draw(series, View::Panning, frames, none, none), series);
+        if(!rawXs.empty())
+        {
+            // A few frames are plenty, each draws every point.
+            const std::vector<double> frameUs{Draw(series, View::Full, std::min(frames, 10), rawXs, rawYs)};
+            std::printf("  %-10s frame p50 %9.1f us  p99 %9.1f us  max %9.1f us  %6zu points\n",
+                        "raw",
+                        Percentile(frameUs, 0.5),
+                        Percentile(frameUs, 0.99),
+                        Percentile(frameUs, 1.0),
+                        rawXs.size());
+        }
+    }
+
+    BenchKernels();
+
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+    return 0;
+}
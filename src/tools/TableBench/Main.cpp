@@ -0,0 +1,158 @@
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Core/DataTable.hpp"
+#include "Core/Database.hpp"
+#include "Core/SampleItems.hpp"
+
+// Runs App::DataTable in headless ImGui frames over sample tables of a
+// thousand up to maxRows rows, ten times more each step. Every frame
+// scrolls with the mouse wheel, every JumpInterval frames it jumps to a
+// random row. Reports the UI thread's time per frame and how long a jump
+// takes until all of its rows are shown. The sample databases are kept in
+// directory and reused, ten million rows take a while to write.
+//
+//   table-bench [maxRows] [frames] [directory]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr auto FramePeriod{std::chrono::microseconds{16667}};
+    constexpr int JumpInterval{30};
+    constexpr float WheelPerFrame{-2.0F};
+
+    struct Result
+    {
+        std::vector<double> frameUs{};
+        std::vector<double> jumpMs{};
+        double countMs{-1.0};
+        App::TablePager::Stats stats{};
+    };
+
+    double Percentile(std::vector<double> values, const double fraction)
+    {
+        if(values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const auto index{static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5)};
+        return values[std::min(index, values.size() - 1)];
+    }
+
+    Result Run(App::Database& database, const int frames)
+    {
+        App::DataTable table{database, App::DataTable::Settings{App::SampleItems::GetPagerSettings()}};
+        ImGuiIO& io{ImGui::GetIO()};
+        std::mt19937_64 random{42};
+
+        Result result{};
+        bool jumping{false};
+        Clock::time_point jumpStart{};
+        const Clock::time_point start{Clock::now()};
+
+        for(int frame = 0; frame < frames; ++frame)
+        {
+            const Clock::time_point frameStart{Clock::now()};
+            database.DispatchCompleted();
+
+            const App::TablePager& pager{table.GetPager()};
+            if(result.countMs < 0.0 && pager.IsRowCountKnown())
+            {
+                result.countMs = std::chrono::duration<double, std::milli>(frameStart - start).count();
+            }
+            if(frame > 0 && frame % JumpInterval == 0 && pager.GetRowCount() > 0)
+            {
+                table.ScrollToRow(static_cast<std::int64_t>(random() % static_cast<std::uint64_t>(pager.GetRowCount())));
+                jumping = true;
+                jumpStart = frameStart;
+            }
+
+            io.DeltaTime = 1.0F / 60.0F;
+            io.AddMousePosEvent(io.DisplaySize.x * 0.5F, io.DisplaySize.y * 0.5F);
+            io.AddMouseWheelEvent(0.0F, WheelPerFrame);
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2{0.0F, 0.0F});
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("Table", nullptr, ImGuiWindowFlags_NoDecoration);
+            table.Render();
+            ImGui::End();
+            ImGui::Render();
+
+            const Clock::time_point frameEnd{Clock::now()};
+            result.frameUs.push_back(std::chrono::duration<double, std::micro>(frameEnd - frameStart).count());
+            if(jumping && table.IsVisibleRangeLoaded())
+            {
+                result.jumpMs.push_back(std::chrono::duration<double, std::milli>(frameEnd - jumpStart).count());
+                jumping = false;
+            }
+
+            std::this_thread::sleep_until(frameStart + FramePeriod);
+        }
+
+        result.stats = table.GetPager().GetStats();
+        return result;
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const long long maxRows{argc > 1 ? std::atoll(argv[1]) : 10000000LL};
+    const int frames{argc > 2 ? std::atoi(argv[2]) : 600};
+    const std::string directory{argc > 3 ? argv[3] : "."};
+    if(maxRows < 1000 || frames <= JumpInterval)
+    {
+        std::fprintf(stderr, "usage: table-bench [maxRows >= 1000] [frames > %d] [directory]\n", JumpInterval);
+        return 1;
+    }
+
+    ImGui::CreateContext();
+    ImGuiIO& io{ImGui::GetIO()};
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2{1280.0F, 720.0F};
+    unsigned char* pixels{nullptr};
+    int width{0};
+    int height{0};
+    io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+    std::printf("%10s %9s %9s %9s %9s %9s %9s %9s %7s %7s\n",
+                "rows", "write ms", "count ms", "frame p50", "p99 us", "max us", "jump p50", "p99 ms", "seeks", "pages");
+    for(long long rows = 1000; rows <= maxRows; rows *= 10)
+    {
+        App::Database database{App::Database::Settings{directory + "/table-bench-" + std::to_string(rows) + ".db"}};
+        if(!database.IsOpen())
+        {
+            return 1;
+        }
+
+        const Clock::time_point writeStart{Clock::now()};
+        App::SampleItems::Create(database, rows);
+        database.Flush();
+        const double writeMs{std::chrono::duration<double, std::milli>(Clock::now() - writeStart).count()};
+
+        const Result result{Run(database, frames)};
+        std::printf("%10lld %9.0f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %7zu %7zu\n",
+                    rows,
+                    writeMs,
+                    result.countMs,
+                    Percentile(result.frameUs, 0.5),
+                    Percentile(result.frameUs, 0.99),
+                    Percentile(result.frameUs, 1.0),
+                    Percentile(result.jumpMs, 0.5),
+                    Percentile(result.jumpMs, 0.99),
+                    result.stats.seekQueries,
+                    result.stats.pageQueries);
+    }
+
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Core/BrowserThrottle.hpp"
+
+// Drives App::BrowserThrottle from a 60 Hz frame loop through the states
+// the application puts the browser in, with a fake backend that paints on
+// its own thread at whatever frame rate it was given, like CEF's windowless
+// rendering. Reports the paints per second of each state, then drags the
+// browser size every frame for a while and counts the resizes that reach
+// the backend. Exits with 1 when a rate is off by more than a fifth or the
+// drag was not collapsed into one resize.
+//
+//   throttle-bench [secondsPerState]
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr auto FrameInterval{std::chrono::microseconds{16667}};
+
+    // Paints until destroyed, not at all while hidden.
+    class FakeBrowserBackend final : public App::BrowserBackend
+    {
+    public:
+        FakeBrowserBackend() : m_painter([this] { Paint(); })
+        {
+        }
+
+        ~FakeBrowserBackend() override
+        {
+            {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                m_stopRequested = true;
+            }
+            m_changed.notify_one();
+            m_painter.join();
+        }
+
+        FakeBrowserBackend(const FakeBrowserBackend&) = delete;
+        FakeBrowserBackend(FakeBrowserBackend&&) = delete;
+        FakeBrowserBackend& operator=(FakeBrowserBackend other) = delete;
+        FakeBrowserBackend& operator=(FakeBrowserBackend&& other) = delete;
+
+        void SetHidden(const bool hidden) override
+        {
+            {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                m_hidden = hidden;
+            }
+            m_changed.notify_one();
+        }
+
+        void SetFrameRate(const int framesPerSecond) override
+        {
+            {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                m_framesPerSecond = framesPerSecond;
+            }
+            m_changed.notify_one();
+        }
+
+        void Resize(const int width, const int height) override
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            m_width = width;
+            m_height = height;
+            ++m_resizes;
+        }
+
+        [[nodiscard]] std::size_t GetPaints() const
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            return m_paints;
+        }
+
+        [[nodiscard]] std::size_t GetResizes() const
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            return m_resizes;
+        }
+
+    private:
+        void Paint()
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            Clock::time_point next{Clock::now()};
+            while(!m_stopRequested)
+            {
+                if(m_hidden || m_framesPerSecond <= 0)
+                {
+                    m_changed.wait(lock);
+                    next = Clock::now();
+                    continue;
+                }
+                // A new rate applies from the next paint on, as in CEF.
+                const int framesPerSecond{m_framesPerSecond};
+                if(m_changed.wait_until(lock, next) == std::cv_status::timeout && !m_hidden)
+                {
+                    ++m_paints;
+                    next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+                }
+            }
+        }
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_changed;
+        bool m_stopRequested{false};
+        // CEF starts visible at its default frame rate.
+        bool m_hidden{false};
+        int m_framesPerSecond{30};
+        int m_width{0};
+        int m_height{0};
+        std::size_t m_paints{0};
+        std::size_t m_resizes{0};
+        std::thread m_painter;
+    };
+
+    struct Phase
+    {
+        const char* label;
+        App::BrowserVisibility visibility;
+        double expectedPaintsPerSecond;
+    };
+
+    App::BrowserVisibility MakeVisibility(const bool open, const bool visible, const bool focused)
+    {
+        App::BrowserVisibility visibility{};
+        visibility.open = open;
+        visibility.visible = visible;
+        visibility.focused = focused;
+        visibility.width = 1280;
+        visibility.height = 720;
+        return visibility;
+    }
+
+    // Calls Update() once per frame for the given time, visibility may change per frame.
+    template<typename VisibilityAt>
+    void RunFrames(App::BrowserThrottle& throttle, const Clock::duration duration, VisibilityAt&& visibilityAt)
+    {
+        const Clock::time_point start{Clock::now()};
+        Clock::time_point frame{start};
+        for(int i = 0; frame - start < duration; ++i)
+        {
+            throttle.Update(visibilityAt(i));
+            frame += FrameInterval;
+            std::this_thread::sleep_until(frame);
+        }
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const double secondsPerState{argc > 1 ? std::strtod(argv[1], nullptr) : 2.0};
+    if(secondsPerState <= 0.0)
+    {
+        std::fprintf(stderr, "usage: throttle-bench [secondsPerState > 0]\n");
+        return 1;
+    }
+    const auto phaseDuration{std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(secondsPerState))};
+
+    const App::BrowserThrottle::Settings settings{};
+    const auto full{static_cast<double>(settings.fullFramesPerSecond)};
+    const auto low{static_cast<double>(settings.lowFramesPerSecond)};
+    const std::vector<Phase> phases{
+            {"closed", MakeVisibility(false, false, false), 0.0},
+            {"focused", MakeVisibility(true, true, true), full},
+            {"unfocused", MakeVisibility(true, true, false), low},
+            {"minimized", MakeVisibility(true, false, false), 0.0},
+            {"focused", MakeVisibility(true, true, true), full},
+    };
+
+    FakeBrowserBackend backend{};
+    App::BrowserThrottle throttle{settings};
+    throttle.SetBackend(&backend);
+
+    bool ok{true};
+    std::printf("%-10s %10s %10s\n", "state", "paints/s", "expected");
+    for(const Phase& phase: phases)
+    {
+        // The first frame switches the state, the painter may still finish one paint of the last one.
+        throttle.Update(phase.visibility);
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+
+        const std::size_t paintsBefore{backend.GetPaints()};
+        const Clock::time_point start{Clock::now()};
+        RunFrames(throttle, phaseDuration, [&phase](int /*frame*/) { return phase.visibility; });
+        const double seconds{std::chrono::duration<double>(Clock::now() - start).count()};
+        const double paintsPerSecond{static_cast<double>(backend.GetPaints() - paintsBefore) / seconds};
+
+        const double tolerance{phase.expectedPaintsPerSecond / 5.0};
+        const bool inRange{paintsPerSecond >= phase.expectedPaintsPerSecond - tolerance
+                           && paintsPerSecond <= phase.expectedPaintsPerSecond + tolerance};
+        ok = ok && inRange;
+        std::printf("%-10s %10.1f %10.1f%s\n", phase.label, paintsPerSecond, phase.expectedPaintsPerSecond, inRange ? "" : "  off");
+    }
+
+    // Grows the browser by a pixel every frame, then holds it past the resize delay.
+    const std::size_t resizesBefore{backend.GetResizes()};
+    const auto dragDuration{std::chrono::milliseconds{500}};
+    int dragFrames{0};
+    RunFrames(throttle, dragDuration, [&dragFrames](const int frame) {
+        App::BrowserVisibility visibility{MakeVisibility(true, true, true)};
+        visibility.width += frame + 1;
+        dragFrames = frame + 1;
+        return visibility;
+    });
+    App::BrowserVisibility settled{MakeVisibility(true, true, true)};
+    settled.width += dragFrames;
+    RunFrames(throttle, settings.resizeDelay * 3, [&settled](int /*frame*/) { return settled; });
+    const std::size_t resizes{backend.GetResizes() - resizesBefore};
+    ok = ok && resizes == 1;
+    std::printf("dragged over %d frames: %zu resizes\n", dragFrames, resizes);
+
+    return ok ? 0 : 1;
+}
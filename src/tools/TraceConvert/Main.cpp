@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Core/TraceFormat.hpp"
+
+// Streams a binary Instrumentor session into the Chrome trace JSON layout the
+// Instrumentor writes for SessionFormat::ChromeJson.
+//
+//   trace-convert <profile.bin> <profile.json>
+
+namespace {
+
+    using namespace App::Debug::TraceFormat;
+
+    bool Convert(std::streambuf& in, std::ofstream& out)
+    {
+        std::string magic(Magic.size(), '\0');
+        std::uint64_t version{0};
+        if(in.sgetn(magic.data(), static_cast<std::streamsize>(magic.size())) != static_cast<std::streamsize>(magic.size())
+           || magic != Magic || !ReadVarint(in, version) || version == 0 || version > Version)
+        {
+            std::fprintf(stderr, "Not a binary trace or unsupported version.\n");
+            return false;
+        }
+
+        std::vector<std::string> names;
+        // Per name, version 1 traces have none.
+        std::vector<std::string> categories;
+        std::vector<std::string> threads;
+        std::string batch{ChromeHeader};
+
+        for(auto type{in.sbumpc()}; type != std::streambuf::traits_type::eof(); type = in.sbumpc())
+        {
+            std::uint64_t index{0};
+            std::string text;
+
+            switch(static_cast<ChunkType>(type))
+            {
+            case ChunkType::Name:
+            case ChunkType::Thread:
+            {
+                const bool isName{static_cast<ChunkType>(type) == ChunkType::Name};
+                std::string category{DefaultCategory};
+                if(!ReadVarint(in, index) || !ReadString(in, text) || (isName && version >= 2 && !ReadString(in, category)))
+                {
+                    std::fprintf(stderr, "Truncated or corrupt definition chunk.\n");
+                    return false;
+                }
+                // The Instrumentor numbers names and threads from zero in the
+                // order it writes them, anything past the next one is corrupt.
+                auto& table{isName ? names : threads};
+                if(index > table.size())
+                {
+                    std::fprintf(stderr, "Corrupt definition chunk, index %llu after %zu.\n",
+                                 static_cast<unsigned long long>(index), table.size());
+                    return false;
+                }
+                if(index == table.size())
+                {
+                    table.push_back(std::move(text));
+                }
+                else
+                {
+                    table[index] = std::move(text);
+                }
+                if(isName)
+                {
+                    categories.resize(names.size());
+                    categories[index] = std::move(category);
+                }
+                break;
+            }
+            case ChunkType::Events:
+            {
+                std::uint64_t count{0};
+                std::uint64_t base{0};
+                if(!ReadVarint(in, index) || index >= threads.size() || !ReadVarint(in, count)
+                   || !ReadVarint(in, base))
+                {
+                    std::fprintf(stderr, "Truncated or corrupt events chunk.\n");
+                    return false;
+                }
+
+                auto start{static_cast<std::int64_t>(base)};
+                for(std::uint64_t i = 0; i < count; ++i)
+                {
+                    std::uint64_t nameId{0};
+                    std::int64_t delta{0};
+                    std::uint64_t duration{0};
+                    if(!ReadVarint(in, nameId) || nameId >= names.size() || !ReadZigZag(in, delta)
+                       || !ReadVarint(in, duration))
+                    {
+                        std::fprintf(stderr, "Truncated or corrupt event.\n");
+                        return false;
+                    }
+                    start += delta;
+                    AppendChromeEvent(batch,
+                                      names[nameId],
+                                      categories[nameId],
+                                      static_cast<std::int64_t>(duration),
+                                      threads[index],
+                                      static_cast<double>(start) / 1000.0);
+                }
+                break;
+            }
+            case ChunkType::Counter:
+            {
+                std::uint64_t timestamp{0};
+                std::uint64_t dropped{0};
+                if(!ReadVarint(in, timestamp) || !ReadVarint(in, dropped))
+                {
+                    std::fprintf(stderr, "Truncated counter chunk.\n");
+                    return false;
+                }
+                AppendChromeDroppedCounter(batch, static_cast<double>(timestamp) / 1000.0, dropped);
+                break;
+            }
+            default:
+                std::fprintf(stderr, "Unknown chunk type %d.\n", type);
+                return false;
+            }
+
+            // Keep memory bounded no matter how long the session was.
+            if(batch.size() > (1U << 20U))
+            {
+                out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                batch.clear();
+            }
+        }
+
+        batch.append(ChromeFooter);
+        out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+        return static_cast<bool>(out);
+    }
+
+}
+
+int main(const int argc, const char* argv[])
+{
+    if(argc != 3)
+    {
+        std::fprintf(stderr, "Usage: %s <binary trace> <chrome json>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream in{argv[1], std::ios::in | std::ios::binary};
+    if(!in.is_open())
+    {
+        std::fprintf(stderr, "Could not open '%s'.\n", argv[1]);
+        return 1;
+    }
+
+    std::ofstream out{argv[2], std::ios::out | std::ios::trunc | std::ios::binary};
+    if(!out.is_open())
+    {
+        std::fprintf(stderr, "Could not open '%s'.\n", argv[2]);
+        return 1;
+    }
+
+    return Convert(*in.rdbuf(), out) ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <glad/glad.h>
+#include <vector>
+#include "Core/TextureUploader.hpp"
+#include "SyntheticPaintSource.hpp"
+
+// Feeds synthetic browser paints through the full-surface glTexSubImage2D
+// upload and through App::TextureUploader, on a hidden window's GL context.
+//
+//   upload-bench [width] [height] [frames] [scrollInterval]
+
+namespace {
+
+    struct Timings
+    {
+        std::vector<double> paintUs;
+        double totalMs{0.0};
+    };
+
+    template<typename Upload>
+    Timings Run(SyntheticPaintSource& source, const int frames, Upload&& upload)
+    {
+        Timings timings{};
+        timings.paintUs.reserve(static_cast<std::size_t>(frames));
+
+        const auto start{std::chrono::steady_clock::now()};
+        for(int frame = 0; frame < frames; ++frame)
+        {
+            const std::vector<App::DirtyRect>& rects{source.Paint()};
+
+            // Only the time the paint callback would block the frame thread.
+            const auto paintStart{std::chrono::steady_clock::now()};
+            upload(rects);
+            timings.paintUs.push_back(
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - paintStart).count());
+        }
+        glFinish();
+        timings.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return timings;
+    }
+
+    void Report(const char* name, Timings& timings)
+    {
+        std::sort(timings.paintUs.begin(), timings.paintUs.end());
+        double sum{0.0};
+        for(const double us: timings.paintUs)
+        {
+            sum += us;
+        }
+        const auto percentile{[&](const double p) {
+            return timings.paintUs[static_cast<std::size_t>(p * static_cast<double>(timings.paintUs.size() - 1))];
+        }};
+        std::printf("%-16s paint mean %8.1f us  p50 %8.1f us  p99 %8.1f us  total %8.1f ms\n",
+                    name,
+                    sum / static_cast<double>(timings.paintUs.size()),
+                    percentile(0.5),
+                    percentile(0.99),
+                    timings.totalMs);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int width{argc > 1 ? std::atoi(argv[1]) : 1920};
+    const int height{argc > 2 ? std::atoi(argv[2]) : 1080};
+    const int frames{argc > 3 ? std::atoi(argv[3]) : 600};
+    const int scrollInterval{argc > 4 ? std::atoi(argv[4]) : 120};
+    if(width <= 0 || height <= 0 || frames <= 0)
+    {
+        std::fprintf(stderr, "usage: upload-bench [width] [height] [frames] [scrollInterval]\n");
+        return 1;
+    }
+
+    if(SDL_Init(SDL_INIT_VIDEO) != 0)
+    {
+        std::fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+    constexpr auto windowFlags{static_cast<SDL_WindowFlags>(SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN)};
+    SDL_Window* window{SDL_CreateWindow("upload-bench", 0, 0, 64, 64, windowFlags)};
+    SDL_GLContext context{window != nullptr ? SDL_GL_CreateContext(window) : nullptr};
+    if(context == nullptr || gladLoadGLLoader(SDL_GL_GetProcAddress) == 0)
+    {
+        std::fprintf(stderr, "No OpenGL 4.1 context: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    std::printf("%dx%d, %d paints, full repaint every %d\n", width, height, frames, scrollInterval);
+    {
+        // What the browser window does today, the whole buffer on every paint.
+        SyntheticPaintSource source{width, height, scrollInterval};
+        GLuint texture{0};
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+        Timings timings{Run(source, frames, [&](const std::vector<App::DirtyRect>& /*rects*/) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexSubImage2D(GL_TEXTURE_2D,
+                            0,
+                            0,
+                            0,
+                            width,
+                            height,
+                            GL_BGRA,
+                            GL_UNSIGNED_INT_8_8_8_8_REV,
+                            source.GetPixels());
+        })};
+        glDeleteTextures(1, &texture);
+        Report("full upload", timings);
+    }
+    {
+        SyntheticPaintSource source{width, height, scrollInterval};
+        App::TextureUploader uploader{};
+        Timings timings{Run(source, frames, [&](const std::vector<App::DirtyRect>& rects) {
+            uploader.Upload(source.GetPixels(), width, height, rects.data(), rects.size());
+        })};
+        Report("TextureUploader", timings);
+
+        const App::TextureUploader::Stats& stats{uploader.GetStats()};
+        std::printf("%-16s %llu uploads, %llu full, %.1f MB, %llu stalls\n",
+                    "",
+                    static_cast<unsigned long long>(stats.uploads),
+                    static_cast<unsigned long long>(stats.fullUploads),
+                    static_cast<double>(stats.bytesUploaded) / (1024.0 * 1024.0),
+                    static_cast<unsigned long long>(stats.stalls));
+    }
+
+    SDL_GL_DeleteContext(context);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "SyntheticPaintSource.hpp"
+#include <algorithm>
+
+SyntheticPaintSource::SyntheticPaintSource(const int width, const int height, const int scrollInterval)
+        : m_width(width),
+          m_height(height),
+          m_scrollInterval(scrollInterval),
+          m_pixels(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), 0xFFFFFFFFU)
+{
+}
+
+const std::vector<App::DirtyRect>& SyntheticPaintSource::Paint()
+{
+    m_rects.clear();
+    const auto frame{static_cast<std::uint32_t>(m_frame)};
+
+    if(m_scrollInterval > 0 && m_frame % m_scrollInterval == 0)
+    {
+        // A scroll repaints the whole view with shifted content.
+        for(int y = 0; y < m_height; ++y)
+        {
+            const auto color{0xFF000000U | ((static_cast<std::uint32_t>(y) + frame * 7U) & 0xFFU) * 0x010101U};
+            std::fill_n(m_pixels.begin() + static_cast<std::ptrdiff_t>(y) * m_width, m_width, color);
+        }
+        m_rects.push_back({0, 0, m_width, m_height});
+    }
+    else
+    {
+        // Spinner in the middle, a ticker strip at the bottom and a caret blinking at 2 Hz.
+        const int spinner{std::min(64, std::min(m_width, m_height))};
+        Fill({(m_width - spinner) / 2, (m_height - spinner) / 2, spinner, spinner}, 0xFF0000FFU + (frame << 8U));
+        Fill({0, m_height - std::min(40, m_height), m_width, std::min(40, m_height)}, 0xFF00FF00U ^ frame);
+        if(m_frame % 30 == 0)
+        {
+            Fill({std::min(100, m_width - 2), std::min(100, m_height - 18), 2, 18},
+                 (m_frame / 30) % 2 == 0 ? 0xFF000000U : 0xFFFFFFFFU);
+        }
+    }
+
+    ++m_frame;
+    return m_rects;
+}
+
+const std::uint8_t* SyntheticPaintSource::GetPixels() const
+{
+    return reinterpret_cast<const std::uint8_t*>(m_pixels.data());
+}
+
+int SyntheticPaintSource::GetWidth() const
+{
+    return m_width;
+}
+
+int SyntheticPaintSource::GetHeight() const
+{
+    return m_height;
+}
+
+void SyntheticPaintSource::Fill(const App::DirtyRect& rect, const std::uint32_t color)
+{
+    for(int y = rect.y; y < rect.y + rect.height; ++y)
+    {
+        std::fill_n(m_pixels.begin() + static_cast<std::ptrdiff_t>(y) * m_width + rect.x, rect.width, color);
+    }
+    m_rects.push_back(rect);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Core/TextureUploader.hpp"
+
+// Stands in for CEF's OnPaint so the upload path can be measured without the
+// Chromium binaries. The update pattern follows a typical page: a blinking
+// caret, a spinner and a ticker strip repaint every frame or so, and every
+// scrollInterval frames the whole view repaints.
+class SyntheticPaintSource
+{
+public:
+    SyntheticPaintSource(int width, int height, int scrollInterval);
+
+    // Paints the next frame into GetPixels() and returns its dirty rects.
+    const std::vector<App::DirtyRect>& Paint();
+
+    [[nodiscard]] const std::uint8_t* GetPixels() const;
+    [[nodiscard]] int GetWidth() const;
+    [[nodiscard]] int GetHeight() const;
+
+private:
+    void Fill(const App::DirtyRect& rect, std::uint32_t color);
+
+    int m_width;
+    int m_height;
+    int m_scrollInterval;
+    int m_frame{0};
+    std::vector<std::uint32_t> m_pixels;
+    std::vector<App::DirtyRect> m_rects;
+};